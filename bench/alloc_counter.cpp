@@ -0,0 +1,45 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+// 替换的分配函数放在单独的翻译单元中，调用方看不到它们的实现，也就不会被内联
+namespace
+{
+size_t g_alloc_count = 0;
+size_t g_alloc_bytes = 0;
+} // namespace
+
+void *operator new(const size_t size)
+{
+    ++g_alloc_count;
+    g_alloc_bytes += size;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace bench
+{
+size_t AllocCount() noexcept
+{
+    return g_alloc_count;
+}
+
+size_t AllocBytes() noexcept
+{
+    return g_alloc_bytes;
+}
+} // namespace bench
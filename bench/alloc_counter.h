@@ -0,0 +1,13 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// 基准程序替换了全局operator new，统计进程启动以来的分配次数和字节数，只在单线程中读取
+namespace bench
+{
+[[nodiscard]] size_t AllocCount() noexcept; // 累计的分配次数
+[[nodiscard]] size_t AllocBytes() noexcept; // 累计请求分配的字节数
+} // namespace bench
+
+#endif // ALLOC_COUNTER_H
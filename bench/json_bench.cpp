@@ -0,0 +1,897 @@
+// 基准测试：用确定性生成的语料分别测量词法分析、语法分析、DOM访问和序列化的吞吐量与内存分配次数
+// 每个(语料, 阶段)输出一条记录，默认为每行一个json对象，--format=csv时输出带表头的csv，便于在不同提交之间比较
+
+#include "alloc_counter.h"
+#include "json_type.h"
+#include "lexer_parser.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+using simple_json::JsonType;
+using simple_json::JsonValue;
+
+// splitmix64，同一个种子在任何平台上生成相同的语料
+class Random
+{
+  public:
+    explicit Random(const uint64_t seed) noexcept : state_(seed)
+    {
+    }
+
+    uint64_t Next() noexcept
+    {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, bound)
+    size_t Below(const size_t bound) noexcept
+    {
+        return static_cast<size_t>(Next() % bound);
+    }
+
+    // [low, high]
+    long long Between(const long long low, const long long high) noexcept
+    {
+        return low + static_cast<long long>(Next() % static_cast<uint64_t>(high - low + 1));
+    }
+
+    double Uniform(const double low, const double high) noexcept
+    {
+        return low + (high - low) * static_cast<double>(Next() >> 11) / static_cast<double>(1ULL << 53);
+    }
+
+    bool Chance(const int percent) noexcept
+    {
+        return Below(100) < static_cast<size_t>(percent);
+    }
+
+  private:
+    uint64_t state_;
+};
+
+// 生成语料用的json写入器，自动处理逗号和缩进，不依赖被测的库
+class CorpusWriter
+{
+  public:
+    explicit CorpusWriter(const size_t indent) noexcept : indent_(indent)
+    {
+    }
+
+    void BeginObject()
+    {
+        Separate();
+        out_.push_back('{');
+        first_.push_back(true);
+    }
+
+    void EndObject()
+    {
+        Close('}');
+    }
+
+    void BeginArray()
+    {
+        Separate();
+        out_.push_back('[');
+        first_.push_back(true);
+    }
+
+    void EndArray()
+    {
+        Close(']');
+    }
+
+    void Key(const std::string_view key)
+    {
+        Separate();
+        AppendQuoted(key, false);
+        out_.append(indent_ > 0 ? ": " : ":");
+        after_key_ = true;
+    }
+
+    // ascii_only为true时非ascii字符写成\uXXXX转义，模拟twitter.json中大量的转义序列
+    void String(const std::string_view str, const bool ascii_only = false)
+    {
+        Separate();
+        AppendQuoted(str, ascii_only);
+    }
+
+    void Int(const long long value)
+    {
+        Separate();
+        out_.append(std::to_string(value));
+    }
+
+    void Double(const double value)
+    {
+        Separate();
+        char buffer[32];
+        const int length = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        out_.append(buffer, static_cast<size_t>(length));
+        // 保证输出总是浮点数字面量
+        if (std::string_view(buffer, static_cast<size_t>(length)).find_first_of(".eE") == std::string_view::npos)
+        {
+            out_.append(".0");
+        }
+    }
+
+    void Bool(const bool value)
+    {
+        Separate();
+        out_.append(value ? "true" : "false");
+    }
+
+    void Null()
+    {
+        Separate();
+        out_.append("null");
+    }
+
+    std::string Take()
+    {
+        return std::move(out_);
+    }
+
+  private:
+    std::string out_;
+    std::vector<bool> first_; // 每层容器是否还没有写入元素
+    size_t indent_;
+    bool after_key_{false};
+
+    void Separate()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+        if (!first_.empty())
+        {
+            if (!first_.back())
+            {
+                out_.push_back(',');
+            }
+            first_.back() = false;
+            NewLine(first_.size());
+        }
+    }
+
+    void Close(const char bracket)
+    {
+        const bool empty = first_.back();
+        first_.pop_back();
+        if (!empty)
+        {
+            NewLine(first_.size());
+        }
+        out_.push_back(bracket);
+    }
+
+    void NewLine(const size_t depth)
+    {
+        if (indent_ > 0)
+        {
+            out_.push_back('\n');
+            out_.append(depth * indent_, ' ');
+        }
+    }
+
+    void AppendQuoted(const std::string_view str, const bool ascii_only)
+    {
+        out_.push_back('"');
+        for (size_t i = 0; i < str.size(); ++i)
+        {
+            const auto ch = static_cast<unsigned char>(str[i]);
+            if (ch == '"' || ch == '\\')
+            {
+                out_.push_back('\\');
+                out_.push_back(static_cast<char>(ch));
+            }
+            else if (ch == '\n')
+            {
+                out_.append("\\n");
+            }
+            else if (ascii_only && ch >= 0x80)
+            {
+                // 语料中只有2字节和3字节的utf-8序列
+                unsigned codepoint = 0;
+                if ((ch & 0xE0) == 0xC0)
+                {
+                    codepoint = ((ch & 0x1FU) << 6) | (static_cast<unsigned char>(str[i + 1]) & 0x3FU);
+                    i += 1;
+                }
+                else
+                {
+                    codepoint = ((ch & 0x0FU) << 12) | ((static_cast<unsigned char>(str[i + 1]) & 0x3FU) << 6) |
+                                (static_cast<unsigned char>(str[i + 2]) & 0x3FU);
+                    i += 2;
+                }
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", codepoint);
+                out_.append(buffer);
+            }
+            else
+            {
+                out_.push_back(static_cast<char>(ch));
+            }
+        }
+        out_.push_back('"');
+    }
+};
+
+constexpr std::string_view WORDS[] = {
+    "the",   "json",     "parser", "stream",   "value",   "token",  "quick", "brown",  "fox",     "lazy",
+    "dog",   "release",  "build",  "commit",   "review",  "branch", "merge", "server", "request", "latency",
+    "cache", "東京",     "ラーメン", "おはよう", "café",    "naïve",  "Zürich", "Ελλάδα", "Москва",  "日本語",
+    "@dev",  "#cpp",     "#json",  "\"quoted\"", "back\\slash", "tab", "emoji", "line",  "http",    "https"};
+
+std::string Sentence(Random &random, const size_t min_words, const size_t max_words)
+{
+    const size_t count = min_words + random.Below(max_words - min_words + 1);
+    std::string sentence;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            sentence.push_back(random.Chance(5) ? '\n' : ' ');
+        }
+        sentence.append(WORDS[random.Below(std::size(WORDS))]);
+    }
+    return sentence;
+}
+
+std::string Identifier(Random &random, const size_t length)
+{
+    constexpr std::string_view ALPHABET = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    std::string identifier;
+    for (size_t i = 0; i < length; ++i)
+    {
+        identifier.push_back(ALPHABET[random.Below(ALPHABET.size())]);
+    }
+    return identifier;
+}
+
+// twitter风格：字符串为主，包含大量转义和非ascii字符，每个文档是一页搜索结果
+std::string TwitterDocument(Random &random)
+{
+    CorpusWriter writer(2);
+    writer.BeginObject();
+    writer.Key("statuses");
+    writer.BeginArray();
+    for (int i = 0; i < 20; ++i)
+    {
+        const long long id = 505874924095815681LL + random.Between(0, 1LL << 40);
+        writer.BeginObject();
+        writer.Key("created_at");
+        writer.String("Sun Aug 31 00:29:15 +0000 2014");
+        writer.Key("id");
+        writer.Int(id);
+        writer.Key("id_str");
+        writer.String(std::to_string(id));
+        writer.Key("text");
+        writer.String(Sentence(random, 5, 25), random.Chance(60));
+        writer.Key("source");
+        writer.String(R"(<a href="http://twitter.com/download/iphone" rel="nofollow">Twitter for iPhone</a>)");
+        writer.Key("truncated");
+        writer.Bool(false);
+        writer.Key("in_reply_to_status_id");
+        random.Chance(30) ? writer.Int(id - random.Between(1, 1000000)) : writer.Null();
+
+        writer.Key("user");
+        writer.BeginObject();
+        const long long user_id = random.Between(1, 3000000000LL);
+        writer.Key("id");
+        writer.Int(user_id);
+        writer.Key("id_str");
+        writer.String(std::to_string(user_id));
+        writer.Key("name");
+        writer.String(Sentence(random, 1, 3), true);
+        writer.Key("screen_name");
+        writer.String(Identifier(random, 6 + random.Below(9)));
+        writer.Key("location");
+        writer.String(Sentence(random, 0, 2), true);
+        writer.Key("description");
+        writer.String(Sentence(random, 0, 20), true);
+        writer.Key("url");
+        random.Chance(40) ? writer.String("http://t.co/" + Identifier(random, 10)) : writer.Null();
+        writer.Key("followers_count");
+        writer.Int(random.Between(0, 100000));
+        writer.Key("friends_count");
+        writer.Int(random.Between(0, 5000));
+        writer.Key("listed_count");
+        writer.Int(random.Between(0, 100));
+        writer.Key("utc_offset");
+        random.Chance(50) ? writer.Int(32400) : writer.Null();
+        writer.Key("geo_enabled");
+        writer.Bool(random.Chance(30));
+        writer.Key("verified");
+        writer.Bool(random.Chance(2));
+        writer.Key("lang");
+        writer.String("ja");
+        writer.Key("profile_background_color");
+        writer.String("C0DEED");
+        writer.Key("profile_image_url");
+        writer.String("http://pbs.twimg.com/profile_images/" + std::to_string(random.Between(1, 1LL << 32)) + "/" +
+                      Identifier(random, 8) + "_normal.jpeg");
+        writer.Key("following");
+        writer.Bool(false);
+        writer.EndObject();
+
+        writer.Key("geo");
+        writer.Null();
+        writer.Key("retweet_count");
+        writer.Int(random.Between(0, 500));
+        writer.Key("favorite_count");
+        writer.Int(random.Between(0, 500));
+
+        writer.Key("entities");
+        writer.BeginObject();
+        writer.Key("hashtags");
+        writer.BeginArray();
+        for (size_t h = random.Below(3); h > 0; --h)
+        {
+            writer.BeginObject();
+            writer.Key("text");
+            writer.String(WORDS[random.Below(std::size(WORDS))], true);
+            writer.Key("indices");
+            writer.BeginArray();
+            const long long begin = random.Between(0, 100);
+            writer.Int(begin);
+            writer.Int(begin + random.Between(2, 12));
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.Key("symbols");
+        writer.BeginArray();
+        writer.EndArray();
+        writer.Key("user_mentions");
+        writer.BeginArray();
+        for (size_t m = random.Below(3); m > 0; --m)
+        {
+            const long long mention_id = random.Between(1, 3000000000LL);
+            writer.BeginObject();
+            writer.Key("screen_name");
+            writer.String(Identifier(random, 8));
+            writer.Key("id");
+            writer.Int(mention_id);
+            writer.Key("id_str");
+            writer.String(std::to_string(mention_id));
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+
+        writer.Key("favorited");
+        writer.Bool(false);
+        writer.Key("retweeted");
+        writer.Bool(false);
+        writer.Key("metadata");
+        writer.BeginObject();
+        writer.Key("result_type");
+        writer.String("recent");
+        writer.Key("iso_language_code");
+        writer.String("ja");
+        writer.EndObject();
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("search_metadata");
+    writer.BeginObject();
+    writer.Key("completed_in");
+    writer.Double(random.Uniform(0.01, 0.2));
+    writer.Key("max_id");
+    writer.Int(505874924095815681LL);
+    writer.Key("query");
+    writer.String("%E4%B8%80");
+    writer.Key("count");
+    writer.Int(20);
+    writer.EndObject();
+    writer.EndObject();
+    return writer.Take();
+}
+
+// canada风格：以浮点数为主，坐标嵌套在四层数组中
+std::string CanadaDocument(Random &random)
+{
+    CorpusWriter writer(0);
+    writer.BeginObject();
+    writer.Key("type");
+    writer.String("FeatureCollection");
+    writer.Key("features");
+    writer.BeginArray();
+    writer.BeginObject();
+    writer.Key("type");
+    writer.String("Feature");
+    writer.Key("properties");
+    writer.BeginObject();
+    writer.Key("name");
+    writer.String("Canada");
+    writer.EndObject();
+    writer.Key("geometry");
+    writer.BeginObject();
+    writer.Key("type");
+    writer.String("Polygon");
+    writer.Key("coordinates");
+    writer.BeginArray();
+    for (int ring = 0; ring < 40; ++ring)
+    {
+        // 每个环是一段随机游走的海岸线
+        double longitude = random.Uniform(-140.0, -52.0);
+        double latitude = random.Uniform(42.0, 83.0);
+        writer.BeginArray();
+        for (int point = 0; point < 300; ++point)
+        {
+            longitude += random.Uniform(-0.01, 0.01);
+            latitude += random.Uniform(-0.01, 0.01);
+            writer.BeginArray();
+            writer.Double(longitude);
+            writer.Double(latitude);
+            writer.EndArray();
+        }
+        writer.EndArray();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+    return writer.Take();
+}
+
+// citm风格：以id为键的宽对象和大量整数
+std::string CitmDocument(Random &random)
+{
+    std::vector<long long> topic_ids(40);
+    std::vector<long long> area_ids(30);
+    for (long long &id : topic_ids)
+    {
+        id = random.Between(100000000, 999999999);
+    }
+    for (long long &id : area_ids)
+    {
+        id = random.Between(100000000, 999999999);
+    }
+
+    CorpusWriter writer(4);
+    writer.BeginObject();
+    writer.Key("areaNames");
+    writer.BeginObject();
+    for (const long long id : area_ids)
+    {
+        writer.Key(std::to_string(id));
+        writer.String(Sentence(random, 1, 3));
+    }
+    writer.EndObject();
+
+    writer.Key("events");
+    writer.BeginObject();
+    std::vector<long long> event_ids(200);
+    for (long long &event_id : event_ids)
+    {
+        event_id = random.Between(100000000, 999999999);
+        writer.Key(std::to_string(event_id));
+        writer.BeginObject();
+        writer.Key("description");
+        writer.Null();
+        writer.Key("id");
+        writer.Int(event_id);
+        writer.Key("logo");
+        random.Chance(50) ? writer.String("/images/UE0AAAAA" + Identifier(random, 16)) : writer.Null();
+        writer.Key("name");
+        writer.String(Sentence(random, 2, 6));
+        writer.Key("subTopicIds");
+        writer.BeginArray();
+        for (size_t i = random.Below(5); i > 0; --i)
+        {
+            writer.Int(topic_ids[random.Below(topic_ids.size())]);
+        }
+        writer.EndArray();
+        writer.Key("subjectCode");
+        writer.Null();
+        writer.Key("subtitle");
+        writer.Null();
+        writer.Key("topicIds");
+        writer.BeginArray();
+        for (size_t i = 1 + random.Below(3); i > 0; --i)
+        {
+            writer.Int(topic_ids[random.Below(topic_ids.size())]);
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndObject();
+
+    writer.Key("performances");
+    writer.BeginArray();
+    for (int i = 0; i < 250; ++i)
+    {
+        writer.BeginObject();
+        writer.Key("eventId");
+        writer.Int(event_ids[random.Below(event_ids.size())]);
+        writer.Key("id");
+        writer.Int(random.Between(100000000, 999999999));
+        writer.Key("logo");
+        writer.Null();
+        writer.Key("name");
+        writer.Null();
+        writer.Key("prices");
+        writer.BeginArray();
+        for (size_t p = 1 + random.Below(4); p > 0; --p)
+        {
+            writer.BeginObject();
+            writer.Key("amount");
+            writer.Int(random.Between(10, 2000) * 50);
+            writer.Key("audienceSubCategoryId");
+            writer.Int(337100890);
+            writer.Key("seatCategoryId");
+            writer.Int(random.Between(338937000, 338937999));
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.Key("seatCategories");
+        writer.BeginArray();
+        for (size_t c = 1 + random.Below(3); c > 0; --c)
+        {
+            writer.BeginObject();
+            writer.Key("areas");
+            writer.BeginArray();
+            for (size_t a = 1 + random.Below(6); a > 0; --a)
+            {
+                writer.BeginObject();
+                writer.Key("areaId");
+                writer.Int(area_ids[random.Below(area_ids.size())]);
+                writer.Key("blockIds");
+                writer.BeginArray();
+                writer.EndArray();
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.Key("seatCategoryId");
+            writer.Int(random.Between(338937000, 338937999));
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.Key("seatMapImage");
+        writer.Null();
+        writer.Key("start");
+        writer.Int(1372701600000LL + random.Between(0, 100000000) * 1000);
+        writer.Key("venueCode");
+        writer.String("PLEYEL_PLEYEL");
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("topicNames");
+    writer.BeginObject();
+    for (const long long id : topic_ids)
+    {
+        writer.Key(std::to_string(id));
+        writer.String(Sentence(random, 1, 2));
+    }
+    writer.EndObject();
+    writer.Key("venueNames");
+    writer.BeginObject();
+    writer.Key("PLEYEL_PLEYEL");
+    writer.String("Salle Pleyel");
+    writer.EndObject();
+    writer.EndObject();
+    return writer.Take();
+}
+
+// 深层嵌套的配置树，对象和数组交替嵌套，深度远小于MAX_PARSE_DEPTH
+void NestedLevel(CorpusWriter &writer, Random &random, const size_t depth)
+{
+    writer.BeginObject();
+    writer.Key("name");
+    writer.String(Identifier(random, 4 + random.Below(8)));
+    writer.Key("enabled");
+    writer.Bool(random.Chance(50));
+    writer.Key("weight");
+    writer.Double(random.Uniform(0.0, 1.0));
+    writer.Key("children");
+    writer.BeginArray();
+    if (depth > 0)
+    {
+        NestedLevel(writer, random, depth - 1);
+    }
+    writer.Int(random.Between(0, 1000));
+    writer.EndArray();
+    writer.EndObject();
+}
+
+std::string NestedDocument(Random &random)
+{
+    CorpusWriter writer(0);
+    writer.BeginArray();
+    NestedLevel(writer, random, 32 + random.Below(96));
+    writer.EndArray();
+    return writer.Take();
+}
+
+uint64_t Fnv1a(const std::string_view str) noexcept
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const char ch : str)
+    {
+        hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+struct Corpus
+{
+    const char *name_;
+    std::string (*generate_)(Random &);
+    size_t documents_; // scale为1时的文档个数
+};
+
+constexpr Corpus CORPORA[] = {
+    {"twitter", TwitterDocument, 50},
+    {"canada", CanadaDocument, 4},
+    {"citm", CitmDocument, 8},
+    {"nested", NestedDocument, 200},
+};
+
+// 一个阶段的测量结果，时间取最快的一轮，分配次数取所有轮次的平均值
+struct StageResult
+{
+    size_t rounds_{0};
+    double best_seconds_{0};
+    double mean_seconds_{0};
+    double allocs_{0};
+    double alloc_bytes_{0};
+};
+
+StageResult Measure(const std::function<void()> &round, const double min_seconds)
+{
+    round(); // 预热，不计入结果
+
+    StageResult result;
+    double total_seconds = 0;
+    size_t total_allocs = 0;
+    size_t total_alloc_bytes = 0;
+    while (result.rounds_ == 0 || total_seconds < min_seconds)
+    {
+        const size_t allocs_before = bench::AllocCount();
+        const size_t bytes_before = bench::AllocBytes();
+        const auto begin = std::chrono::steady_clock::now();
+        round();
+        const auto end = std::chrono::steady_clock::now();
+        total_allocs += bench::AllocCount() - allocs_before;
+        total_alloc_bytes += bench::AllocBytes() - bytes_before;
+
+        const double seconds = std::chrono::duration<double>(end - begin).count();
+        result.best_seconds_ = result.rounds_ == 0 ? seconds : std::min(result.best_seconds_, seconds);
+        total_seconds += seconds;
+        ++result.rounds_;
+    }
+    result.mean_seconds_ = total_seconds / static_cast<double>(result.rounds_);
+    result.allocs_ = static_cast<double>(total_allocs) / static_cast<double>(result.rounds_);
+    result.alloc_bytes_ = static_cast<double>(total_alloc_bytes) / static_cast<double>(result.rounds_);
+    return result;
+}
+
+// 通过operator[]按下标和键访问每一个值，模拟使用者读取整个文档
+uint64_t Touch(JsonValue &value)
+{
+    switch (value.GetType())
+    {
+    case JsonType::Object: {
+        uint64_t sum = 0;
+        for (const auto &member : value.GetVal<JsonType::Object>())
+        {
+            sum += Touch(value[member.first]);
+        }
+        return sum;
+    }
+    case JsonType::Array: {
+        uint64_t sum = 0;
+        const size_t size = value.GetVal<JsonType::Array>().size();
+        for (size_t i = 0; i < size; ++i)
+        {
+            sum += Touch(value[size_t{i}]);
+        }
+        return sum;
+    }
+    case JsonType::String:
+        return value.GetVal<JsonType::String>().size();
+    case JsonType::Int:
+        return static_cast<uint64_t>(value.GetVal<JsonType::Int>());
+    case JsonType::Float:
+        return static_cast<uint64_t>(std::fabs(value.GetVal<JsonType::Float>()));
+    case JsonType::Bool:
+        return value.GetVal<JsonType::Bool>() ? 1 : 0;
+    case JsonType::Null:
+        return 0;
+    }
+    return 0;
+}
+
+enum class Format
+{
+    JSON,
+    CSV
+};
+
+void Report(const Format format, const char *corpus, const char *stage, const size_t documents, const size_t bytes,
+            const StageResult &result)
+{
+    const double mb_per_s = static_cast<double>(bytes) / 1e6 / result.best_seconds_;
+    const double docs_per_s = static_cast<double>(documents) / result.best_seconds_;
+    const double allocs_per_doc = result.allocs_ / static_cast<double>(documents);
+    const double alloc_bytes_per_doc = result.alloc_bytes_ / static_cast<double>(documents);
+    if (format == Format::CSV)
+    {
+        std::printf("%s,%s,%zu,%zu,%zu,%.6f,%.6f,%.2f,%.1f,%.1f,%.1f\n", corpus, stage, documents, bytes,
+                    result.rounds_, result.best_seconds_, result.mean_seconds_, mb_per_s, docs_per_s, allocs_per_doc,
+                    alloc_bytes_per_doc);
+    }
+    else
+    {
+        std::printf("{\"corpus\":\"%s\",\"stage\":\"%s\",\"documents\":%zu,\"bytes\":%zu,\"rounds\":%zu,"
+                    "\"best_seconds\":%.6f,\"mean_seconds\":%.6f,\"mb_per_s\":%.2f,\"docs_per_s\":%.1f,"
+                    "\"allocs_per_doc\":%.1f,\"alloc_bytes_per_doc\":%.1f}\n",
+                    corpus, stage, documents, bytes, result.rounds_, result.best_seconds_, result.mean_seconds_,
+                    mb_per_s, docs_per_s, allocs_per_doc, alloc_bytes_per_doc);
+    }
+    std::fflush(stdout);
+}
+
+int Usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--format=json|csv] [--min-time=SECONDS] [--scale=N] [--corpus=NAME]\n"
+                 "  --format    output one json object per line (default) or csv with a header\n"
+                 "  --min-time  minimum measured time per corpus and stage, default 0.5\n"
+                 "  --scale     multiplies the number of generated documents, default 1\n"
+                 "  --corpus    only run twitter, canada, citm or nested\n",
+                 program);
+    return 1;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Format format = Format::JSON;
+    double min_seconds = 0.5;
+    size_t scale = 1;
+    std::string_view only_corpus;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg(argv[i]);
+        if (arg == "--format=json")
+        {
+            format = Format::JSON;
+        }
+        else if (arg == "--format=csv")
+        {
+            format = Format::CSV;
+        }
+        else if (arg.substr(0, 11) == "--min-time=")
+        {
+            min_seconds = std::atof(argv[i] + 11);
+        }
+        else if (arg.substr(0, 8) == "--scale=")
+        {
+            scale = std::max<size_t>(std::strtoull(argv[i] + 8, nullptr, 10), 1);
+        }
+        else if (arg.substr(0, 9) == "--corpus=")
+        {
+            only_corpus = arg.substr(9);
+        }
+        else
+        {
+            return Usage(argv[0]);
+        }
+    }
+
+#ifndef NDEBUG
+    std::fprintf(stderr, "warning: json_bench was built without optimizations, the numbers are not representative\n");
+#endif
+
+    if (format == Format::CSV)
+    {
+        std::printf("corpus,stage,documents,bytes,rounds,best_seconds,mean_seconds,mb_per_s,docs_per_s,"
+                    "allocs_per_doc,alloc_bytes_per_doc\n");
+    }
+
+    uint64_t sink = 0; // 防止编译器优化掉被测代码
+    for (const Corpus &corpus : CORPORA)
+    {
+        if (!only_corpus.empty() && only_corpus != corpus.name_)
+        {
+            continue;
+        }
+
+        // 种子只取决于语料名，不同提交、不同平台上生成完全相同的文档
+        Random random(Fnv1a(corpus.name_));
+        std::vector<std::string> documents(corpus.documents_ * scale);
+        size_t bytes = 0;
+        for (std::string &document : documents)
+        {
+            document = corpus.generate_(random);
+            bytes += document.size();
+        }
+
+        // 后续阶段的输入：每个文档的token流和解析结果
+        std::vector<simple_json::JsonData> token_streams;
+        std::vector<JsonValue> values;
+        for (const std::string &document : documents)
+        {
+            simple_json::Lexer lexer(document);
+            token_streams.push_back(lexer.TakeToken());
+            simple_json::Parser parser;
+            values.push_back(parser.Parse(token_streams.back()));
+        }
+
+        const StageResult lex = Measure(
+            [&] {
+                for (const std::string &document : documents)
+                {
+                    simple_json::Lexer lexer(document);
+                    sink += lexer.BorrowToken().tokens_.size();
+                }
+            },
+            min_seconds);
+        Report(format, corpus.name_, "lex", documents.size(), bytes, lex);
+
+        const StageResult parse = Measure(
+            [&] {
+                simple_json::Parser parser;
+                for (simple_json::JsonData &token_stream : token_streams)
+                {
+                    const JsonValue value = parser.Parse(token_stream);
+                    sink += static_cast<uint64_t>(value.GetType());
+                }
+            },
+            min_seconds);
+        Report(format, corpus.name_, "parse", documents.size(), bytes, parse);
+
+        const StageResult access = Measure(
+            [&] {
+                for (JsonValue &value : values)
+                {
+                    sink += Touch(value);
+                }
+            },
+            min_seconds);
+        Report(format, corpus.name_, "dom_access", documents.size(), bytes, access);
+
+        std::string out;
+        const StageResult serialize = Measure(
+            [&] {
+                for (const JsonValue &value : values)
+                {
+                    out.clear();
+                    simple_json::AppendJson(out, value);
+                    sink += out.size();
+                }
+            },
+            min_seconds);
+        Report(format, corpus.name_, "serialize", documents.size(), bytes, serialize);
+    }
+
+    std::fprintf(stderr, "checksum %" PRIu64 "\n", sink);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#ifndef BATCH_PARSER_H
+#define BATCH_PARSER_H
+
+#include "json_type.h"
+#include "lexer_parser.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace simple_json
+{
+// 批量解析中一个文档的结果
+struct BatchResult
+{
+    JsonValue value_;   // 解析得到的json数据结构，出错时为null
+    std::string error_; // 错误信息，成功时为空
+
+    [[nodiscard]] bool Ok() const noexcept
+    {
+        return error_.empty();
+    }
+};
+
+/**
+ * @brief Parses batches of independent documents on a pool of threads that live as long as the object. Each thread
+ * owns a JsonParser, so its buffers are reused across documents and batches. Documents are dealt to per-thread queues
+ * largest first; a thread that runs out of work steals the smallest pending documents of another thread, so one large
+ * document keeps a single thread busy while the others drain the rest of the batch.
+ */
+class BatchParser
+{
+  public:
+    /**
+     * @param thread_count Number of threads parsing a batch, including the calling thread, at least 1.
+     */
+    explicit BatchParser(size_t thread_count = std::thread::hardware_concurrency());
+    ~BatchParser();
+
+    BatchParser(const BatchParser &) = delete;
+    BatchParser(BatchParser &&) = delete;
+    BatchParser &operator=(const BatchParser &) = delete;
+    BatchParser &operator=(BatchParser &&) = delete;
+
+    /**
+     * @brief Parses every document, the calling thread takes part and returns when the whole batch is done. Calls from
+     * several threads are serialized.
+     *
+     * @param documents The documents, they must stay alive until the call returns.
+     * @param count Number of documents.
+     * @return One result per document in input order, a document that fails to parse only sets its own error.
+     */
+    [[nodiscard]] std::vector<BatchResult> ParseBatch(const std::string_view *documents, size_t count);
+
+    [[nodiscard]] std::vector<BatchResult> ParseBatch(const std::vector<std::string_view> &documents)
+    {
+        return ParseBatch(documents.data(), documents.size());
+    }
+
+    [[nodiscard]] size_t ThreadCount() const noexcept
+    {
+        return workers_.size();
+    }
+
+  private:
+    struct Worker
+    {
+        std::mutex mutex_;
+        std::deque<size_t> tasks_; // 待解析文档的下标，前端是最大的文档
+        JsonParser parser_;
+        std::thread thread_; // 第0个工作者是调用ParseBatch的线程，没有自己的线程
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex batch_mutex_; // 串行化并发的ParseBatch调用
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    size_t generation_ = 0; // 每开始一批加1，唤醒工作线程
+    bool stopping_ = false;
+    std::atomic<size_t> remaining_{0};
+
+    // 当前批次，只在没有任务时修改
+    const std::string_view *documents_ = nullptr;
+    BatchResult *results_ = nullptr;
+
+    void Run(size_t worker_index);
+    void RunTasks(size_t worker_index);
+    bool NextTask(size_t worker_index, size_t &task);
+};
+} // namespace simple_json
+
+#endif // BATCH_PARSER_H
@@ -0,0 +1,92 @@
+#ifndef CBOR_H
+#define CBOR_H
+
+#include "json_type.h"
+#include "sax.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+/**
+ * @brief Appends the CBOR (RFC 8949) encoding of a value to out, using the shortest form of every integer, length and
+ * float. CBOR has no extended precision float, a long double that a double cannot hold exactly is rounded.
+ *
+ * @param out The buffer to append to.
+ * @param value The value to encode.
+ */
+void AppendCbor(std::string &out, const JsonValue &value);
+
+/**
+ * @brief Encodes a value as CBOR.
+ *
+ * @return The encoded bytes.
+ */
+[[nodiscard]] std::string ToCbor(const JsonValue &value);
+
+/**
+ * @brief Decodes one CBOR data item into a JsonValue.
+ *
+ * @param data The encoded bytes, must contain exactly one data item.
+ * @return The decoded value.
+ * @throws std::runtime_error if the data is malformed, nested deeper than MAX_PARSE_DEPTH or cannot be represented
+ * as json.
+ */
+[[nodiscard]] JsonValue FromCbor(std::string_view data);
+
+// 在CBOR字节流上产生SAX事件，事件与文本解析器一致，字符串直接引用输入缓冲区；标签被忽略，字节串转换为base64url字符串
+class CborReader
+{
+  public:
+    explicit CborReader(const std::string_view data) noexcept : data_(data)
+    {
+    }
+
+    /**
+     * @brief Emits the events of the data item, the input must contain exactly one item.
+     *
+     * @param handler Receives the events.
+     * @return Returns true if the item was read completely, false on malformed data or when the handler stopped.
+     */
+    bool Parse(SaxHandler &handler);
+
+    [[nodiscard]] bool HasError() const noexcept
+    {
+        return !error_.empty();
+    }
+
+    /**
+     * @brief Throws the recorded error as std::runtime_error.
+     */
+    void ThrowError() const;
+
+  private:
+    // 正在读取的数组或map，definite长度时remaining_为剩余的元素个数，map按键值对计数
+    struct Frame
+    {
+        bool is_map_;
+        bool indefinite_;
+        uint64_t remaining_;
+        size_t count_;
+    };
+
+    std::string_view data_;
+    size_t pos_ = 0;
+    std::string error_;
+    std::vector<Frame> frames_;
+    std::string scratch_; // 拼接分段字符串和转换字节串时使用
+
+    bool Fail(const std::string &err_desc);
+    bool Abort(const SaxHandler &handler);
+    bool ReadHead(uint8_t &major, uint8_t &info, uint64_t &argument);
+    bool ReadString(uint8_t major, uint64_t length, bool indefinite, std::string_view &value);
+    bool ReadItem(SaxHandler &handler, bool &container);
+    void CompleteMember() noexcept;
+};
+} // namespace simple_json
+
+#endif // CBOR_H
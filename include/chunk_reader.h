@@ -0,0 +1,48 @@
+#ifndef CHUNK_READER_H
+#define CHUNK_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace simple_json
+{
+// json文件的存储格式
+enum class Compression : uint8_t
+{
+    NONE, // .json
+    GZIP, // .json.gz
+    ZSTD  // .json.zst
+};
+
+/**
+ * @brief Works out how a json file is stored from its extensions.
+ *
+ * @param file_path The file name, one of *.json, *.json.gz, *.json.zst.
+ * @return The compression of the file, std::nullopt if the name has none of these extensions.
+ */
+[[nodiscard]] std::optional<Compression> CompressionOf(const std::filesystem::path &file_path);
+
+/**
+ * @brief Reads a file as a sequence of decompressed chunks of at most CHUNK_SIZE bytes. A worker thread reads and
+ * decompresses ahead while sink consumes the chunks on the calling thread, and at most CHUNK_QUEUE_DEPTH chunks are
+ * buffered between them, so the memory used here does not depend on the size of the file.
+ *
+ * @param file_path The file to read.
+ * @param compression How the file is stored.
+ * @param sink Receives the chunks in order, a chunk may end anywhere in the text. If it throws, reading stops and the
+ * exception is passed on.
+ * @throws std::runtime_error if the file cannot be opened, is damaged or truncated, or its compression is not enabled
+ * in this build.
+ */
+void ReadChunks(const std::filesystem::path &file_path, Compression compression,
+                const std::function<void(std::string_view)> &sink);
+
+inline constexpr size_t CHUNK_SIZE = 64 * 1024; // 每个数据块解压后的最大字节数
+inline constexpr size_t CHUNK_QUEUE_DEPTH = 4;  // 解压线程最多领先的数据块个数
+} // namespace simple_json
+
+#endif // CHUNK_READER_H
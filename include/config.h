@@ -1,6 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <cstdio>
+#include <cstdlib>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -17,8 +19,9 @@ namespace simple_json
 #define ERR_INCOMPLETE_UNICODE_ESCAPE "Incomplete unicode escape sequence" // 错误提示，不完整的unicode转义序列
 #define ERR_INVALID_UNICODE_ESCAPE "Invalid unicode escape sequence"       // 错误提示，非法的unicode转义序列
 
-#define ERR_INCOMPLETE_NUMBER "Incomplete number literal" // 错误提示，不完整的数字
-#define ERR_INVALID_NUMBER "Invalid number literal"       // 错误提示，非法的数字字面量
+#define ERR_INCOMPLETE_NUMBER "Incomplete number literal"        // 错误提示，不完整的数字
+#define ERR_INVALID_NUMBER "Invalid number literal"              // 错误提示，非法的数字字面量
+#define ERR_NUMBER_OUT_OF_RANGE "Number literal is out of range" // 错误提示，数字超出浮点数的表示范围
 
 #define ERR_INVALID_LITERAL "Invalid json literal"     // 错误提示，非法的json字面量
 #define LITERAL_GUESS_TRUE ", may be you mean true?"   // 字面量猜测，true
@@ -41,10 +44,37 @@ namespace simple_json
 // #define ERR_OBJECT_NOT_CLOSED "json object not closed"                       // 错误提示，json对象未闭合
 // #define ERR_ARRAY_NOT_CLOSED "json array not closed"                         // 错误提示，json数组未闭合
 #define ERR_OBJECT_KEY_MUST_BE_STRING "object key must be string" // 错误提示，对象的键必须为字符串
+#define ERR_NESTING_TOO_DEEP "Json nesting is too deep"            // 错误提示，json嵌套层数过深
+#define ERR_TRAILING_CONTENT "Unexpected content after the json top level value" // 错误提示，顶层值之后还有多余内容
+#define ERR_INPUT_TOO_LARGE "Json input exceeds the size limit"    // 错误提示，输入超过大小限制
+#define ERR_STRING_TOO_LONG "Json string exceeds the length limit" // 错误提示，字符串超过长度限制
+#define ERR_TOO_MANY_ELEMENTS "Json document has too many values"  // 错误提示，值的个数超过限制
+
+#define ERR_SAX_HANDLER_STOPPED "Parsing was stopped by the handler" // 错误提示，SAX处理器主动终止了解析
+
+#define ERR_SCHEMA_TYPE "Value type does not match the schema"              // 错误提示，值的类型与schema不符
+#define ERR_SCHEMA_REQUIRED "Missing required key: "                        // 错误提示，缺少必需的键
+#define ERR_SCHEMA_ADDITIONAL "Key is not allowed by the schema: "          // 错误提示，schema不允许出现该键
+#define ERR_SCHEMA_ENUM "Value is not one of the enum values in the schema" // 错误提示，值不在enum中
+#define ERR_SCHEMA_RANGE "Number is out of the range allowed by the schema" // 错误提示，数字超出范围
+#define ERR_SCHEMA_LENGTH "String length is out of the range allowed by the schema" // 错误提示，字符串长度超出范围
+#define ERR_SCHEMA_ITEMS "Array size is out of the range allowed by the schema"     // 错误提示，数组长度超出范围
+#define ERR_INVALID_SCHEMA "Invalid or unsupported json schema: "                   // 错误提示，schema本身非法或不支持
+
+#define ERR_INVALID_POINTER "Invalid json pointer: " // 错误提示，非法的json pointer
+#define ERR_POINTER_NOT_FOUND "Json pointer does not refer to an existing value: " // 错误提示，json pointer指向的值不存在
+#define ERR_INVALID_PATCH "Invalid json patch: "              // 错误提示，非法的json patch文档
+#define ERR_PATCH_FAILED "Failed to apply json patch: "        // 错误提示，json patch应用失败，目标已回滚
+#define ERR_INVALID_CBOR "Invalid cbor data: "         // 错误提示，非法或无法转换为json的cbor数据
+#define ERR_INVALID_MSGPACK "Invalid msgpack data: "   // 错误提示，非法或无法转换为json的msgpack数据
+#define ERR_INVALID_SNAPSHOT "Invalid json snapshot: "  // 错误提示，快照文件非法、已损坏或版本不符
+#define ERR_INVALID_JSON_PATH "Invalid or unsupported json path: " // 错误提示，非法或不支持的json path
 
 #define INVALID_PATH "invalid file path"       // 错误提示, 非法的文件路径，表示路径不存在
 #define INVALID_FILE "invalid json file"       // 错误提示，非法的文件，目标文件不是json文件
 #define FAILED_OPEN_FILE "failed to open file" // 错误提示，打开文件失败
+#define ERR_DECOMPRESS "failed to decompress file: " // 错误提示，压缩文件已损坏或不完整
+#define ERR_UNSUPPORTED_COMPRESSION "compression is not enabled in this build: " // 错误提示，构建时未启用该压缩格式
 
 #define ERR_ARRAY_INTEGRAL                                                                                             \
     "operator[] > integral index only can be use in json array" // 错误提示, 只能对json数组使用[int]
@@ -60,6 +90,57 @@ namespace simple_json
 #define ALLOW_TRAILING_COMMA false // 允许尾随逗号
 #endif
 
+// 容器缓存自身的哈希值，重复比较大部分未修改的大文档时只需重新计算修改过的路径
+#ifndef CACHE_HASH
+#define CACHE_HASH false
+#endif
+
+// 压缩输入支持，由构建系统在找到zlib、zstd时开启
+#ifndef ENABLE_GZIP
+#define ENABLE_GZIP false
+#endif
+
+#ifndef ENABLE_ZSTD
+#define ENABLE_ZSTD false
+#endif
+
+// 关闭异常(-fno-exceptions)时，原本抛异常的地方改为打印错误信息后终止程序，需要处理错误的调用者应使用TryParse
+#ifndef SIMPLE_JSON_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define SIMPLE_JSON_EXCEPTIONS true
+#else
+#define SIMPLE_JSON_EXCEPTIONS false
+#endif
+#endif
+
+#if SIMPLE_JSON_EXCEPTIONS
+#define SIMPLE_JSON_THROW(...) throw __VA_ARGS__
+#else
+#define SIMPLE_JSON_THROW(...) ::simple_json::AbortWithError((__VA_ARGS__).what())
+
+[[noreturn]] inline void AbortWithError(const char *err_desc) noexcept
+{
+    std::fputs(err_desc, stderr);
+    std::fputc('\n', stderr);
+    std::abort();
+}
+#endif
+
+// 记录每次解析的统计信息(见parse_stats.h)，关闭时统计代码完全不参与编译
+#ifndef PARSE_STATS
+#define PARSE_STATS false
+#endif
+
+// 编译USDT静态探针(见probes.h)，需要sys/sdt.h，关闭时探针代码完全不参与编译
+#ifndef USDT_PROBES
+#define USDT_PROBES false
+#endif
+
+// 解析允许的最大嵌套层数，超过时报错，防止恶意输入耗尽调用栈
+#ifndef MAX_PARSE_DEPTH
+#define MAX_PARSE_DEPTH 512
+#endif
+
 #ifndef POS_T
 #define POS_T unsigned long long // 关于某个token定位的数据类型
 #endif
@@ -0,0 +1,68 @@
+#ifndef FIELD_SET_H
+#define FIELD_SET_H
+
+#include "json_type.h"
+#include "lexer_parser.h"
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+/**
+ * @brief A trie of key paths describing which members should be built when parsing. Arrays are projected element by
+ * element, so "items.price" keeps the price of every element of items.
+ */
+class FieldSet
+{
+  public:
+    // 前缀树节点，下标0为根节点
+    struct Node
+    {
+        std::unordered_map<std::string, size_t> children_;
+        bool whole_ = false; // 保留整个子树
+    };
+
+    FieldSet();
+
+    /**
+     * @brief Builds a field set from dotted paths such as "user.id".
+     */
+    FieldSet(std::initializer_list<std::string_view> dotted_paths);
+
+    /**
+     * @brief Adds a dotted path, a path that is a prefix of another keeps the whole subtree.
+     */
+    void Add(std::string_view dotted_path);
+
+    /**
+     * @brief Adds a path given as separate keys, useful when a key contains a dot.
+     */
+    void Add(const std::vector<std::string> &keys);
+
+    [[nodiscard]] const Node &GetNode(const size_t index) const noexcept
+    {
+        return nodes_[index];
+    }
+
+    /**
+     * @brief Builds the projected value from a token stream, members outside the set are skipped without being built
+     * but still checked against the grammar. When a key appears more than once, the last occurrence wins like in
+     * Json::FromString.
+     *
+     * @param json_data Output of the lexer.
+     * @return The projected value, an object or an array like the top level of the document.
+     * @throws std::runtime_error on a syntax error in the parts of the document that are read.
+     */
+    [[nodiscard]] JsonValue Project(const JsonData &json_data) const;
+
+  private:
+    std::vector<Node> nodes_;
+};
+} // namespace simple_json
+
+#endif // FIELD_SET_H
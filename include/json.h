@@ -1,15 +1,20 @@
 #ifndef JSON_H
 #define JSON_H
 
+#include "chunk_reader.h"
 #include "config.h"
+#include "field_set.h"
+#include "json_schema.h"
 #include "json_type.h"
 #include "lexer_parser.h"
+#include "sax.h"
 
 #include <filesystem>
-#include <fstream>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 namespace simple_json
@@ -40,9 +45,10 @@ class Json
     [[nodiscard]] static Json JsonArr() noexcept;
 
     /**
-     * @brief construct a json data struct by reading a json file
+     * @brief construct a json data struct by reading a json file. Files named *.json.gz or *.json.zst are
+     * decompressed in fixed-size chunks on a worker thread while the lexer tokenizes the chunks already decompressed.
      *
-     * @param file_path - path of json file
+     * @param file_path - path of json file, *.json, *.json.gz or *.json.zst
      * @return Json - return specific json data struct
      */
     template <typename T, typename = enableIfString<T>> [[nodiscard]] static Json FromFile(T &&file_path)
@@ -51,31 +57,23 @@ class Json
         if (json_path.empty())
         {
             // 文件路径不存在，抛异常
-            throw std::invalid_argument(INVALID_PATH);
+            SIMPLE_JSON_THROW(std::invalid_argument(INVALID_PATH));
         }
 
-        if (!json_path.has_extension() || json_path.extension() != ".json")
+        const std::optional<Compression> compression = CompressionOf(json_path);
+        if (!compression)
         {
             // 文件不是json文件，抛异常
-            throw std::invalid_argument(INVALID_FILE);
+            SIMPLE_JSON_THROW(std::invalid_argument(INVALID_FILE));
         }
 
-        std::string json_str;
+        // 文件按块读取，词法分析器随着数据块到达增量切分token，不需要先把整个文件读入内存
+        Lexer lexer;
+        ReadChunks(json_path, *compression, [&lexer](const std::string_view chunk) { lexer.Feed(chunk); });
+        lexer.Finish();
 
-        std::fstream fs;
-        fs.open(json_path, std::ios::in);
-        if (!fs.is_open())
-        {
-            throw std::runtime_error(FAILED_OPEN_FILE);
-        }
-
-        std::string buffer;
-        while (std::getline(fs, buffer))
-        {
-            json_str += buffer + '\n';
-        }
-
-        return Json(std::move(json_str));
+        Parser parser(lexer.TakeToken());
+        return Json(parser.TakeJsonAst());
     }
 
     /**
@@ -89,6 +87,64 @@ class Json
         return Json(std::forward<T>(json_str));
     }
 
+    /**
+     * @brief construct a json data struct from specific string, validating it against a schema while parsing. The
+     * tree is only built up to the first violation.
+     *
+     * @param json_str - specific string that contains a json data struct
+     * @param schema - compiled schema the json data struct must satisfy
+     * @return Json - return specific json data struct object
+     */
+    template <typename T, typename = enableIfString<T>>
+    [[nodiscard]] static Json FromString(T &&json_str, const JsonSchema &schema)
+    {
+        Lexer lexer(std::forward<T>(json_str));
+        const JsonData json_data = lexer.TakeToken();
+
+        // 校验器在前，出现违反约束的值时构建器不会再收到后续事件
+        SchemaValidator validator(schema);
+        JsonBuilder builder;
+        SaxTee tee(validator, builder);
+        SaxReader reader(json_data);
+        if (!reader.Parse(tee))
+        {
+            reader.ThrowError();
+        }
+
+        return Json(builder.TakeValue());
+    }
+
+    /**
+     * @brief construct a json data struct that only contains the members listed in a field set. Other members are
+     * skipped without being built.
+     *
+     * @param json_str - specific string that contains a json data struct
+     * @param fields - key paths to keep, such as "user.id"
+     * @return Json - return the projected json data struct object
+     */
+    template <typename T, typename = enableIfString<T>>
+    [[nodiscard]] static Json FromString(T &&json_str, const FieldSet &fields)
+    {
+        Lexer lexer(std::forward<T>(json_str));
+        const JsonData json_data = lexer.TakeToken();
+        return Json(fields.Project(json_data));
+    }
+
+    /**
+     * @brief Get the root json value.
+     *
+     * @return JsonValue& - reference to the root json value.
+     */
+    [[nodiscard]] JsonValue &GetValue() noexcept
+    {
+        return data_;
+    }
+
+    [[nodiscard]] const JsonValue &GetValue() const noexcept
+    {
+        return data_;
+    }
+
     template <typename T, typename = std::enable_if_t<std::is_integral_v<T> || std::is_constructible_v<std::string, T>>>
     JsonValue &operator[](T &&index)
     {
@@ -96,13 +152,13 @@ class Json
         {
             if (data_.GetType() != JsonType::Array)
             {
-                throw std::invalid_argument(ERR_ARRAY_INTEGRAL);
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_ARRAY_INTEGRAL));
             }
 
-            std::vector<JsonValue> array = data_.GetVal<JsonType::Array>();
+            const auto &array = data_.GetVal<JsonType::Array>();
             if (index < 0 || index >= array.size())
             {
-                throw std::out_of_range(ERR_OUT_OF_RANGE);
+                SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
             }
 
             return data_.GetVal<JsonType::Array>()[std::forward<T>(index)];
@@ -111,14 +167,14 @@ class Json
         {
             if (data_.GetType() != JsonType::Object)
             {
-                throw std::invalid_argument(ERR_OBJECT_STRING);
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_OBJECT_STRING));
             }
 
             std::string key(std::forward<T>(index));
-            std::unordered_map<std::string, JsonValue> object = data_.GetVal<JsonType::Object>();
+            const auto &object = data_.GetVal<JsonType::Object>();
             if (object.find(key) == object.end())
             {
-                throw std::invalid_argument(ERR_INVALID_KEY);
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_KEY));
             }
 
             return data_.GetVal<JsonType::Object>()[std::move(key)];
@@ -136,9 +192,13 @@ class Json
     template <typename T, typename = enableIfString<T>> explicit Json(T &&json_str)
     {
         Lexer lexer(std::forward<T>(json_str));
-        Parser parser(std::move(lexer.GetToken()));
+        Parser parser(lexer.TakeToken());
+
+        data_ = parser.TakeJsonAst();
+    }
 
-        data_ = std::move(parser.GetJsonAst());
+    explicit Json(JsonValue &&value) noexcept : data_(std::move(value))
+    {
     }
 
     /**
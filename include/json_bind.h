@@ -0,0 +1,530 @@
+#ifndef JSON_BIND_H
+#define JSON_BIND_H
+
+#include "config.h"
+#include "lexer_parser.h"
+#include "utilities.h"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+// 结构体成员与json键的对应关系
+template <typename Class, typename Member> struct JsonField
+{
+    std::string_view name_;  // json中的键
+    Member Class::*member_; // 对应的结构体成员
+};
+
+/**
+ * @brief Describes one struct member for a JsonBinding specialization.
+ *
+ * @param name The key used in json text.
+ * @param member Pointer to the struct member.
+ * @return The field descriptor.
+ */
+template <typename Class, typename Member>
+constexpr JsonField<Class, Member> MakeField(const std::string_view name, Member Class::*member) noexcept
+{
+    return {name, member};
+}
+
+// 结构体与json对象之间的映射表，用户需要为自己的结构体特化它，并提供一个名为FIELDS的constexpr tuple，例如:
+// template <> struct simple_json::JsonBinding<Point> {
+//     static constexpr auto FIELDS = std::make_tuple(JSON_FIELD(Point, x), JSON_FIELD(Point, y));
+// };
+// 也可以直接使用 JSON_BINDING(Point, JSON_FIELD(Point, x), JSON_FIELD(Point, y))
+template <typename T> struct JsonBinding;
+
+#define JSON_FIELD(Class, member) ::simple_json::MakeField(#member, &Class::member)
+#define JSON_BINDING(Class, ...)                                                                                       \
+    template <> struct simple_json::JsonBinding<Class>                                                                 \
+    {                                                                                                                  \
+        static constexpr auto FIELDS = std::make_tuple(__VA_ARGS__);                                                   \
+    };
+
+namespace bind_detail
+{
+template <typename T, typename = void> struct IsBound : std::false_type
+{
+};
+template <typename T> struct IsBound<T, std::void_t<decltype(JsonBinding<T>::FIELDS)>> : std::true_type
+{
+};
+
+template <typename T> struct IsVector : std::false_type
+{
+};
+template <typename T> struct IsVector<std::vector<T>> : std::true_type
+{
+};
+
+template <typename T> struct IsOptional : std::false_type
+{
+};
+template <typename T> struct IsOptional<std::optional<T>> : std::true_type
+{
+};
+
+template <typename T> inline constexpr bool ALWAYS_FALSE = false;
+
+// 带种子的FNV-1a哈希，编译期和运行期使用同一份实现
+constexpr uint64_t HashKey(const std::string_view key, const uint64_t seed) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (const char ch : key)
+    {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash ^ (hash >> 29);
+}
+
+// 哈希表容量：至少为键数量的4倍，保证很快能找到无冲突的种子
+constexpr size_t TableCapacity(const size_t count) noexcept
+{
+    size_t capacity = 1;
+    while (capacity < count * 4)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// 编译期生成的完美哈希表，slots_中存放字段下标，EMPTY_SLOT表示空槽
+template <size_t Count> struct PerfectHash
+{
+    static constexpr size_t CAPACITY = TableCapacity(Count);
+    static constexpr uint16_t EMPTY_SLOT = 0xFFFF;
+
+    uint64_t seed_{0};
+    size_t mask_{0};
+    std::array<uint16_t, CAPACITY> slots_{};
+    bool found_{false};
+};
+
+template <size_t Count>
+constexpr PerfectHash<Count> BuildPerfectHash(const std::array<std::string_view, Count> &names) noexcept
+{
+    PerfectHash<Count> table;
+    // 从最小的2的幂开始尝试，冲突太多就扩大表，直到找到一个没有冲突的种子
+    for (size_t size = TableCapacity(Count) / 4 == 0 ? 1 : TableCapacity(Count) / 4;
+         size <= PerfectHash<Count>::CAPACITY && !table.found_; size <<= 1)
+    {
+        for (uint64_t seed = 0; seed < 256 && !table.found_; ++seed)
+        {
+            for (auto &slot : table.slots_)
+            {
+                slot = PerfectHash<Count>::EMPTY_SLOT;
+            }
+
+            bool collided = false;
+            for (size_t i = 0; i < Count && !collided; ++i)
+            {
+                auto &slot = table.slots_[HashKey(names[i], seed) & (size - 1)];
+                if (slot != PerfectHash<Count>::EMPTY_SLOT)
+                {
+                    collided = true;
+                }
+                else
+                {
+                    slot = static_cast<uint16_t>(i);
+                }
+            }
+
+            if (!collided)
+            {
+                table.seed_ = seed;
+                table.mask_ = size - 1;
+                table.found_ = true;
+            }
+        }
+    }
+    return table;
+}
+
+template <typename Tuple, size_t... Is>
+constexpr std::array<std::string_view, sizeof...(Is)> FieldNames(const Tuple &fields,
+                                                                 std::index_sequence<Is...> /*unused*/) noexcept
+{
+    return {std::get<Is>(fields).name_...};
+}
+
+// 每个绑定类型在编译期生成的元信息
+template <typename T> struct BindingMeta
+{
+    static constexpr size_t COUNT = std::tuple_size_v<std::decay_t<decltype(JsonBinding<T>::FIELDS)>>;
+    static constexpr std::array<std::string_view, COUNT> NAMES =
+        FieldNames(JsonBinding<T>::FIELDS, std::make_index_sequence<COUNT>{});
+    static constexpr PerfectHash<COUNT> TABLE = BuildPerfectHash<COUNT>(NAMES);
+
+    static_assert(COUNT < PerfectHash<COUNT>::EMPTY_SLOT, "too many fields in json binding");
+    static_assert(TABLE.found_, "failed to build perfect hash for json binding, are there duplicate keys?");
+
+    /**
+     * @brief Finds the field index for a json key.
+     *
+     * @return The field index, or COUNT if the key is unknown.
+     */
+    static size_t Find(const std::string_view key) noexcept
+    {
+        const uint16_t slot = TABLE.slots_[HashKey(key, TABLE.seed_) & TABLE.mask_];
+        if (slot == PerfectHash<COUNT>::EMPTY_SLOT || NAMES[slot] != key)
+        {
+            return COUNT;
+        }
+        return slot;
+    }
+};
+
+// 根据运行期的字段下标分发到对应的编译期字段
+template <typename T, typename Func, size_t... Is>
+void VisitField(const size_t index, Func &&func, std::index_sequence<Is...> /*unused*/)
+{
+    static_cast<void>(((index == Is ? (func(std::get<Is>(JsonBinding<T>::FIELDS)), true) : false) || ...));
+}
+
+// 解码上下文，第一个错误出现时立即以Parser相同的格式抛出
+class DecodeContext
+{
+  public:
+    explicit DecodeContext(const JsonData &json_data) noexcept : reader_(json_data)
+    {
+    }
+
+    TokenReader &Reader() noexcept
+    {
+        return reader_;
+    }
+
+    [[noreturn]] void Fail(std::string err_desc, const Token *token, const size_t highlight_pos = 0,
+                           const size_t highlight_len = 0)
+    {
+        err_reporter_.AddError(reader_.MakeErrInfo(std::move(err_desc), token, highlight_pos, highlight_len));
+        err_reporter_.ThrowError();
+        std::abort(); // ThrowError在有错误时一定会抛异常，这里只是为了满足[[noreturn]]
+    }
+
+    [[noreturn]] void FailMismatch(const std::string_view field, const Token *token)
+    {
+        Fail(ERR_TYPE_MISMATCH + std::string("in field \"") + std::string(field) + "\"", token);
+    }
+
+  private:
+    TokenReader reader_;
+    ErrReporter err_reporter_;
+};
+
+template <typename T> void DecodeValue(DecodeContext &ctx, T &out, std::string_view field);
+
+template <typename T> void DecodeObject(DecodeContext &ctx, T &out, const std::string_view field)
+{
+    using Meta = BindingMeta<T>;
+    TokenReader &reader = ctx.Reader();
+    if (reader.Current()->type_ != TokenType::LBRACE)
+    {
+        ctx.FailMismatch(field, reader.Current());
+    }
+
+    if (reader.Peek()->type_ == TokenType::RBRACE)
+    {
+        reader.Advance();
+        return;
+    }
+
+    while (true)
+    {
+        const Token *key = reader.Advance();
+        if (key->type_ != TokenType::STR)
+        {
+            ctx.Fail(ERR_OBJECT_KEY_MUST_BE_STRING, key);
+        }
+        if (reader.Peek()->type_ != TokenType::COLON)
+        {
+            ctx.Fail(ERR_COLON_EXPECTED, key, key->col_ + key->len_, 1);
+        }
+        reader.Advance();
+        const Token *value = reader.Advance();
+
+        const size_t index = Meta::Find(key->raw_value_);
+        if (index == Meta::COUNT)
+        {
+            // 未知的键直接跳过，不构造任何值，但仍然检查语法
+            if (const char *err_desc = nullptr; !reader.SkipValue(err_desc))
+            {
+                ctx.Fail(err_desc, reader.Current());
+            }
+        }
+        else
+        {
+            VisitField<T>(
+                index, [&](const auto &desc) { DecodeValue(ctx, out.*(desc.member_), desc.name_); },
+                std::make_index_sequence<Meta::COUNT>{});
+        }
+
+        const Token *last = reader.Current();
+        const Token *next = reader.Advance();
+        if (next->type_ == TokenType::RBRACE)
+        {
+            return;
+        }
+        if (next->type_ != TokenType::COMMA)
+        {
+            ctx.Fail(ERR_COMMA_OR_BRACE_EXPECTED, last, last->col_ + last->len_, 1);
+        }
+        if (!ALLOW_TRAILING_COMMA && reader.Peek()->type_ == TokenType::RBRACE)
+        {
+            ctx.Fail(ERR_TRAILING_COMMA, next);
+        }
+    }
+}
+
+template <typename T> void DecodeArray(DecodeContext &ctx, std::vector<T> &out, const std::string_view field)
+{
+    TokenReader &reader = ctx.Reader();
+    if (reader.Current()->type_ != TokenType::LBRACKET)
+    {
+        ctx.FailMismatch(field, reader.Current());
+    }
+
+    out.clear();
+    if (reader.Peek()->type_ == TokenType::RBRACKET)
+    {
+        reader.Advance();
+        return;
+    }
+
+    while (true)
+    {
+        reader.Advance();
+        DecodeValue(ctx, out.emplace_back(), field);
+
+        const Token *last = reader.Current();
+        const Token *next = reader.Advance();
+        if (next->type_ == TokenType::RBRACKET)
+        {
+            return;
+        }
+        if (next->type_ != TokenType::COMMA)
+        {
+            ctx.Fail(ERR_COMMA_OR_BRACKET_EXPECTED, last, last->col_ + last->len_, 1);
+        }
+        if (!ALLOW_TRAILING_COMMA && reader.Peek()->type_ == TokenType::RBRACKET)
+        {
+            ctx.Fail(ERR_TRAILING_COMMA, next);
+        }
+    }
+}
+
+template <typename T> void DecodeValue(DecodeContext &ctx, T &out, const std::string_view field)
+{
+    const Token *token = ctx.Reader().Current();
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        if (token->type_ != TokenType::TRUE && token->type_ != TokenType::FALSE)
+        {
+            ctx.FailMismatch(field, token);
+        }
+        out = token->type_ == TokenType::TRUE;
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        const std::string &raw = token->raw_value_;
+        if (token->type_ != TokenType::NUM)
+        {
+            ctx.FailMismatch(field, token);
+        }
+        // 带小数点或者指数的数字，以及超出目标类型范围的数字，都视为类型不匹配
+        const auto [end, err] = std::from_chars(raw.data(), raw.data() + raw.size(), out);
+        if (err != std::errc() || end != raw.data() + raw.size())
+        {
+            ctx.FailMismatch(field, token);
+        }
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        if (token->type_ != TokenType::NUM)
+        {
+            ctx.FailMismatch(field, token);
+        }
+        out = static_cast<T>(std::strtold(token->raw_value_.c_str(), nullptr));
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        if (token->type_ != TokenType::STR)
+        {
+            ctx.FailMismatch(field, token);
+        }
+        out = token->raw_value_;
+    }
+    else if constexpr (IsOptional<T>::value)
+    {
+        if (token->type_ == TokenType::NULL_)
+        {
+            out.reset();
+        }
+        else
+        {
+            DecodeValue(ctx, out.emplace(), field);
+        }
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        DecodeArray(ctx, out, field);
+    }
+    else if constexpr (IsBound<T>::value)
+    {
+        DecodeObject(ctx, out, field);
+    }
+    else
+    {
+        static_assert(ALWAYS_FALSE<T>, "unsupported member type in json binding");
+    }
+}
+
+template <typename T> void AppendNumber(std::string &out, const T value)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        if (!std::isfinite(value))
+        {
+            out.append("null"); // json没有nan和inf
+            return;
+        }
+    }
+
+    char buffer[64];
+    const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+template <typename T> void EncodeValue(std::string &out, const T &value)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        out.append(value ? "true" : "false");
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+        AppendNumber(out, value);
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        AppendEscaped(out, value);
+    }
+    else if constexpr (IsOptional<T>::value)
+    {
+        if (value.has_value())
+        {
+            EncodeValue(out, *value);
+        }
+        else
+        {
+            out.append("null");
+        }
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        out.push_back('[');
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            if (i != 0)
+            {
+                out.push_back(',');
+            }
+            EncodeValue(out, value[i]);
+        }
+        out.push_back(']');
+    }
+    else if constexpr (IsBound<T>::value)
+    {
+        out.push_back('{');
+        bool first = true;
+        std::apply(
+            [&](const auto &...desc) {
+                const auto encode_field = [&](const auto &field) {
+                    if (!first)
+                    {
+                        out.push_back(',');
+                    }
+                    first = false;
+                    AppendEscaped(out, field.name_);
+                    out.push_back(':');
+                    EncodeValue(out, value.*(field.member_));
+                };
+                (encode_field(desc), ...);
+            },
+            JsonBinding<T>::FIELDS);
+        out.push_back('}');
+    }
+    else
+    {
+        static_assert(ALWAYS_FALSE<T>, "unsupported member type in json binding");
+    }
+}
+} // namespace bind_detail
+
+/**
+ * @brief Decodes a json object straight into a bound struct, no JsonValue tree is built. Keys that are not listed in
+ * the binding are skipped, keys missing from the json text keep the value already stored in out.
+ *
+ * @param json_str A string that contains a json object.
+ * @param out The struct to fill, JsonBinding<T> must be specialized for it.
+ */
+template <typename T, typename S, typename = enableIfString<S>> void DecodeStruct(S &&json_str, T &out)
+{
+    static_assert(bind_detail::IsBound<T>::value, "DecodeStruct requires a JsonBinding specialization");
+
+    Lexer lexer(std::forward<S>(json_str));
+    const JsonData json_data = lexer.TakeToken();
+
+    bind_detail::DecodeContext ctx(json_data);
+    if (const Token *top = ctx.Reader().Current(); top->type_ != TokenType::LBRACE)
+    {
+        ctx.Fail(ERR_TYPE_NOT_OBJECT, top);
+    }
+    bind_detail::DecodeObject(ctx, out, "");
+}
+
+/**
+ * @brief Decodes a json object straight into a default constructed bound struct.
+ *
+ * @param json_str A string that contains a json object.
+ * @return The decoded struct.
+ */
+template <typename T, typename S, typename = enableIfString<S>> [[nodiscard]] T DecodeStruct(S &&json_str)
+{
+    T out{};
+    DecodeStruct(std::forward<S>(json_str), out);
+    return out;
+}
+
+/**
+ * @brief Encodes a bound struct as compact json text, members are written in the order of the binding.
+ *
+ * @param value The struct to encode, JsonBinding<T> must be specialized for it.
+ * @return The json text.
+ */
+template <typename T> [[nodiscard]] std::string EncodeStruct(const T &value)
+{
+    static_assert(bind_detail::IsBound<T>::value, "EncodeStruct requires a JsonBinding specialization");
+
+    std::string out;
+    bind_detail::EncodeValue(out, value);
+    return out;
+}
+} // namespace simple_json
+
+#endif // JSON_BIND_H
@@ -0,0 +1,23 @@
+#ifndef JSON_DIFF_H
+#define JSON_DIFF_H
+
+#include "json_type.h"
+
+namespace simple_json
+{
+/**
+ * @brief Computes a JSON Patch (RFC 6902) that turns source into target.
+ *
+ * Every subtree is hashed once, subtrees and array elements with different hashes are told apart without walking
+ * them, and equal hashes are confirmed with operator== before a subtree is skipped, so a hash collision never hides a
+ * change. Array elements are matched this way, so insertions and deletions in long arrays produce add/remove
+ * operations instead of rewriting every element after them. The walk only descends into subtrees that differ.
+ *
+ * @param source The old document.
+ * @param target The new document.
+ * @return A patch document that JsonPatch::Compile accepts, an empty array if the documents are equal.
+ */
+[[nodiscard]] JsonValue Diff(const JsonValue &source, const JsonValue &target);
+} // namespace simple_json
+
+#endif // JSON_DIFF_H
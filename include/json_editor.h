@@ -0,0 +1,106 @@
+#ifndef JSON_EDITOR_H
+#define JSON_EDITOR_H
+
+#include "json_pointer.h"
+#include "json_type.h"
+#include "lexer_parser.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+/**
+ * @brief Edits a json document while keeping the original text of everything that was not touched. Each parsed value
+ * remembers its span in the source, ToString copies unchanged spans verbatim and only serializes modified subtrees.
+ */
+class JsonEditor
+{
+  public:
+    /**
+     * @brief Parses a json string and records the source span of each value.
+     *
+     * @param json_str The json document, the top level must be an object or an array.
+     * @throws std::runtime_error on a syntax error.
+     */
+    template <typename T, typename = enableIfString<T>> explicit JsonEditor(T &&json_str)
+    {
+        Lexer lexer(std::forward<T>(json_str));
+        json_data_ = lexer.TakeToken();
+        Load();
+    }
+
+    /**
+     * @brief Reads a json file byte for byte, so that ToString reproduces it exactly when nothing was edited.
+     *
+     * @param file_path Path of a .json file.
+     */
+    [[nodiscard]] static JsonEditor FromFile(const std::filesystem::path &file_path);
+
+    /**
+     * @brief The current document, including all edits.
+     */
+    [[nodiscard]] const JsonValue &GetValue() const noexcept
+    {
+        return value_;
+    }
+
+    /**
+     * @brief Replaces the referenced value, or adds it when its parent is an object without that key or an array and
+     * the last segment is "-" or the array size.
+     *
+     * @throws std::invalid_argument if neither the value nor its parent container exists.
+     */
+    void Set(const JsonPointer &pointer, JsonValue value);
+
+    /**
+     * @brief Removes the referenced member or element.
+     *
+     * @throws std::invalid_argument if the value does not exist or the pointer refers to the whole document.
+     */
+    void Remove(const JsonPointer &pointer);
+
+    /**
+     * @brief Writes the document, unchanged subtrees keep their original text and formatting.
+     */
+    [[nodiscard]] std::string ToString() const;
+
+    /**
+     * @brief Writes the document to a file.
+     */
+    void Save(const std::filesystem::path &file_path) const;
+
+  private:
+    static constexpr size_t NO_SPAN = static_cast<size_t>(-1); // 值没有对应的源文本，例如新增的成员
+
+    // 一个值在源字符串中的位置，偏移量均为字节下标，左闭右开
+    struct Span
+    {
+        size_t item_begin_; // 对象成员从键开始，数组元素与begin_相同
+        size_t begin_;
+        size_t end_;
+        std::string key_;                   // 对象成员的键
+        std::vector<size_t> children_;      // 按源文本顺序排列的子节点
+        std::vector<std::string> inserted_; // 新增的对象成员，按添加顺序写在最后
+        bool is_object_ = false;
+        bool removed_ = false;
+        bool replaced_ = false; // 整个值需要重新序列化
+        bool dirty_ = false;    // 子孙节点有修改
+    };
+
+    JsonData json_data_;
+    JsonValue value_;
+    std::vector<Span> spans_; // 下标0为顶层值
+
+    void Load();
+    size_t BuildSpan(TokenReader &reader, size_t item_begin);
+    [[nodiscard]] size_t Offset(const Token *token) const;
+    [[nodiscard]] size_t FindChild(const Span &span, const PointerSegment &segment) const noexcept;
+    void Write(std::string &out, size_t span_index, const JsonValue &value) const;
+};
+} // namespace simple_json
+
+#endif // JSON_EDITOR_H
@@ -0,0 +1,79 @@
+#ifndef JSON_PATCH_H
+#define JSON_PATCH_H
+
+#include "json_pointer.h"
+#include "json_type.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace simple_json
+{
+/**
+ * @brief A JSON Patch (RFC 6902) document with its pointers parsed once, applied in place and atomically: when an
+ * operation fails, the operations already applied are undone and the target is left unchanged.
+ */
+class JsonPatch
+{
+  public:
+    /**
+     * @brief Compiles a patch document, an array of operation objects.
+     *
+     * @param patch The patch document.
+     * @return The compiled patch.
+     * @throws std::invalid_argument if the patch document is malformed.
+     */
+    [[nodiscard]] static JsonPatch Compile(const JsonValue &patch);
+
+    /**
+     * @brief Applies the patch, the values of add/replace/test operations are copied so the patch can be reused.
+     *
+     * @throws std::runtime_error if an operation fails, the target is rolled back first.
+     */
+    void Apply(JsonValue &target) const &;
+
+    /**
+     * @brief Applies a patch that is not needed afterwards, the values of add/replace operations are moved into the
+     * target instead of being copied.
+     *
+     * @throws std::runtime_error if an operation fails, the target is rolled back first.
+     */
+    void Apply(JsonValue &target) &&;
+
+  private:
+    struct Operation
+    {
+        enum class Op : uint8_t
+        {
+            Add,
+            Remove,
+            Replace,
+            Move,
+            Copy,
+            Test
+        };
+
+        Op op_;
+        JsonPointer path_;
+        JsonPointer from_; // 只用于move和copy
+        JsonValue value_;  // 只用于add、replace和test
+    };
+
+    std::vector<Operation> operations_;
+
+    // Operations为const时复制操作中的值，否则把值移动到目标中
+    template <typename Operations> static void ApplyImpl(Operations &operations, JsonValue &target);
+};
+
+/**
+ * @brief Applies a JSON Merge Patch (RFC 7396) in place, members set to null are removed.
+ */
+void ApplyMergePatch(JsonValue &target, const JsonValue &patch);
+
+/**
+ * @brief Applies a JSON Merge Patch (RFC 7396) in place, the values of the patch are moved into the target.
+ */
+void ApplyMergePatch(JsonValue &target, JsonValue &&patch);
+} // namespace simple_json
+
+#endif // JSON_PATCH_H
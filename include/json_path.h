@@ -0,0 +1,105 @@
+#ifndef JSON_PATH_H
+#define JSON_PATH_H
+
+#include "json_type.h"
+#include "lexer_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+// 过滤表达式 [?(@.key op literal)] 或 [?(@ op literal)]，没有运算符时只判断键是否存在
+struct PathFilter
+{
+    enum class Op : uint8_t
+    {
+        Exists,
+        Eq,
+        Ne,
+        Lt,
+        Le,
+        Gt,
+        Ge
+    };
+
+    bool has_key_ = false; // false表示比较元素本身
+    std::string key_;
+    Op op_ = Op::Exists;
+    JsonValue literal_; // 只允许标量
+};
+
+// 路径中的一步，recursive_为true时对应 ..，该步可以匹配任意深度的后代
+struct PathStep
+{
+    enum class Kind : uint8_t
+    {
+        Name,     // .name 或 ['a','b']
+        Wildcard, // .* 或 [*]
+        Index,    // [0] 或 [0,2]
+        Slice,    // [start:end]，end缺省表示到数组末尾
+        Filter    // [?(...)]
+    };
+
+    Kind kind_ = Kind::Wildcard;
+    bool recursive_ = false;
+    std::vector<std::string> names_;
+    std::vector<size_t> indices_;
+    size_t slice_begin_ = 0;
+    size_t slice_end_ = static_cast<size_t>(-1);
+    PathFilter filter_;
+};
+
+/**
+ * @brief A JSONPath compiled into a small automaton that runs over the token stream. Subtrees that cannot lead to a
+ * match are only checked against the grammar, just the matching values are built into JsonValue.
+ *
+ * Supported syntax: $, .name, ['name'], [n], [n,m], [start:end], .*, [*], ..name, ..*, ..[n] and filters on scalar
+ * comparisons such as [?(@.price < 10)], [?(@ == 'x')] or [?(@.isbn)]. Negative indices are not supported because
+ * the array length is unknown while streaming.
+ */
+class JsonPath
+{
+  public:
+    /**
+     * @brief Compiles a path.
+     *
+     * @param path The JSONPath expression, it must start with '$'.
+     * @throws std::invalid_argument if the path is malformed or uses unsupported syntax.
+     */
+    explicit JsonPath(std::string_view path);
+
+    /**
+     * @brief Evaluates the path over a token stream.
+     *
+     * @param json_data Output of the lexer.
+     * @return The matching values in document order.
+     * @throws std::runtime_error on a syntax error in the parts of the document that are read.
+     */
+    [[nodiscard]] std::vector<JsonValue> Query(const JsonData &json_data) const;
+
+    /**
+     * @brief Tokenizes a json string and evaluates the path over it.
+     */
+    template <typename T, typename = enableIfString<T>> [[nodiscard]] std::vector<JsonValue> Query(T &&json_str) const
+    {
+        Lexer lexer(std::forward<T>(json_str));
+        const JsonData json_data = lexer.TakeToken();
+        return Query(json_data);
+    }
+
+    [[nodiscard]] const std::vector<PathStep> &Steps() const noexcept
+    {
+        return steps_;
+    }
+
+  private:
+    std::vector<PathStep> steps_; // 自动机的第i个状态表示已经匹配了前i步
+};
+} // namespace simple_json
+
+#endif // JSON_PATH_H
@@ -0,0 +1,113 @@
+#ifndef JSON_POINTER_H
+#define JSON_POINTER_H
+
+#include "json_type.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+// json pointer中的一段，解析时预先计算好数组下标
+struct PointerSegment
+{
+    static constexpr size_t NOT_INDEX = static_cast<size_t>(-1); // 该段不是合法的数组下标
+
+    std::string key_; // 已经反转义的键
+    size_t index_;    // 作为数组下标时的值
+};
+
+/**
+ * @brief A JSON Pointer (RFC 6901) parsed once and resolved many times without allocating.
+ */
+class JsonPointer
+{
+  public:
+    JsonPointer() = default;
+
+    /**
+     * @brief Parses a pointer such as "/a/b/0/c", "~0" and "~1" are unescaped to '~' and '/'.
+     *
+     * @param pointer The pointer string, empty for the whole document.
+     * @throws std::invalid_argument if the pointer does not start with '/' or has an invalid escape.
+     */
+    explicit JsonPointer(std::string_view pointer);
+
+    /**
+     * @brief Finds the referenced value.
+     *
+     * @param root The document to search.
+     * @return Pointer to the referenced value, nullptr if any segment is missing.
+     */
+    [[nodiscard]] const JsonValue *Resolve(const JsonValue &root) const noexcept;
+    [[nodiscard]] JsonValue *Resolve(JsonValue &root) const noexcept;
+
+    [[nodiscard]] const std::vector<PointerSegment> &Segments() const noexcept
+    {
+        return segments_;
+    }
+
+    /**
+     * @brief Converts the pointer back to its escaped string form.
+     */
+    [[nodiscard]] std::string ToString() const;
+
+    /**
+     * @brief Finds one segment in a container.
+     *
+     * @return Pointer to the child, nullptr if value is not a container or has no such child.
+     */
+    [[nodiscard]] static const JsonValue *Step(const JsonValue &value, const PointerSegment &segment) noexcept;
+    [[nodiscard]] static JsonValue *Step(JsonValue &value, const PointerSegment &segment) noexcept;
+
+  private:
+    std::vector<PointerSegment> segments_;
+};
+
+/**
+ * @brief Resolves many pointers in one traversal, common prefixes are looked up only once.
+ */
+class JsonPointerBatch
+{
+  public:
+    JsonPointerBatch();
+
+    /**
+     * @brief Adds a pointer to the batch.
+     *
+     * @return The position of the pointer's result in Resolve's output.
+     */
+    size_t Add(const JsonPointer &pointer);
+
+    [[nodiscard]] size_t Size() const noexcept
+    {
+        return pointer_count_;
+    }
+
+    /**
+     * @brief Resolves every added pointer.
+     *
+     * @param root The document to search.
+     * @param results Receives one entry per pointer in insertion order, nullptr for a miss. Its capacity is reused.
+     */
+    void Resolve(const JsonValue &root, std::vector<const JsonValue *> &results) const;
+
+  private:
+    // 前缀树节点，根节点对应整个文档
+    struct TrieNode
+    {
+        PointerSegment segment_;
+        std::vector<size_t> children_;
+        std::vector<size_t> targets_; // 在此结束的pointer
+    };
+
+    std::vector<TrieNode> nodes_;
+    size_t pointer_count_ = 0;
+
+    void Visit(size_t node_index, const JsonValue &value, std::vector<const JsonValue *> &results) const;
+};
+} // namespace simple_json
+
+#endif // JSON_POINTER_H
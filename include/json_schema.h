@@ -0,0 +1,129 @@
+#ifndef JSON_SCHEMA_H
+#define JSON_SCHEMA_H
+
+#include "json_type.h"
+#include "sax.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+// 编译后的schema节点，子schema通过下标引用，整个schema保存在一个扁平数组中
+struct SchemaNode
+{
+    static constexpr size_t ANY = static_cast<size_t>(-1); // 不做任何约束的子schema
+
+    uint8_t types_ = 0xFF;   // 允许的json类型，按JsonType取位
+    bool integer_ = false;   // type为integer，小数部分为0的浮点数同样被接受
+    bool reject_all_ = false; // 布尔schema false，任何值都不被接受
+
+    std::unordered_map<std::string, size_t> properties_; // 键对应的子schema
+    std::unordered_map<std::string, size_t> required_;   // 必需的键，值为该键在已出现标记中的位置
+    size_t additional_ = ANY;                            // 不在properties中的键对应的子schema
+    size_t items_ = ANY;                                 // 数组元素对应的子schema
+
+    std::vector<JsonValue> enum_; // 只支持标量
+
+    bool has_minimum_ = false;
+    bool has_maximum_ = false;
+    bool exclusive_minimum_ = false;
+    bool exclusive_maximum_ = false;
+    long double minimum_ = 0;
+    long double maximum_ = 0;
+
+    size_t min_length_ = 0; // 按unicode码点计数
+    size_t max_length_ = static_cast<size_t>(-1);
+    size_t min_items_ = 0;
+    size_t max_items_ = static_cast<size_t>(-1);
+};
+
+/**
+ * @brief A subset of JSON Schema compiled into flat nodes, checked while the document is being parsed.
+ *
+ * Supported keywords: type, properties, required, additionalProperties, items (single schema), enum, const, minimum,
+ * maximum, exclusiveMinimum, exclusiveMaximum (boolean or numeric form), minLength, maxLength, minItems and maxItems.
+ * Annotation keywords are ignored, any other keyword is rejected when compiling.
+ */
+class JsonSchema
+{
+  public:
+    /**
+     * @brief Compiles a schema document.
+     *
+     * @param schema The schema, an object or a boolean.
+     * @return The compiled schema.
+     * @throws std::invalid_argument if the schema is malformed or uses an unsupported keyword.
+     */
+    [[nodiscard]] static JsonSchema Compile(const JsonValue &schema);
+
+    /**
+     * @brief Validates a json string without building a tree, stopping at the first violation.
+     *
+     * @param json_str The json document.
+     * @throws std::runtime_error on a syntax error or a schema violation, formatted like the parser errors.
+     */
+    void Validate(std::string json_str) const;
+
+    [[nodiscard]] const SchemaNode &Node(const size_t index) const noexcept
+    {
+        return nodes_[index];
+    }
+
+  private:
+    std::vector<SchemaNode> nodes_; // 下标0为根schema
+
+    JsonSchema() = default;
+
+    size_t CompileNode(const JsonValue &schema);
+};
+
+// 在SAX事件流上检查schema，遇到第一个违反约束的值即返回false终止解析
+class SchemaValidator : public SaxHandler
+{
+  public:
+    explicit SchemaValidator(const JsonSchema &schema) noexcept : schema_(schema)
+    {
+    }
+
+    bool StartObject() override;
+    bool Key(std::string_view key) override;
+    bool EndObject(size_t member_count) override;
+    bool StartArray() override;
+    bool EndArray(size_t element_count) override;
+    bool String(std::string_view value) override;
+    bool Int(long long value) override;
+    bool Float(long double value) override;
+    bool Bool(bool value) override;
+    bool Null() override;
+    [[nodiscard]] std::string GetError() const override;
+
+  private:
+    struct Frame
+    {
+        size_t schema_;
+        bool is_object_;
+        std::vector<bool> seen_; // 必需的键是否已经出现
+        size_t count_;           // 数组中已经出现的元素个数
+    };
+
+    const JsonSchema &schema_;
+    std::vector<Frame> frames_; // 按深度复用，避免反复分配
+    size_t depth_ = 0;
+    size_t pending_ = 0; // 下一个值对应的子schema
+    std::string err_desc_;
+
+    bool NextSchema(size_t &schema);
+    bool Fail(std::string err_desc);
+    bool CheckType(const SchemaNode &node, JsonType type, bool integral = false);
+    bool CheckEnum(const SchemaNode &node, const JsonValue &value);
+    bool CheckNumber(size_t schema, JsonType type, long double value, bool integral);
+    bool PushFrame(size_t schema, bool is_object);
+};
+} // namespace simple_json
+
+#endif // JSON_SCHEMA_H
@@ -1,8 +1,10 @@
 #ifndef JSON_TYPES_H
 #define JSON_TYPES_H
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <stdexcept>
 #include <string>
@@ -29,12 +31,78 @@ enum class JsonType : uint8_t
 };
 std::ostream &operator<<(std::ostream &os, const JsonType &type);
 
+/**
+ * @brief Heap memory held by a JsonValue tree, in bytes, split by what it is spent on. Sizes follow the node based
+ * layout of the common standard libraries and leave out the allocator's own per-block overhead.
+ */
+struct MemoryFootprint
+{
+    size_t nodes_{0};          // 数组元素和对象成员节点，包括节点中的指针、缓存的哈希值和键的string对象
+    size_t capacity_slack_{0}; // vector和堆上字符串已分配但未使用的容量
+    size_t strings_{0};        // 超出短字符串缓冲区的字符串内容，包括对象的键和结尾的'\0'
+    size_t hash_buckets_{0};   // 对象的桶数组
+
+    [[nodiscard]] size_t Total() const noexcept
+    {
+        return nodes_ + capacity_slack_ + strings_ + hash_buckets_;
+    }
+
+    MemoryFootprint &operator+=(const MemoryFootprint &other) noexcept
+    {
+        nodes_ += other.nodes_;
+        capacity_slack_ += other.capacity_slack_;
+        strings_ += other.strings_;
+        hash_buckets_ += other.hash_buckets_;
+        return *this;
+    }
+};
+
 class JsonValue
 {
     JsonType cur_type_; // 当前的json类型
     std::variant<std::unordered_map<std::string, JsonValue>, std::vector<JsonValue>, std::string, long long,
                  long double, bool, std::nullptr_t>
         cur_val_;
+#if CACHE_HASH
+    // 缓存的哈希值，0表示尚未计算；多个线程读同一个文档时可能同时写入相同的值，用原子变量避免数据竞争
+    class CachedHash
+    {
+        mutable std::atomic<size_t> value_{0};
+
+      public:
+        CachedHash() = default;
+        ~CachedHash() = default;
+
+        CachedHash(const CachedHash &other) noexcept : value_(other.Load())
+        {
+        }
+
+        CachedHash &operator=(const CachedHash &other) noexcept
+        {
+            Store(other.Load());
+            return *this;
+        }
+
+        [[nodiscard]] size_t Load() const noexcept
+        {
+            return value_.load(std::memory_order_relaxed);
+        }
+
+        void Store(const size_t hash) const noexcept
+        {
+            value_.store(hash, std::memory_order_relaxed);
+        }
+    };
+    CachedHash hash_;
+#endif
+
+    // 通过非const接口访问后内容可能被修改，缓存的哈希值失效
+    void InvalidateHash() const noexcept
+    {
+#if CACHE_HASH
+        hash_.Store(0);
+#endif
+    }
 
   public:
     template <typename T, typename = enableIfJson<T>> JsonValue(T &&val)
@@ -79,6 +147,7 @@ class JsonValue
 
     template <typename T, typename = enableIfJson<T>> JsonValue &operator=(T &&val) noexcept
     {
+        InvalidateHash();
         if constexpr (std::is_same_v<std::decay_t<T>, std::unordered_map<std::string, JsonValue>>)
         {
             cur_val_.emplace<std::unordered_map<std::string, JsonValue>>(std::forward<T>(val));
@@ -172,7 +241,7 @@ class JsonValue
         if (Type != cur_type_)
         {
             const std::string func_info("in function getval()!");
-            throw std::runtime_error(ERR_TYPE_MISMATCH + func_info);
+            SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + func_info));
         }
 
         if constexpr (Type == JsonType::Object)
@@ -216,8 +285,9 @@ class JsonValue
         if (Type != cur_type_)
         {
             const std::string func_info("in function getval()!");
-            throw std::runtime_error(ERR_TYPE_MISMATCH + func_info);
+            SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + func_info));
         }
+        InvalidateHash();
 
         if constexpr (Type == JsonType::Object)
         {
@@ -263,13 +333,13 @@ class JsonValue
         {
             if (cur_type_ != JsonType::Array)
             {
-                throw std::invalid_argument(ERR_ARRAY_INTEGRAL);
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_ARRAY_INTEGRAL));
             }
 
-            std::vector<JsonValue> array = GetVal<JsonType::Array>();
+            const auto &array = GetVal<JsonType::Array>();
             if (index < 0 || index >= array.size())
             {
-                throw std::out_of_range(ERR_OUT_OF_RANGE);
+                SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
             }
 
             return GetVal<JsonType::Array>()[std::forward<T>(index)];
@@ -278,20 +348,54 @@ class JsonValue
         {
             if (cur_type_ != JsonType::Object)
             {
-                throw std::invalid_argument(ERR_OBJECT_STRING);
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_OBJECT_STRING));
             }
 
             std::string key(std::forward<T>(index));
-            std::unordered_map<std::string, JsonValue> object = GetVal<JsonType::Object>();
+            const auto &object = GetVal<JsonType::Object>();
             if (object.find(key) == object.end())
             {
-                throw std::invalid_argument(ERR_INVALID_KEY);
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_KEY));
             }
 
             return GetVal<JsonType::Object>()[std::move(key)];
         }
     }
 
+    /**
+     * @brief Hashes the value so that equal values have equal hashes: object members are combined independently of
+     * their order and an integer hashes like a float with the same value.
+     *
+     * With CACHE_HASH enabled each container keeps its hash until it is accessed through a non-const accessor, so
+     * hashing or comparing a mostly unchanged tree again only revisits the modified paths. A reference obtained from a
+     * non-const accessor must not be used to modify the value after one of its ancestors has been hashed again. The
+     * cache is updated atomically, so a tree that is only read, like a document shared by ParseCache, may be hashed
+     * and compared from several threads at once.
+     *
+     * @return The hash of the whole subtree.
+     */
+    [[nodiscard]] size_t Hash() const;
+
+    /**
+     * @brief Walks the subtree and adds up the heap memory it owns. The value itself is not included, add
+     * sizeof(JsonValue) when it lives on the heap too.
+     *
+     * @return The bytes owned by the subtree, by category.
+     */
+    [[nodiscard]] MemoryFootprint MemoryUsage() const;
+
+    /**
+     * @brief Structural equality: objects compare members regardless of order, arrays compare element by element and
+     * numbers compare by value, so 1 == 1.0. Type and size mismatches return immediately, as do differing cached
+     * hashes.
+     */
+    friend bool operator==(const JsonValue &lhs, const JsonValue &rhs);
+
+    friend bool operator!=(const JsonValue &lhs, const JsonValue &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
     /**
      * @brief A friend function used to print the corresponding JsonValue type with std::cout.
      *
@@ -303,4 +407,15 @@ class JsonValue
 };
 } // namespace simple_json
 
+namespace std
+{
+template <> struct hash<simple_json::JsonValue>
+{
+    size_t operator()(const simple_json::JsonValue &value) const
+    {
+        return value.Hash();
+    }
+};
+} // namespace std
+
 #endif // JSON_TYPES_H
@@ -0,0 +1,290 @@
+#ifndef LEXER_DFA_H
+#define LEXER_DFA_H
+
+#include "config.h"
+
+#include <cstdint>
+
+// 词法分析器使用的几个dfa，全部为constexpr，运行期的Lexer和编译期的StaticJson共用同一份状态转移
+namespace simple_json
+{
+// 字符串dfa基本状态
+enum class StringDfaStat : uint8_t
+{
+    STRING_START,
+    IN_STRING,
+    STRING_END,
+    STRING_ESCAPE,
+    STRING_UNICODE_START,
+    ERROR
+};
+
+// 数字dfa基本状态
+enum class NumberDfaStat : uint8_t
+{
+    NUMBER_START,
+    NUMBER_SIGN,
+    NUMBER_ZERO,
+    NUMBER_INTEGRAL,
+    NUMBER_FRACTION_BEGIN,
+    NUMBER_FRACTION,
+    NUMBER_EXPONENT_BEGIN,
+    NUMBER_EXPONENT_SIGN,
+    NUMBER_EXPONENT,
+    NUMBER_END,
+    ERROR
+};
+
+// 字面量(true, false, null)dfa基本状态
+enum class LiteralDfaStat : uint8_t
+{
+    LITERAL_START,
+    LITERAL_END,
+    ERROR,
+    TRUE_T,
+    TRUE_R,
+    TRUE_U,
+    TRUE_E,
+    FALSE_F,
+    FALSE_A,
+    FALSE_L,
+    FALSE_S,
+    FALSE_E,
+    NULL_N,
+    NULL_U,
+    NULL_L1,
+    NULL_L2
+};
+
+/**
+ * @brief Same as std::isspace in the "C" locale, but usable in constant expressions.
+ */
+constexpr bool IsJsonSpace(const char ch) noexcept
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f' || ch == '\v';
+}
+
+constexpr bool IsJsonDigit(const char ch) noexcept
+{
+    return ch >= '0' && ch <= '9';
+}
+
+constexpr bool IsHexDigit(const char ch) noexcept
+{
+    return IsJsonDigit(ch) || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+}
+
+constexpr unsigned HexValue(const char ch) noexcept
+{
+    if (IsJsonDigit(ch))
+    {
+        return static_cast<unsigned>(ch - '0');
+    }
+    if (ch >= 'a' && ch <= 'f')
+    {
+        return static_cast<unsigned>(ch - 'a' + 10);
+    }
+    return static_cast<unsigned>(ch - 'A' + 10);
+}
+
+/**
+ * @brief Checks if a number or literal token is terminated by ch. A token terminates at whitespace, ], }, \0, , or :.
+ */
+constexpr bool IsTokenEnd(const char ch) noexcept
+{
+    return IsJsonSpace(ch) || ch == ']' || ch == '\0' || ch == '}' || ch == ',' || ch == ':';
+}
+
+/**
+ * @brief Decodes a single character escape sequence (the character after the backslash).
+ *
+ * @return The decoded character, or '\0' if ch is not a single character escape (including 'u').
+ */
+constexpr char UnescapeChar(const char ch) noexcept
+{
+    switch (ch)
+    {
+    case '\\':
+        return '\\';
+    case '"':
+        return '"';
+    case '/':
+        return '/';
+    case 'b':
+        return '\b';
+    case 'f':
+        return '\f';
+    case 'r':
+        return '\r';
+    case 'n':
+        return '\n';
+    case 't':
+        return '\t';
+    default:
+        return '\0';
+    }
+}
+
+/**
+ * @brief The number dfa transition for one consumed character.
+ *
+ * @return The next state, NumberDfaStat::ERROR if ch can not continue the number.
+ */
+constexpr NumberDfaStat NextNumberStat(const NumberDfaStat stat, const char ch) noexcept
+{
+    switch (stat)
+    {
+    case NumberDfaStat::NUMBER_START:
+        if (ch == '0')
+        {
+            return NumberDfaStat::NUMBER_ZERO;
+        }
+        if (ch == '-')
+        {
+            return NumberDfaStat::NUMBER_SIGN;
+        }
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_INTEGRAL : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_SIGN:
+        if (ch == '0')
+        {
+            return NumberDfaStat::NUMBER_ZERO;
+        }
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_INTEGRAL : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_ZERO:
+        if (ch == '.')
+        {
+            return NumberDfaStat::NUMBER_FRACTION_BEGIN;
+        }
+        return ch == 'e' || ch == 'E' ? NumberDfaStat::NUMBER_EXPONENT_BEGIN : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_INTEGRAL:
+        if (ch == '.')
+        {
+            return NumberDfaStat::NUMBER_FRACTION_BEGIN;
+        }
+        if (ch == 'e' || ch == 'E')
+        {
+            return NumberDfaStat::NUMBER_EXPONENT_BEGIN;
+        }
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_INTEGRAL : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_FRACTION_BEGIN:
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_FRACTION : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_FRACTION:
+        if (ch == 'e' || ch == 'E')
+        {
+            return NumberDfaStat::NUMBER_EXPONENT_BEGIN;
+        }
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_FRACTION : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_EXPONENT_BEGIN:
+        if (ch == '-')
+        {
+            return NumberDfaStat::NUMBER_EXPONENT_SIGN;
+        }
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_EXPONENT : NumberDfaStat::ERROR;
+
+    case NumberDfaStat::NUMBER_EXPONENT_SIGN:
+    case NumberDfaStat::NUMBER_EXPONENT:
+        return IsJsonDigit(ch) ? NumberDfaStat::NUMBER_EXPONENT : NumberDfaStat::ERROR;
+
+    default:
+        return NumberDfaStat::ERROR;
+    }
+}
+
+/**
+ * @brief Checks if the number dfa may stop in this state, i.e. the consumed characters form a complete number.
+ */
+constexpr bool IsNumberAccepting(const NumberDfaStat stat) noexcept
+{
+    return stat == NumberDfaStat::NUMBER_ZERO || stat == NumberDfaStat::NUMBER_INTEGRAL ||
+           stat == NumberDfaStat::NUMBER_EXPONENT || stat == NumberDfaStat::NUMBER_FRACTION;
+}
+
+/**
+ * @brief The literal dfa transition for one consumed character.
+ *
+ * @return The next state, LiteralDfaStat::ERROR if ch can not continue the literal.
+ */
+constexpr LiteralDfaStat NextLiteralStat(const LiteralDfaStat stat, const char ch) noexcept
+{
+    // 除起始状态外，每个状态只接受唯一的一个字符
+    switch (stat)
+    {
+    case LiteralDfaStat::LITERAL_START:
+        if (ch == 't')
+        {
+            return LiteralDfaStat::TRUE_T;
+        }
+        if (ch == 'f')
+        {
+            return LiteralDfaStat::FALSE_F;
+        }
+        return ch == 'n' ? LiteralDfaStat::NULL_N : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::TRUE_T:
+        return ch == 'r' ? LiteralDfaStat::TRUE_R : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::TRUE_R:
+        return ch == 'u' ? LiteralDfaStat::TRUE_U : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::TRUE_U:
+        return ch == 'e' ? LiteralDfaStat::TRUE_E : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::FALSE_F:
+        return ch == 'a' ? LiteralDfaStat::FALSE_A : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::FALSE_A:
+        return ch == 'l' ? LiteralDfaStat::FALSE_L : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::FALSE_L:
+        return ch == 's' ? LiteralDfaStat::FALSE_S : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::FALSE_S:
+        return ch == 'e' ? LiteralDfaStat::FALSE_E : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::NULL_N:
+        return ch == 'u' ? LiteralDfaStat::NULL_U : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::NULL_U:
+        return ch == 'l' ? LiteralDfaStat::NULL_L1 : LiteralDfaStat::ERROR;
+    case LiteralDfaStat::NULL_L1:
+        return ch == 'l' ? LiteralDfaStat::NULL_L2 : LiteralDfaStat::ERROR;
+    default:
+        return LiteralDfaStat::ERROR;
+    }
+}
+
+/**
+ * @brief Checks if the literal dfa has consumed a whole literal, the token must end right after it.
+ */
+constexpr bool IsLiteralAccepting(const LiteralDfaStat stat) noexcept
+{
+    return stat == LiteralDfaStat::TRUE_E || stat == LiteralDfaStat::FALSE_E || stat == LiteralDfaStat::NULL_L2;
+}
+
+/**
+ * @brief Gets the "may be you mean ..." hint for an error raised in the given literal state.
+ */
+constexpr const char *LiteralGuess(const LiteralDfaStat stat) noexcept
+{
+    switch (stat)
+    {
+    case LiteralDfaStat::TRUE_T:
+    case LiteralDfaStat::TRUE_R:
+    case LiteralDfaStat::TRUE_U:
+    case LiteralDfaStat::TRUE_E:
+        return LITERAL_GUESS_TRUE;
+    case LiteralDfaStat::FALSE_F:
+    case LiteralDfaStat::FALSE_A:
+    case LiteralDfaStat::FALSE_L:
+    case LiteralDfaStat::FALSE_S:
+    case LiteralDfaStat::FALSE_E:
+        return LITERAL_GUESS_FALSE;
+    case LiteralDfaStat::NULL_N:
+    case LiteralDfaStat::NULL_U:
+    case LiteralDfaStat::NULL_L1:
+    case LiteralDfaStat::NULL_L2:
+        return LITERAL_GUESS_NULL;
+    default:
+        return "";
+    }
+}
+} // namespace simple_json
+
+#endif // LEXER_DFA_H
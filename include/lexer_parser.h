@@ -3,11 +3,12 @@
 
 #include "config.h"
 #include "json_type.h"
+#include "lexer_dfa.h"
 
 #include <cstddef>
 #include <cstdint>
-#include <map>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -45,10 +46,18 @@ struct Token
 // 所以我们将他们单独封装一下
 struct JsonData
 {
-    std::string source_;                                   // 原始json字符串
-    std::map<POS_T, std::pair<POS_T, POS_T>> lines_index_; // 原始json字符串每一行的起始和结束偏移量
+    std::string source_;                               // 原始json字符串
+    std::vector<std::pair<POS_T, POS_T>> lines_index_; // 原始json字符串每一行的起始和结束偏移量，下标为行号
 
     std::vector<Token> tokens_; // Token流
+
+    /**
+     * @brief The text of a line including its newline.
+     *
+     * @param row The line number, starting from 0.
+     * @return A view into source_, empty if there is no such line.
+     */
+    [[nodiscard]] std::string_view Line(POS_T row) const noexcept;
 };
 
 struct ErrInfo
@@ -94,6 +103,14 @@ class ErrReporter
      */
     [[nodiscard]] bool HasError() const noexcept;
 
+    /**
+     * @brief Formats the recorded errors with the source line and a highlight under the error.
+     *
+     * @param format_all Set to true to format all errors, or false to format only the first one.
+     * @return The multi-line error message, empty if no error was recorded.
+     */
+    [[nodiscard]] std::string FormatErrors(bool format_all = false) const;
+
     /**
      * @brief Throws all recorded error messages.
      *
@@ -101,6 +118,19 @@ class ErrReporter
      * print a single error.
      */
     void ThrowError(bool throw_all = false) const;
+
+    /**
+     * @brief Reloads the source line of every recorded error. Used when errors were found while their line was still
+     * incomplete, e.g. by a lexer fed in chunks.
+     *
+     * @param json_data The complete source and its line offsets.
+     */
+    void RefreshLines(const JsonData &json_data);
+
+    /**
+     * @brief Forgets all recorded errors, keeping the storage for reuse.
+     */
+    void Clear() noexcept;
 };
 
 class Lexer
@@ -110,13 +140,16 @@ class Lexer
     {
         data_.source_ = std::forward<T>(source);
         SplitLines();
-        Scan();
+        Scan(true);
 
         if (err_reporter_.HasError())
         {
             err_reporter_.ThrowError(true);
         }
     }
+
+    // 增量输入，原始json字符串通过Feed分块传入，全部传入后调用Finish
+    Lexer() = default;
     ~Lexer() = default;
 
     Lexer(const Lexer &) = delete;
@@ -132,72 +165,114 @@ class Lexer
      */
     [[nodiscard]] JsonData GetToken() const noexcept;
 
+    /**
+     * @brief Moves the token stream and the original JSON string out of the lexer without copying them. The lexer must
+     * not be used afterwards.
+     *
+     * @return Returns the original JSON string, the line offsets and the token stream.
+     */
+    [[nodiscard]] JsonData TakeToken() noexcept;
+
+    /**
+     * @brief Gives access to the token stream and the original JSON string without copying or moving them. The
+     * reference stays valid until the next Reset or Feed.
+     */
+    [[nodiscard]] JsonData &BorrowToken() noexcept;
+
+    /**
+     * @brief Tokenizes a new JSON string, reusing the buffers of the previous one. The source copy, line offsets and
+     * token stream are cleared instead of freed, and token strings that needed heap storage are recycled.
+     *
+     * @param source The new JSON string.
+     * @throws std::runtime_error with all lexical errors if any were found.
+     */
+    void Reset(std::string_view source);
+
+    /**
+     * @brief Appends the next chunk of the json string and tokenizes everything that is complete. A token cut off by
+     * the end of the chunk is scanned again once a character that can end it arrives, so a long token spread over
+     * many chunks is scanned in full only once.
+     *
+     * @param chunk The next part of the json string, may end anywhere, even inside a token or a utf-8 sequence.
+     */
+    void Feed(std::string_view chunk);
+
+    /**
+     * @brief Marks the end of the input fed in chunks, tokenizes the rest and appends the EOF token.
+     *
+     * @throws std::runtime_error with all lexical errors if any were found.
+     */
+    void Finish();
+
   private:
     JsonData data_;            // 当前json的所有信息，包括原始json字符串，json换行位置偏移，token流
     ErrReporter err_reporter_; // 错误处理模块
 
-    // Dfa基本状态
-    enum class StringDfaStat : uint8_t
-    {
-        STRING_START,
-        IN_STRING,
-        STRING_END,
-        STRING_ESCAPE,
-        STRING_UNICODE_START,
-        ERROR
-    };
-
-    enum class NumberDfaStat : uint8_t
-    {
-        NUMBER_START,
-        NUMBER_SIGN,
-        NUMBER_ZERO,
-        NUMBER_INTEGRAL,
-        NUMBER_FRACTION_BEGIN,
-        NUMBER_FRACTION,
-        NUMBER_EXPONENT_BEGIN,
-        NUMBER_EXPONENT_SIGN,
-        NUMBER_EXPONENT,
-        NUMBER_END,
-        ERROR
-    };
-
-    enum class LiteralDfaStat : uint8_t
-    {
-        LITERAL_START,
-        LITERAL_END,
-        ERROR,
-        TRUE_T,
-        TRUE_R,
-        TRUE_U,
-        TRUE_E,
-        FALSE_F,
-        FALSE_A,
-        FALSE_L,
-        FALSE_S,
-        FALSE_E,
-        NULL_N,
-        NULL_U,
-        NULL_L1,
-        NULL_L2
-    };
-
     POS_T cur_index_{0}; // 当前在原始json字符串中的索引
     POS_T cur_row_{0};   // 当前字符行
     POS_T cur_col_{0};   // 当前字符列
 
+    POS_T split_index_{0}; // SplitLines已经处理到的位置
+    POS_T split_begin_{0}; // 最后一个尚未以换行符结束的行的起始位置
+
+    std::vector<std::string> spare_values_; // Reset回收的token字符串，保留容量供新token复用
+
+    // 被数据块截断的token，后续数据中出现能结束它的字符之前Feed不重新扫描，长token只在结束时完整扫描一次
+    bool truncated_{false};
+    bool truncated_string_{false};  // 截断的是字符串，只有未转义的引号能结束它
+    bool truncated_escaped_{false}; // 已检查的字符串内容以未配对的反斜杠结尾
+    POS_T truncated_checked_{0};    // 已经检查过的位置
+#if PARSE_STATS
+    size_t token_escapes_{0}; // 最近一个字符串token中的转义序列个数，token被接受时才计入统计
+#endif
+
     /**
-     * @brief Marks the start and end positions of each line in the original JSON string.
+     * @brief Marks the start and end positions of each line in the original JSON string. Only the part appended since
+     * the last call is examined.
      *
      */
     void SplitLines() noexcept; // 标记原始json字符串中每行的起始位置和结束位置
 
     /**
      * @brief The entry point for the lexical analyzer. It tokenizes the original JSON string by breaking it down into a
-     * stream of tokens.
+     * stream of tokens, starting where the previous call stopped.
+     *
+     * @param at_eof Whether the whole input is available. If not, a token that reaches the end of the data is left for
+     * the next call, and no EOF token is appended.
+     */
+    void Scan(bool at_eof); // 词法分析器入口，对原始json字符串进行切分，拆分为token流
+
+    /**
+     * @brief The tokenizing loop of Scan, Scan wraps it with the statistics and probes.
+     *
+     * @param at_eof Whether the whole input is available.
+     */
+    void ScanTokens(bool at_eof);
+
+    /**
+     * @brief Scans one string, number or literal token with the given sub-parser and records it or its error.
+     *
+     * @param parse The sub-parser, one of ParseString, ParseNumber, ParseLiteral.
+     * @param at_eof Whether the whole input is available.
+     * @return Returns false if the token reached the end of incomplete input and the lexer was rewound to its start.
+     */
+    bool ScanToken(bool (Lexer::*parse)(Token &, ErrInfo &), bool at_eof);
+
+    /**
+     * @brief Rewinds to the start of a token that reached the end of incomplete input and remembers it as truncated.
      *
+     * @param begin_index Index of the first character of the token.
+     * @param begin_col Column of the first character of the token.
      */
-    void Scan(); // 词法分析器入口，对原始json字符串进行切分，拆分为token流
+    void RewindTruncated(POS_T begin_index, POS_T begin_col) noexcept;
+
+    /**
+     * @brief Checks the data appended since the last call for a character that can end the truncated token: an
+     * unescaped quote for a string, a delimiter otherwise.
+     *
+     * @return Returns true if scanning again may complete the token.
+     */
+    [[nodiscard]] bool TruncatedCanEnd() noexcept;
 
     /**
      * @brief Checks if a token is terminated. A token terminates if the current character is a ,, ], }, \0, or :.
@@ -243,6 +318,21 @@ class Lexer
      */
     [[nodiscard]] Token MakeToken(std::string &&str, TokenType type) const noexcept;
 
+    /**
+     * @brief Appends a token to the token stream.
+     *
+     * @param token The scanned token.
+     */
+    void AddToken(Token &&token);
+
+    /**
+     * @brief Starts a token at the current position, keeping the capacity of its raw value.
+     *
+     * @param token The token to initialize.
+     * @param type The type of the token.
+     */
+    void InitToken(Token &token, TokenType type) const noexcept;
+
     // 以下函数都是_scan函数的子模块
     /**
      * @brief The lexical analyzer parses a JSON string.
@@ -289,6 +379,9 @@ class Parser
             err_reporter_.ThrowError(true);
         }
     }
+
+    // 复用模式，通过Parse(JsonData &)多次解析
+    Parser() = default;
     ~Parser() = default;
 
     Parser(const Parser &) = delete;
@@ -303,12 +396,28 @@ class Parser
      */
     [[nodiscard]] JsonValue GetJsonAst() const noexcept;
 
+    /**
+     * @brief Moves the json data struct out of the parser without copying it.
+     */
+    [[nodiscard]] JsonValue TakeJsonAst() noexcept;
+
+    /**
+     * @brief Parses another token stream with a parser built by the default constructor. The token stream is borrowed
+     * and handed back unchanged, so its buffers can be reused by the lexer.
+     *
+     * @param json_data The token stream, e.g. Lexer::BorrowToken() after Lexer::Reset.
+     * @return The json data struct.
+     * @throws std::runtime_error with all syntax errors if any were found.
+     */
+    [[nodiscard]] JsonValue Parse(JsonData &json_data);
+
   private:
     JsonValue json_;           // 经过语法分析器构建的json数据结构
     JsonData json_data_;       // 从词法分析器拿到的json原始字符窜，token流和行偏移量
     ErrReporter err_reporter_; // 错误处理模块
 
     size_t cur_token_index_{0};
+    size_t depth_{0}; // 当前的嵌套层数
 
     /**
      * @brief Lexer entry point
@@ -316,6 +425,12 @@ class Parser
      */
     void Parse() noexcept; // 词法分析器入口
 
+    /**
+     * @brief Parses the top level object or array, Parse wraps it with the statistics.
+     *
+     */
+    void ParseTopLevel() noexcept;
+
     /**
      * @brief The main control function of the JSON lexical analyzer, used for parsing various JSON types.
      *
@@ -403,6 +518,125 @@ class Parser
      * notice: this method only suitable for json object.
      */
     void SynchronizeObj() noexcept;
+
+    /**
+     * @brief Enters a nested object or array. Beyond MAX_PARSE_DEPTH an error is recorded and the parser skips to the
+     * EOF token, so every open container returns at once instead of recursing further.
+     *
+     * @return Returns false if the nesting is too deep.
+     */
+    [[nodiscard]] bool EnterContainer() noexcept;
+};
+
+/**
+ * @brief A long-lived parser for services that parse many documents. The source copy, line offsets, token stream,
+ * token strings and error storage are cleared between calls instead of freed, so once they have grown to fit the
+ * largest document, a parse allocates nothing but the returned tree. One instance must not be used by several threads
+ * at once.
+ */
+class JsonParser
+{
+  public:
+    JsonParser() = default;
+    ~JsonParser() = default;
+
+    JsonParser(const JsonParser &) = delete;
+    JsonParser(JsonParser &&) = delete;
+    JsonParser &operator=(const JsonParser &) = delete;
+    JsonParser &operator=(JsonParser &&) = delete;
+
+    /**
+     * @brief Parses a json document, the top level must be an object or an array.
+     *
+     * @param json_str The document, it is copied into the reused source buffer.
+     * @return The json data struct.
+     * @throws std::runtime_error with all lexical or syntax errors if the document is invalid.
+     */
+    [[nodiscard]] JsonValue Parse(std::string_view json_str);
+
+  private:
+    Lexer lexer_;
+    Parser parser_;
+};
+
+// 轻量级的token游标，供不需要构建完整json数据结构的模块使用(例如结构体绑定)
+// 与Parser的约定一致：一个值被读取完毕后，游标停在该值的最后一个token上
+class TokenReader
+{
+  public:
+    explicit TokenReader(const JsonData &json_data) noexcept : json_data_(json_data)
+    {
+    }
+    ~TokenReader() = default;
+
+    TokenReader(const TokenReader &) = delete;
+    TokenReader(TokenReader &&) = delete;
+    TokenReader &operator=(const TokenReader &) = delete;
+    TokenReader &operator=(TokenReader &&) = delete;
+
+    /**
+     * @brief View the current token
+     *
+     * @return Pointer to the current token, the EOF_ token is returned once the stream is exhausted.
+     */
+    [[nodiscard]] const Token *Current() const noexcept;
+
+    /**
+     * @brief Look ahead one token
+     *
+     * @return Pointer to the token ahead, the EOF_ token is returned once the stream is exhausted.
+     */
+    [[nodiscard]] const Token *Peek() const noexcept;
+
+    /**
+     * @brief Advance one token.
+     *
+     * @return Return the advanced token pointer.
+     */
+    const Token *Advance() noexcept;
+
+    /**
+     * @brief Index of the current token, can be handed back to Seek to rewind the cursor.
+     */
+    [[nodiscard]] size_t Position() const noexcept
+    {
+        return cur_token_index_;
+    }
+
+    /**
+     * @brief Moves the cursor to a position previously returned by Position.
+     */
+    void Seek(size_t position) noexcept
+    {
+        cur_token_index_ = position;
+    }
+
+    /**
+     * @brief Skips the whole value starting at the current token, nothing is materialized. The tokens are still checked
+     * against the json grammar, brackets must match and keys, colons and commas must be in place, so a skipped value
+     * is rejected exactly when the parser would reject it. The cursor is left on the last token of the skipped value.
+     *
+     * @param err_desc Set to the parser's error message when the value is invalid.
+     * @return Returns false if the value is invalid or nested deeper than MAX_PARSE_DEPTH, the cursor is then left on
+     * the offending token.
+     */
+    bool SkipValue(const char *&err_desc) noexcept;
+
+    /**
+     * @brief Constructing error messages in the same format as the parser.
+     *
+     * @param err_desc Error Message
+     * @param cur_token Token corresponding to the error location
+     * @param highlight_pos Error highlight starting column, the column of cur_token is used when it is 0.
+     * @param highlight_len Error highlight length, the length of cur_token is used when it is 0.
+     * @return The error information which can be handed to ErrReporter.
+     */
+    [[nodiscard]] ErrInfo MakeErrInfo(std::string err_desc, const Token *cur_token, size_t highlight_pos = 0,
+                                      size_t highlight_len = 0) const;
+
+  private:
+    const JsonData &json_data_; // 词法分析器的输出，游标不持有它
+    size_t cur_token_index_{0};
 };
 } // namespace simple_json
 
@@ -0,0 +1,99 @@
+#ifndef MSGPACK_H
+#define MSGPACK_H
+
+#include "json_type.h"
+#include "sax.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+/**
+ * @brief Appends the MessagePack encoding of a value to out, integers and lengths use their smallest format and a
+ * float is written as float 32 when that keeps its value. A long double that a double cannot hold exactly is rounded.
+ *
+ * @param out The buffer to append to.
+ * @param value The value to encode.
+ */
+void AppendMsgPack(std::string &out, const JsonValue &value);
+
+/**
+ * @brief Encodes a value as MessagePack.
+ *
+ * @return The encoded bytes.
+ */
+[[nodiscard]] std::string ToMsgPack(const JsonValue &value);
+
+/**
+ * @brief Decodes one MessagePack object into a JsonValue, bin payloads become base64url strings.
+ *
+ * @param data The encoded bytes, must contain exactly one object.
+ * @return The decoded value.
+ * @throws std::runtime_error if the data is malformed, nested deeper than MAX_PARSE_DEPTH or cannot be represented
+ * as json.
+ */
+[[nodiscard]] JsonValue FromMsgPack(std::string_view data);
+
+// 在MessagePack字节流上产生SAX事件，str负载直接以指向输入缓冲区的视图交给handler，不做复制
+class MsgPackReader
+{
+  public:
+    /**
+     * @param data The encoded bytes, must outlive the reader and the views handed to the handler.
+     * @param raw_binary If true bin payloads are passed to SaxHandler::String as views of the raw bytes, otherwise
+     * they are converted to base64url strings.
+     */
+    explicit MsgPackReader(const std::string_view data, const bool raw_binary = false) noexcept
+        : data_(data), raw_binary_(raw_binary)
+    {
+    }
+
+    /**
+     * @brief Emits the events of the object, the input must contain exactly one object.
+     *
+     * @param handler Receives the events.
+     * @return Returns true if the object was read completely, false on malformed data or when the handler stopped.
+     */
+    bool Parse(SaxHandler &handler);
+
+    [[nodiscard]] bool HasError() const noexcept
+    {
+        return !error_.empty();
+    }
+
+    /**
+     * @brief Throws the recorded error as std::runtime_error.
+     */
+    void ThrowError() const;
+
+  private:
+    // 正在读取的数组或map，map按键值对计数
+    struct Frame
+    {
+        bool is_map_;
+        uint32_t remaining_;
+        size_t count_;
+    };
+
+    std::string_view data_;
+    bool raw_binary_;
+    size_t pos_ = 0;
+    std::string error_;
+    std::vector<Frame> frames_;
+    std::string scratch_; // bin负载转换为base64url时使用
+
+    bool Fail(const std::string &err_desc);
+    bool Abort(const SaxHandler &handler);
+    bool ReadUint(size_t size, uint64_t &value);
+    bool ReadPayload(uint64_t length, std::string_view &value);
+    bool ReadKey(SaxHandler &handler);
+    bool ReadItem(SaxHandler &handler, bool &container);
+    void CompleteMember() noexcept;
+};
+} // namespace simple_json
+
+#endif // MSGPACK_H
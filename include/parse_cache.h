@@ -0,0 +1,117 @@
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include "json.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+// ParseCache的计数器，所有分片的合计
+struct ParseCacheStats
+{
+    uint64_t hits_{0};      // 直接返回已缓存文档的次数
+    uint64_t misses_{0};    // 需要解析的次数，包括解析失败和文档大到无法缓存的情况
+    uint64_t evictions_{0}; // 因超出容量被淘汰的文档个数
+    size_t entries_{0};     // 当前缓存的文档个数
+    size_t bytes_{0};       // 当前缓存占用的内存，按MemoryUsage估算
+};
+
+/**
+ * @brief A cache in front of Json::FromString for inputs that repeat. Documents are looked up by a 128-bit
+ * MurmurHash3 of the input bytes. A hit returns the same shared immutable document, and the stored input is compared
+ * before it is returned, so a hash collision is parsed as a miss instead of returning the wrong document.
+ *
+ * The cache is split into shards chosen by the hash, each with its own lock, LRU list and an equal share of the
+ * capacity. A shard evicts its least recently used documents once their memory footprint, the document's
+ * MemoryUsage plus the stored input, exceeds its share. Parsing happens outside the lock, so a slow miss does not
+ * block lookups of other documents in the same shard.
+ */
+class ParseCache
+{
+  public:
+    /**
+     * @param capacity_bytes Memory budget of all cached documents together.
+     * @param shard_count Number of independently locked shards, at least 1.
+     */
+    explicit ParseCache(size_t capacity_bytes, size_t shard_count = 16);
+    ~ParseCache() = default;
+
+    ParseCache(const ParseCache &) = delete;
+    ParseCache(ParseCache &&) = delete;
+    ParseCache &operator=(const ParseCache &) = delete;
+    ParseCache &operator=(ParseCache &&) = delete;
+
+    /**
+     * @brief Returns the cached document for this input, or parses and caches it. Safe to call from several threads.
+     *
+     * @param json_str The document, the top level must be an object or an array.
+     * @return The shared document, it stays valid after being evicted for as long as the caller holds it.
+     * @throws std::runtime_error like Json::FromString if the document is invalid, invalid inputs are not cached.
+     */
+    [[nodiscard]] std::shared_ptr<const Json> Parse(std::string_view json_str);
+
+    [[nodiscard]] ParseCacheStats Stats() const;
+
+    /**
+     * @brief Drops every cached document, the counters are kept.
+     */
+    void Clear();
+
+  private:
+    struct Key
+    {
+        uint64_t low_;
+        uint64_t high_;
+
+        bool operator==(const Key &other) const noexcept
+        {
+            return low_ == other.low_ && high_ == other.high_;
+        }
+    };
+
+    // 键本身就是均匀分布的哈希值，直接取一半
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const noexcept
+        {
+            return static_cast<size_t>(key.low_);
+        }
+    };
+
+    struct Entry
+    {
+        Key key_;
+        std::string source_; // 原始输入，命中时比较，排除哈希碰撞
+        std::shared_ptr<const Json> json_;
+        size_t bytes_; // 计入容量的内存
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex_;
+        std::list<Entry> lru_; // 前端是最近使用的文档
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+        size_t bytes_{0};
+        uint64_t hits_{0};
+        uint64_t misses_{0};
+        uint64_t evictions_{0};
+    };
+
+    size_t shard_capacity_; // 每个分片的容量
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // 在分片中放入一个新解析的文档并按容量淘汰，返回最终被缓存的那一份
+    std::shared_ptr<const Json> Insert(Shard &shard, Entry &&entry);
+};
+} // namespace simple_json
+
+#endif // PARSE_CACHE_H
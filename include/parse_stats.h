@@ -0,0 +1,104 @@
+#ifndef PARSE_STATS_H
+#define PARSE_STATS_H
+
+#include "config.h"
+#include "lexer_parser.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace simple_json
+{
+constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::EOF_) + 1; // TokenType的取值个数
+
+/**
+ * @brief Counters collected while a document goes through Lexer and Parser. Only recorded when the library is built
+ * with PARSE_STATS, otherwise every counter stays zero and the parser contains no statistics code at all.
+ *
+ * Allocations are not intercepted, they are estimated at the parser's own allocation sites from the growth of the
+ * token stream, line index, token strings, strings copied into the tree and the containers it builds.
+ */
+struct ParseStats
+{
+    uint64_t documents_{0};                           // 合并进来的解析次数，单次解析完成后为1
+    uint64_t bytes_{0};                               // 词法分析读入的字节数
+    std::array<uint64_t, TOKEN_TYPE_COUNT> tokens_{}; // 各类token的个数，下标为TokenType
+    uint64_t max_depth_{0};                           // 最大嵌套层数
+    uint64_t strings_{0};                             // 解码的字符串个数，包括对象的键
+    uint64_t escapes_{0};                             // 字符串中的转义序列个数，包括\uXXXX
+    uint64_t numbers_{0};                             // 数字转换次数
+    uint64_t allocations_{0};                         // 估算的内存分配次数
+    uint64_t allocated_bytes_{0};                     // 估算的分配字节数
+    uint64_t lex_ns_{0};                              // Lexer::Scan耗时，纳秒
+    uint64_t parse_ns_{0};                            // Parser::Parse耗时，纳秒
+
+    [[nodiscard]] uint64_t Tokens(const TokenType type) const noexcept
+    {
+        return tokens_[static_cast<size_t>(type)];
+    }
+
+    /**
+     * @brief Merges the counters of another parse or another thread: max_depth_ keeps the maximum, everything else is
+     * summed.
+     */
+    ParseStats &operator+=(const ParseStats &other) noexcept;
+};
+
+/**
+ * @brief The statistics of the most recent document lexed on the calling thread. They are cleared when the lexer
+ * starts the next document and complete once the parser has finished it.
+ */
+[[nodiscard]] const ParseStats &LastParseStats() noexcept;
+
+/**
+ * @brief The sum of every document the parser has finished on any thread since the start or the last reset.
+ */
+[[nodiscard]] ParseStats TotalParseStats();
+
+/**
+ * @brief Clears the totals returned by TotalParseStats.
+ */
+void ResetTotalParseStats();
+
+#if PARSE_STATS
+// 以下供Lexer和Parser记录统计，PARSE_STATS关闭时不参与编译
+ParseStats &CurrentParseStats() noexcept; // 当前线程正在解析的文档的统计
+void BeginParseStats() noexcept;          // 开始一个新文档，清空当前线程的统计
+void FinishParseStats() noexcept;         // 当前文档解析完毕，并入全局累计值
+
+void NoteAllocation(size_t bytes) noexcept; // 记录一次分配
+void NoteStringCopy(size_t length) noexcept; // 复制一个字符串，超出短字符串缓冲区时分配一次
+// 按几何扩容估算容器从old_capacity增长到new_capacity经历的分配
+void NoteGrowth(size_t old_capacity, size_t new_capacity, size_t element_size) noexcept;
+
+// 把作用域内经过的时间累加到当前线程统计的某个字段上
+class StatsTimer
+{
+  public:
+    explicit StatsTimer(uint64_t ParseStats::*elapsed_ns) noexcept
+        : elapsed_ns_(elapsed_ns), begin_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~StatsTimer()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - begin_;
+        CurrentParseStats().*elapsed_ns_ +=
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    StatsTimer(const StatsTimer &) = delete;
+    StatsTimer(StatsTimer &&) = delete;
+    StatsTimer &operator=(const StatsTimer &) = delete;
+    StatsTimer &operator=(StatsTimer &&) = delete;
+
+  private:
+    uint64_t ParseStats::*elapsed_ns_;
+    std::chrono::steady_clock::time_point begin_;
+};
+#endif
+} // namespace simple_json
+
+#endif // PARSE_STATS_H
@@ -0,0 +1,206 @@
+#ifndef PERSISTENT_JSON_H
+#define PERSISTENT_JSON_H
+
+#include "config.h"
+#include "json_pointer.h"
+#include "json_type.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace simple_json
+{
+/**
+ * @brief An immutable json value whose containers are shared between versions. Copying a value is O(1). Every update
+ * returns a new version and leaves the old one untouched; the two share every subtree the update did not go through.
+ * Objects are hash array mapped tries and arrays are 32-way tries, so an update copies O(log32 n) small nodes per
+ * level of nesting instead of the whole tree.
+ *
+ * Nodes never change after construction and are reference counted with std::shared_ptr, so any number of threads can
+ * read the same version, or versions sharing nodes, without locks. Like std::shared_ptr, one PersistentJson variable
+ * must not be assigned while another thread reads it; hand each thread its own copy.
+ */
+class PersistentJson
+{
+  public:
+    PersistentJson() noexcept = default; // null
+
+    /**
+     * @brief Creates a scalar: an integral type gives Int, a floating point type Float, and a string, bool or nullptr
+     * the matching type.
+     */
+    template <typename T,
+              typename = std::enable_if_t<std::is_arithmetic_v<std::decay_t<T>> ||
+                                          std::is_same_v<std::decay_t<T>, std::nullptr_t> ||
+                                          std::is_constructible_v<std::string, T>>>
+    PersistentJson(T &&val)
+    {
+        if constexpr (std::is_same_v<std::decay_t<T>, bool>)
+        {
+            type_ = JsonType::Bool;
+            value_ = static_cast<bool>(val);
+        }
+        else if constexpr (std::is_same_v<std::decay_t<T>, std::nullptr_t>)
+        {
+            type_ = JsonType::Null;
+        }
+        else if constexpr (std::is_integral_v<std::decay_t<T>>)
+        {
+            type_ = JsonType::Int;
+            value_ = static_cast<long long>(val);
+        }
+        else if constexpr (std::is_floating_point_v<std::decay_t<T>>)
+        {
+            type_ = JsonType::Float;
+            value_ = static_cast<long double>(val);
+        }
+        else
+        {
+            type_ = JsonType::String;
+            value_ = std::make_shared<const std::string>(std::forward<T>(val));
+        }
+    }
+
+    /**
+     * @brief Converts a whole JsonValue tree, building each container bottom-up in linear time.
+     */
+    explicit PersistentJson(const JsonValue &value);
+
+    /**
+     * @brief Creates an empty object or array to build on with Set and PushBack.
+     */
+    [[nodiscard]] static PersistentJson MakeObj() noexcept;
+    [[nodiscard]] static PersistentJson MakeArr() noexcept;
+
+    [[nodiscard]] JsonType GetType() const noexcept
+    {
+        return type_;
+    }
+
+    /**
+     * @brief Reads a scalar, the type must match exactly.
+     *
+     * @throws std::runtime_error on a type mismatch.
+     */
+    [[nodiscard]] long long GetInt() const;
+    [[nodiscard]] long double GetFloat() const;
+    [[nodiscard]] bool GetBool() const;
+    [[nodiscard]] const std::string &GetString() const;
+
+    /**
+     * @brief Number of elements or members, 0 for scalars.
+     */
+    [[nodiscard]] size_t Size() const noexcept;
+
+    /**
+     * @brief Gets an array element in O(log32 n).
+     *
+     * @throws std::invalid_argument if the value is not an array, std::out_of_range if index is too large.
+     */
+    [[nodiscard]] const PersistentJson &operator[](size_t index) const;
+
+    /**
+     * @brief Gets an object member in O(log32 n).
+     *
+     * @throws std::invalid_argument if the value is not an object or has no such key.
+     */
+    [[nodiscard]] const PersistentJson &operator[](std::string_view key) const;
+
+    /**
+     * @brief Looks up an object member.
+     *
+     * @return Pointer to the member, nullptr if the value is not an object or has no such key. It stays valid as long
+     * as this version or any version sharing the member is alive.
+     */
+    [[nodiscard]] const PersistentJson *Find(std::string_view key) const noexcept;
+
+    /**
+     * @brief Follows a JSON Pointer from this value.
+     *
+     * @return Pointer to the referenced value, nullptr if any segment is missing.
+     */
+    [[nodiscard]] const PersistentJson *Resolve(const JsonPointer &pointer) const noexcept;
+
+    /**
+     * @brief Returns a version of this object with key set to value, added if missing.
+     *
+     * @throws std::invalid_argument if the value is not an object.
+     */
+    [[nodiscard]] PersistentJson Set(std::string_view key, PersistentJson value) const;
+
+    /**
+     * @brief Returns a version of this object without key, or this version if there is no such key.
+     *
+     * @throws std::invalid_argument if the value is not an object.
+     */
+    [[nodiscard]] PersistentJson Erase(std::string_view key) const;
+
+    /**
+     * @brief Returns a version of this array with the element at index replaced.
+     *
+     * @throws std::invalid_argument if the value is not an array, std::out_of_range if index is too large.
+     */
+    [[nodiscard]] PersistentJson Set(size_t index, PersistentJson value) const;
+
+    /**
+     * @brief Returns a version of this array with value appended, or with the last element removed.
+     *
+     * @throws std::invalid_argument if the value is not an array, std::out_of_range when popping an empty array.
+     */
+    [[nodiscard]] PersistentJson PushBack(PersistentJson value) const;
+    [[nodiscard]] PersistentJson PopBack() const;
+
+    /**
+     * @brief Returns a version with the value at pointer replaced, copying only the containers along the path. The
+     * last segment may also name a new object member, or "-" or the size of an array to append.
+     *
+     * @throws std::invalid_argument if a segment before the last does not exist.
+     */
+    [[nodiscard]] PersistentJson SetIn(const JsonPointer &pointer, PersistentJson value) const;
+
+    /**
+     * @brief Visits the members of an object in an unspecified but stable order, does nothing for other types.
+     */
+    void ForEachMember(const std::function<void(const std::string &, const PersistentJson &)> &visit) const;
+
+    /**
+     * @brief Visits the elements of an array in order, does nothing for other types.
+     */
+    void ForEachElement(const std::function<void(const PersistentJson &)> &visit) const;
+
+    /**
+     * @brief Whether both values refer to the same node, i.e. one was derived from the other and this subtree was not
+     * updated in between. Always false for scalars. Equal content does not imply shared storage.
+     */
+    [[nodiscard]] bool SharesWith(const PersistentJson &other) const noexcept;
+
+    /**
+     * @brief Copies the subtree into a mutable JsonValue.
+     */
+    [[nodiscard]] JsonValue ToValue() const;
+
+  private:
+    struct ObjectData; // 哈希数组映射前缀树(HAMT)的根
+    struct ArrayData;  // 32叉前缀树的根
+
+    JsonType type_ = JsonType::Null;
+    std::variant<std::nullptr_t, bool, long long, long double, std::shared_ptr<const std::string>,
+                 std::shared_ptr<const ObjectData>, std::shared_ptr<const ArrayData>>
+        value_;
+
+    explicit PersistentJson(std::shared_ptr<const ObjectData> object) noexcept;
+    explicit PersistentJson(std::shared_ptr<const ArrayData> array) noexcept;
+
+    [[nodiscard]] const ObjectData &Object() const;
+    [[nodiscard]] const ArrayData &Array() const;
+    [[nodiscard]] PersistentJson SetIn(const JsonPointer &pointer, size_t depth, PersistentJson &&value) const;
+};
+} // namespace simple_json
+
+#endif // PERSISTENT_JSON_H
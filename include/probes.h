@@ -0,0 +1,57 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#include "config.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if USDT_PROBES
+#if !__has_include(<sys/sdt.h>)
+#error "USDT_PROBES needs <sys/sdt.h>, install systemtap-sdt-dev or systemtap-sdt-devel"
+#endif
+
+// 使用信号量，只有tracer附加到探针上时才计算需要读时钟的参数
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+// sys/sdt.h按"提供者_探针名_semaphore"引用信号量，tracer附加时把它加1，定义见probes.cpp
+extern "C"
+{
+    extern volatile unsigned short simple_json_document_start_semaphore;
+    extern volatile unsigned short simple_json_document_done_semaphore;
+    extern volatile unsigned short simple_json_lex_start_semaphore;
+    extern volatile unsigned short simple_json_lex_done_semaphore;
+    extern volatile unsigned short simple_json_parse_start_semaphore;
+    extern volatile unsigned short simple_json_parse_done_semaphore;
+    extern volatile unsigned short simple_json_error_semaphore;
+    extern volatile unsigned short simple_json_try_parse_start_semaphore;
+    extern volatile unsigned short simple_json_try_parse_done_semaphore;
+    extern volatile unsigned short simple_json_serialize_start_semaphore;
+    extern volatile unsigned short simple_json_serialize_done_semaphore;
+}
+
+/**
+ * @brief Fires the USDT probe simple_json:name, the probes are listed in probes.cpp. Every argument must be an integer
+ * or a pointer. A probe site is a single nop, but its arguments are still computed, so arguments that cost anything
+ * are guarded by SIMPLE_JSON_PROBE_ENABLED.
+ */
+#define SIMPLE_JSON_PROBE(name, ...) STAP_PROBEV(simple_json, name, __VA_ARGS__)
+
+// 有tracer附加到这个探针时为true
+#define SIMPLE_JSON_PROBE_ENABLED(name) (__builtin_expect(simple_json_##name##_semaphore != 0, 0))
+
+// 探针附加时读取时钟作为阶段的开始时间，否则为0，结束探针据此跳过在阶段中途才附加的情况
+#define SIMPLE_JSON_PROBE_CLOCK(name) (SIMPLE_JSON_PROBE_ENABLED(name) ? simple_json::ProbeNow() : 0)
+
+namespace simple_json
+{
+uint64_t ProbeNow() noexcept; // 单调时钟，纳秒
+
+// Lexer开始新文档和Parser完成文档时调用，两者之间的耗时由当前线程记录
+void ProbeDocumentStart(size_t bytes) noexcept;
+void ProbeDocumentDone(size_t bytes, size_t tokens, bool failed) noexcept;
+} // namespace simple_json
+#endif
+
+#endif // PROBES_H
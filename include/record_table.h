@@ -0,0 +1,181 @@
+#ifndef RECORD_TABLE_H
+#define RECORD_TABLE_H
+
+#include "json_type.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+class RecordTableBuilder;
+
+// 列中值的存放方式，Null表示到目前为止全部是null
+enum class ColumnType : uint8_t
+{
+    Null,
+    Int,
+    Float,
+    Bool,
+    String,
+    Value // 类型不一致或者是对象、数组，逐行存放JsonValue
+};
+
+/**
+ * @brief One column of a RecordTable. A column whose values all have the same scalar type keeps them in one contiguous
+ * typed vector, strings are packed into a single buffer, and nulls are tracked on the side. A column whose values
+ * are containers or change type keeps a JsonValue per row.
+ */
+class RecordColumn
+{
+  public:
+    [[nodiscard]] ColumnType GetType() const noexcept
+    {
+        return type_;
+    }
+
+    [[nodiscard]] size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool IsNull(size_t row) const;
+
+    /**
+     * @brief The values of an Int, Float or Bool column, one per row. A null row holds 0 or false, check IsNull if
+     * the column may contain nulls.
+     */
+    [[nodiscard]] const std::vector<long long> &GetInts() const;
+    [[nodiscard]] const std::vector<long double> &GetFloats() const;
+    [[nodiscard]] const std::vector<uint8_t> &GetBools() const;
+
+    /**
+     * @brief The value of a row of a String column, empty for a null row. The view stays valid as long as the table.
+     */
+    [[nodiscard]] std::string_view GetString(size_t row) const;
+
+    /**
+     * @brief The values of a Value column, one per row.
+     */
+    [[nodiscard]] const std::vector<JsonValue> &GetValues() const;
+
+    /**
+     * @brief The value of a row as a JsonValue, whatever the column type.
+     */
+    [[nodiscard]] JsonValue ToValue(size_t row) const;
+
+  private:
+    friend class RecordTable;
+    friend class RecordTableBuilder;
+
+    ColumnType type_{ColumnType::Null};
+    size_t size_{0};
+    std::vector<long long> ints_;
+    std::vector<long double> floats_;
+    std::vector<uint8_t> bools_;
+    std::string chars_;           // String列所有行的内容首尾相接
+    std::vector<size_t> offsets_; // 第i行的内容为chars_[offsets_[i], offsets_[i + 1])
+    std::vector<JsonValue> values_;
+    std::vector<bool> nulls_; // 标量列中每一行是否为null，为空表示没有null
+
+    // 在末尾追加一行
+    void AppendNull();
+    void AppendInt(long long value);
+    void AppendFloat(long double value);
+    void AppendBool(bool value);
+    void AppendString(std::string_view value);
+    void AppendValue(JsonValue &&value); // 对象或数组
+    void Append(const JsonValue &value); // 按值的类型分派
+
+    void CheckRow(size_t row) const;
+    bool Accept(ColumnType type); // 准备以type类型存放下一行，列的类型不能容纳时转为Value列，返回能否直接存放
+    void MarkPresent();           // 记录新的一行不是null
+    void Demote();                // 把已有的行装箱为JsonValue，转为Value列
+    void ShrinkToFit();
+};
+
+/**
+ * @brief An array of objects that all have the same keys, stored column by column: the keys once and one typed
+ * column per key. A record then costs its values only, instead of a hash table with a copy of every key, and a scan
+ * over one column reads a contiguous vector.
+ *
+ * Columns are in the key order of the first record. Later records may list their keys in any order, a record with a
+ * missing, additional or repeated key means the array is not homogeneous.
+ */
+class RecordTable
+{
+  public:
+    /**
+     * @brief Parses a document whose top level is an array of records straight into columns, the records are never
+     * built as objects.
+     *
+     * @param json_str The document.
+     * @return The table, or std::nullopt if the top level is not an array of objects with the same keys; parse such a
+     * document with Json::FromString instead. Reading stops as soon as that is clear, so the rest is not validated.
+     * @throws std::runtime_error like Json::FromString if the document is invalid.
+     */
+    [[nodiscard]] static std::optional<RecordTable> FromString(std::string_view json_str);
+
+    /**
+     * @brief Converts an already parsed array of records.
+     *
+     * @return The table, or std::nullopt if the value is not an array of objects with the same keys.
+     */
+    [[nodiscard]] static std::optional<RecordTable> FromValue(const JsonValue &value);
+
+    [[nodiscard]] size_t RowCount() const noexcept
+    {
+        return rows_;
+    }
+
+    [[nodiscard]] size_t ColumnCount() const noexcept
+    {
+        return keys_.size();
+    }
+
+    [[nodiscard]] const std::vector<std::string> &Keys() const noexcept
+    {
+        return keys_;
+    }
+
+    [[nodiscard]] const RecordColumn &GetColumn(size_t index) const;
+
+    /**
+     * @brief Looks up the column of a key.
+     *
+     * @return The column, nullptr if the records have no such key.
+     */
+    [[nodiscard]] const RecordColumn *Find(std::string_view key) const noexcept;
+
+    /**
+     * @brief Builds one record as an object.
+     */
+    [[nodiscard]] JsonValue Row(size_t row) const;
+
+    /**
+     * @brief Builds the whole array of objects again.
+     */
+    [[nodiscard]] JsonValue ToValue() const;
+
+    /**
+     * @brief The heap memory held by the table, see JsonValue::MemoryUsage.
+     */
+    [[nodiscard]] MemoryFootprint MemoryUsage() const;
+
+  private:
+    friend class RecordTableBuilder;
+
+    std::vector<std::string> keys_;
+    std::vector<RecordColumn> columns_;
+    size_t rows_{0};
+
+    // 键在keys_中的下标，按位置猜中时不需要查找，找不到时返回ColumnCount()
+    [[nodiscard]] size_t ColumnIndex(std::string_view key, size_t guess) const noexcept;
+};
+} // namespace simple_json
+
+#endif // RECORD_TABLE_H
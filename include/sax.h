@@ -0,0 +1,162 @@
+#ifndef SAX_H
+#define SAX_H
+
+#include "config.h"
+#include "json_type.h"
+#include "lexer_parser.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+// SAX风格的事件接口，每个回调返回false时解析立即终止
+class SaxHandler
+{
+  public:
+    SaxHandler() = default;
+    virtual ~SaxHandler() = default;
+
+    SaxHandler(const SaxHandler &) = default;
+    SaxHandler(SaxHandler &&) = default;
+    SaxHandler &operator=(const SaxHandler &) = default;
+    SaxHandler &operator=(SaxHandler &&) = default;
+
+    virtual bool StartObject() = 0;
+    virtual bool Key(std::string_view key) = 0;
+    virtual bool EndObject(size_t member_count) = 0;
+    virtual bool StartArray() = 0;
+    virtual bool EndArray(size_t element_count) = 0;
+    virtual bool String(std::string_view value) = 0;
+    virtual bool Int(long long value) = 0;
+    virtual bool Float(long double value) = 0;
+    virtual bool Bool(bool value) = 0;
+    virtual bool Null() = 0;
+
+    /**
+     * @brief Describes why the handler stopped the parse, used as the error message.
+     *
+     * @return The error description, empty if the handler did not stop the parse.
+     */
+    [[nodiscard]] virtual std::string GetError() const
+    {
+        return {};
+    }
+};
+
+// 根据SAX事件构建JsonValue，使用显式栈，不依赖递归
+class JsonBuilder : public SaxHandler
+{
+  public:
+    bool StartObject() override;
+    bool Key(std::string_view key) override;
+    bool EndObject(size_t member_count) override;
+    bool StartArray() override;
+    bool EndArray(size_t element_count) override;
+    bool String(std::string_view value) override;
+    bool Int(long long value) override;
+    bool Float(long double value) override;
+    bool Bool(bool value) override;
+    bool Null() override;
+
+    /**
+     * @brief Moves the built value out of the builder, the builder can be reused afterwards.
+     *
+     * @return The root value of the last completed document.
+     */
+    [[nodiscard]] JsonValue TakeValue() noexcept;
+
+  private:
+    JsonValue root_;
+    std::vector<JsonValue> stack_;  // 正在构建的容器
+    std::vector<std::string> keys_; // 每一层对象中等待赋值的键
+
+    void AddValue(JsonValue &&value);
+};
+
+// 把多个handler串联起来，任意一个handler返回false都会终止解析
+class SaxTee : public SaxHandler
+{
+  public:
+    SaxTee(SaxHandler &first, SaxHandler &second) noexcept : first_(first), second_(second)
+    {
+    }
+
+    bool StartObject() override;
+    bool Key(std::string_view key) override;
+    bool EndObject(size_t member_count) override;
+    bool StartArray() override;
+    bool EndArray(size_t element_count) override;
+    bool String(std::string_view value) override;
+    bool Int(long long value) override;
+    bool Float(long double value) override;
+    bool Bool(bool value) override;
+    bool Null() override;
+    [[nodiscard]] std::string GetError() const override;
+
+  private:
+    SaxHandler &first_;
+    SaxHandler &second_;
+};
+
+// 在词法分析器的token流上产生SAX事件，语法错误与Parser的错误信息一致，遇到第一个错误即停止
+class SaxReader
+{
+  public:
+    explicit SaxReader(const JsonData &json_data) noexcept : reader_(json_data)
+    {
+    }
+    ~SaxReader() = default;
+
+    SaxReader(const SaxReader &) = delete;
+    SaxReader(SaxReader &&) = delete;
+    SaxReader &operator=(const SaxReader &) = delete;
+    SaxReader &operator=(SaxReader &&) = delete;
+
+    /**
+     * @brief Emits the events of a whole document, the top level must be an object or an array.
+     *
+     * @param handler Receives the events.
+     * @return Returns true if the document was read completely, false on a syntax error or when the handler stopped.
+     */
+    bool Parse(SaxHandler &handler);
+
+    /**
+     * @brief Emits the events of the value starting at the current token, leaving the cursor on its last token.
+     *
+     * @param handler Receives the events.
+     * @return Returns true if the value was read completely, false on a syntax error or when the handler stopped.
+     */
+    bool ParseValue(SaxHandler &handler);
+
+    /**
+     * @brief The underlying token cursor, useful to position the reader before ParseValue.
+     */
+    [[nodiscard]] TokenReader &Reader() noexcept
+    {
+        return reader_;
+    }
+
+    [[nodiscard]] bool HasError() const noexcept;
+
+    /**
+     * @brief Throws the recorded error in the same format as the parser.
+     */
+    void ThrowError() const;
+
+  private:
+    TokenReader reader_;
+    ErrReporter err_reporter_;
+    std::vector<bool> containers_; // 容器栈，true表示对象，false表示数组
+    std::vector<size_t> counts_;   // 每层容器中已经读到的成员个数
+
+    bool Fail(std::string err_desc, const Token *token, size_t highlight_pos = 0, size_t highlight_len = 0);
+    bool Abort(const SaxHandler &handler, const Token *token);
+    bool ReadKey(SaxHandler &handler);
+    bool EmitScalar(SaxHandler &handler, const Token *token);
+};
+} // namespace simple_json
+
+#endif // SAX_H
@@ -0,0 +1,161 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "json_pointer.h"
+#include "json_type.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace simple_json
+{
+/**
+ * @brief Serializes a document into the snapshot format: a versioned header with a checksum followed by 8 byte
+ * aligned blocks that refer to each other by file offset. Every object stores its members sorted by key, so a lookup
+ * is a binary search over the mapped file. Floats are stored as double and the byte order is the writer's.
+ *
+ * @param value The document to serialize.
+ * @return The snapshot bytes.
+ * @throws std::invalid_argument if a string or key is 4 GiB or longer.
+ */
+[[nodiscard]] std::string BuildSnapshot(const JsonValue &value);
+
+/**
+ * @brief Writes BuildSnapshot(value) to a file.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void SaveSnapshot(const JsonValue &value, const std::filesystem::path &file_path);
+
+class JsonSnapshot;
+
+// 快照中的一个值，只保存所在缓冲区的地址和值的位置，复制的开销很小；所属的JsonSnapshot必须比它存活得更久
+class SnapshotView
+{
+  public:
+    [[nodiscard]] JsonType GetType() const noexcept
+    {
+        return type_;
+    }
+
+    /**
+     * @brief Reads a scalar, the type must match exactly.
+     *
+     * @throws std::runtime_error on a type mismatch.
+     */
+    [[nodiscard]] long long GetInt() const;
+    [[nodiscard]] long double GetFloat() const;
+    [[nodiscard]] bool GetBool() const;
+
+    /**
+     * @brief The string's bytes inside the snapshot, valid as long as the snapshot.
+     *
+     * @throws std::runtime_error if the value is not a string.
+     */
+    [[nodiscard]] std::string_view GetString() const;
+
+    /**
+     * @brief Number of elements or members, 0 for scalars.
+     */
+    [[nodiscard]] size_t Size() const noexcept;
+
+    /**
+     * @brief Gets an array element.
+     *
+     * @throws std::invalid_argument if the value is not an array, std::out_of_range if index is too large.
+     */
+    [[nodiscard]] SnapshotView operator[](size_t index) const;
+
+    /**
+     * @brief Gets an object member by binary search over the sorted key table.
+     *
+     * @throws std::invalid_argument if the value is not an object or has no such key.
+     */
+    [[nodiscard]] SnapshotView operator[](std::string_view key) const;
+
+    /**
+     * @brief Looks up an object member.
+     *
+     * @return The member, std::nullopt if the value is not an object or has no such key.
+     */
+    [[nodiscard]] std::optional<SnapshotView> Find(std::string_view key) const noexcept;
+
+    /**
+     * @brief The i-th member of an object in key order, for iteration.
+     */
+    [[nodiscard]] std::string_view KeyAt(size_t index) const;
+    [[nodiscard]] SnapshotView ValueAt(size_t index) const;
+
+    /**
+     * @brief Follows a JSON Pointer from this value.
+     *
+     * @return The referenced value, std::nullopt if any segment is missing.
+     */
+    [[nodiscard]] std::optional<SnapshotView> Resolve(const JsonPointer &pointer) const noexcept;
+
+    /**
+     * @brief Copies the subtree into a JsonValue.
+     */
+    [[nodiscard]] JsonValue ToValue() const;
+
+  private:
+    friend class JsonSnapshot;
+
+    const char *base_;  // 快照缓冲区的起始地址
+    JsonType type_;
+    uint32_t aux_;      // 字符串的长度
+    uint64_t payload_;  // 标量的值，或者字符串、容器所在的偏移
+
+    SnapshotView(const char *base, uint64_t slot_offset) noexcept;
+    [[nodiscard]] uint64_t ObjectEntry(size_t index) const noexcept;
+};
+
+/**
+ * @brief A snapshot file mapped into memory and queried in place, nothing is deserialized when opening it. The pages
+ * come from the page cache, so processes that open the same file share them.
+ */
+class JsonSnapshot
+{
+  public:
+    JsonSnapshot(const JsonSnapshot &) = delete;
+    JsonSnapshot &operator=(const JsonSnapshot &) = delete;
+    JsonSnapshot(JsonSnapshot &&other) noexcept;
+    JsonSnapshot &operator=(JsonSnapshot &&other) noexcept;
+    ~JsonSnapshot();
+
+    /**
+     * @brief Maps a snapshot file read-only.
+     *
+     * @param file_path The snapshot file.
+     * @param verify_checksum Whether to hash the whole file once. Without it only the header, version and size are
+     * checked, which is instant but trusts the offsets inside the file.
+     * @throws std::runtime_error if the file cannot be opened, or is not a snapshot of this version, or is damaged.
+     */
+    [[nodiscard]] static JsonSnapshot Open(const std::filesystem::path &file_path, bool verify_checksum = true);
+
+    /**
+     * @brief Uses a snapshot already held in memory, e.g. the result of BuildSnapshot.
+     *
+     * @throws std::runtime_error if the buffer is not a valid snapshot.
+     */
+    [[nodiscard]] static JsonSnapshot FromBuffer(std::string buffer, bool verify_checksum = true);
+
+    [[nodiscard]] SnapshotView Root() const noexcept;
+
+  private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    void *mapping_ = nullptr; // mmap得到的地址，为空时数据保存在buffer_中
+    std::string buffer_;
+
+    JsonSnapshot() = default;
+    void Unmap() noexcept;
+    void Validate(bool verify_checksum) const;
+};
+} // namespace simple_json
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,1253 @@
+#ifndef STATIC_JSON_H
+#define STATIC_JSON_H
+
+#include "config.h"
+#include "json_type.h"
+#include "lexer_dfa.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+// 编译期json解析: 嵌入在代码中的json字面量在编译期完成校验，并生成只读的静态文档
+// 用法: static constexpr auto CONFIG = STATIC_JSON(R"({"port": 8080})");
+//       static_assert(CONFIG["port"].GetInt() == 8080);
+namespace simple_json
+{
+#ifndef STATIC_JSON_MAX_DEPTH
+#define STATIC_JSON_MAX_DEPTH 64 // 编译期解析允许的最大嵌套层数，受编译器constexpr递归深度限制
+#endif
+
+// 静态文档中的一个节点，所有节点按先序排列，对象的每个成员由一个键节点和紧随其后的值子树组成
+struct StaticNode
+{
+    JsonType type_{JsonType::Null};
+    size_t begin_{0};  // 字符串在字符池中的起始位置
+    size_t length_{0}; // 字符串长度，或者容器的成员个数
+    size_t end_{0};    // 子树结束位置，即下一个兄弟节点的下标
+    long long int_{0};
+    long double float_{0};
+    bool bool_{false};
+};
+
+// 静态文档中某个节点的只读视图，找不到对应的键或下标时返回无效视图，而不是抛异常
+class StaticJsonView
+{
+  public:
+    constexpr StaticJsonView() noexcept = default;
+    constexpr StaticJsonView(const StaticNode *nodes, const char *chars, const size_t index) noexcept
+        : nodes_(nodes), chars_(chars), index_(index)
+    {
+    }
+
+    /**
+     * @brief Checks if the view refers to an existing node, lookups of missing keys or indexes return invalid views.
+     */
+    [[nodiscard]] constexpr bool IsValid() const noexcept
+    {
+        return nodes_ != nullptr;
+    }
+
+    /**
+     * @brief Gets the json type of the node, an invalid view reports JsonType::Null.
+     */
+    [[nodiscard]] constexpr JsonType GetType() const noexcept
+    {
+        return IsValid() ? Node().type_ : JsonType::Null;
+    }
+
+    /**
+     * @brief Gets the number of members of an object or elements of an array, 0 for other types.
+     */
+    [[nodiscard]] constexpr size_t Size() const noexcept
+    {
+        const JsonType type = GetType();
+        return type == JsonType::Object || type == JsonType::Array ? Node().length_ : 0;
+    }
+
+    [[nodiscard]] constexpr std::string_view GetString() const noexcept
+    {
+        return GetType() == JsonType::String ? std::string_view(chars_ + Node().begin_, Node().length_)
+                                             : std::string_view();
+    }
+
+    [[nodiscard]] constexpr long long GetInt() const noexcept
+    {
+        return GetType() == JsonType::Int ? Node().int_ : 0;
+    }
+
+    /**
+     * @brief Gets the value of a float node, integer nodes are converted.
+     */
+    [[nodiscard]] constexpr long double GetFloat() const noexcept
+    {
+        if (GetType() == JsonType::Int)
+        {
+            return static_cast<long double>(Node().int_);
+        }
+        return GetType() == JsonType::Float ? Node().float_ : 0;
+    }
+
+    [[nodiscard]] constexpr bool GetBool() const noexcept
+    {
+        return GetType() == JsonType::Bool && Node().bool_;
+    }
+
+    /**
+     * @brief Gets the key of the index-th member of an object.
+     */
+    [[nodiscard]] constexpr std::string_view KeyAt(const size_t index) const noexcept
+    {
+        const size_t key = MemberKey(index);
+        return key == NPOS ? std::string_view() : StaticJsonView(nodes_, chars_, key).GetString();
+    }
+
+    /**
+     * @brief Gets the value of a json object member, duplicate keys resolve to the last one like the runtime parser.
+     *
+     * @return The member value, or an invalid view if the key does not exist.
+     */
+    [[nodiscard]] constexpr StaticJsonView operator[](const std::string_view key) const noexcept
+    {
+        if (GetType() != JsonType::Object)
+        {
+            return {};
+        }
+
+        StaticJsonView found;
+        size_t cur = index_ + 1;
+        for (size_t i = 0; i < Node().length_; ++i)
+        {
+            if (StaticJsonView(nodes_, chars_, cur).GetString() == key)
+            {
+                found = StaticJsonView(nodes_, chars_, cur + 1);
+            }
+            cur = nodes_[cur + 1].end_;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Gets an array element, or the value of the index-th member of an object.
+     *
+     * @return The element, or an invalid view if the index is out of range.
+     */
+    [[nodiscard]] constexpr StaticJsonView operator[](const size_t index) const noexcept
+    {
+        if (GetType() == JsonType::Object)
+        {
+            const size_t key = MemberKey(index);
+            return key == NPOS ? StaticJsonView() : StaticJsonView(nodes_, chars_, key + 1);
+        }
+        if (GetType() != JsonType::Array || index >= Node().length_)
+        {
+            return {};
+        }
+
+        size_t cur = index_ + 1;
+        for (size_t i = 0; i < index; ++i)
+        {
+            cur = nodes_[cur].end_;
+        }
+        return {nodes_, chars_, cur};
+    }
+
+    /**
+     * @brief Materializes the node and its descendants as a runtime JsonValue.
+     */
+    [[nodiscard]] JsonValue ToJsonValue() const;
+
+  private:
+    static constexpr size_t NPOS = std::numeric_limits<size_t>::max();
+
+    const StaticNode *nodes_{nullptr};
+    const char *chars_{nullptr};
+    size_t index_{0};
+
+    [[nodiscard]] constexpr const StaticNode &Node() const noexcept
+    {
+        return nodes_[index_];
+    }
+
+    [[nodiscard]] constexpr size_t MemberKey(const size_t index) const noexcept
+    {
+        if (GetType() != JsonType::Object || index >= Node().length_)
+        {
+            return NPOS;
+        }
+
+        size_t cur = index_ + 1;
+        for (size_t i = 0; i < index; ++i)
+        {
+            cur = nodes_[cur + 1].end_;
+        }
+        return cur;
+    }
+};
+
+// 编译期解析结果，出错时记录第一个错误的描述和字节偏移
+struct StaticParseResult
+{
+    bool ok_{false};
+    size_t nodes_{0};          // 需要的节点数量
+    size_t chars_{0};          // 需要的字符池大小
+    const char *err_desc_{""}; // 错误描述
+    size_t err_offset_{0};     // 错误在原始字符串中的字节偏移
+};
+
+namespace static_detail
+{
+// 只统计节点和字符数量，用于确定StaticJson的模板参数
+class CountingSink
+{
+  public:
+    constexpr size_t AddNode(const JsonType /*type*/) noexcept
+    {
+        return nodes_++;
+    }
+    constexpr void PushChar(const char /*ch*/) noexcept
+    {
+        ++chars_;
+    }
+    constexpr size_t CharCount() const noexcept
+    {
+        return chars_;
+    }
+    constexpr size_t NodeCount() const noexcept
+    {
+        return nodes_;
+    }
+    constexpr void SetString(size_t /*node*/, size_t /*begin*/) noexcept
+    {
+    }
+    constexpr void SetLength(size_t /*node*/, size_t /*length*/) noexcept
+    {
+    }
+    constexpr void SetEnd(size_t /*node*/) noexcept
+    {
+    }
+    constexpr void SetInt(size_t /*node*/, long long /*value*/) noexcept
+    {
+    }
+    constexpr void SetFloat(size_t /*node*/, long double /*value*/) noexcept
+    {
+    }
+    constexpr void SetBool(size_t /*node*/, bool /*value*/) noexcept
+    {
+    }
+
+  private:
+    size_t nodes_{0};
+    size_t chars_{0};
+};
+
+// 把解析结果写入StaticJson的节点数组和字符池
+template <size_t NodeCapacity, size_t CharCapacity> class StorageSink
+{
+  public:
+    constexpr StorageSink(std::array<StaticNode, NodeCapacity> &nodes, std::array<char, CharCapacity> &chars) noexcept
+        : nodes_(nodes), chars_(chars)
+    {
+    }
+
+    // 模板参数由STATIC_JSON宏精确计算，这里的边界检查只防止手动实例化时容量不足
+    constexpr size_t AddNode(const JsonType type) noexcept
+    {
+        if (node_count_ < NodeCapacity)
+        {
+            nodes_[node_count_].type_ = type;
+        }
+        return node_count_++;
+    }
+    constexpr void PushChar(const char ch) noexcept
+    {
+        if (char_count_ < CharCapacity)
+        {
+            chars_[char_count_] = ch;
+        }
+        ++char_count_;
+    }
+    constexpr size_t CharCount() const noexcept
+    {
+        return char_count_;
+    }
+    constexpr size_t NodeCount() const noexcept
+    {
+        return node_count_;
+    }
+    constexpr void SetString(const size_t node, const size_t begin) noexcept
+    {
+        if (node < NodeCapacity)
+        {
+            nodes_[node].begin_ = begin;
+            nodes_[node].length_ = char_count_ - begin;
+        }
+    }
+    constexpr void SetLength(const size_t node, const size_t length) noexcept
+    {
+        if (node < NodeCapacity)
+        {
+            nodes_[node].length_ = length;
+        }
+    }
+    constexpr void SetEnd(const size_t node) noexcept
+    {
+        if (node < NodeCapacity)
+        {
+            nodes_[node].end_ = node_count_;
+        }
+    }
+    constexpr void SetInt(const size_t node, const long long value) noexcept
+    {
+        if (node < NodeCapacity)
+        {
+            nodes_[node].int_ = value;
+        }
+    }
+    constexpr void SetFloat(const size_t node, const long double value) noexcept
+    {
+        if (node < NodeCapacity)
+        {
+            nodes_[node].float_ = value;
+        }
+    }
+    constexpr void SetBool(const size_t node, const bool value) noexcept
+    {
+        if (node < NodeCapacity)
+        {
+            nodes_[node].bool_ = value;
+        }
+    }
+
+  private:
+    std::array<StaticNode, NodeCapacity> &nodes_;
+    std::array<char, CharCapacity> &chars_;
+    size_t node_count_{0};
+    size_t char_count_{0};
+};
+
+// 两个相邻long double的中点最多有多少位有效数字，最小的中点为(2m + 1) * 2^(min_exponent - digits - 1)，
+// 十进制表示有(digits + 1) * log10(2) + (digits - min_exponent + 1) * log10(5)位
+constexpr size_t MaxMidpointDigits() noexcept
+{
+    using Limits = std::numeric_limits<long double>;
+    return static_cast<size_t>((Limits::digits + 1) * 30103LL + (Limits::digits - Limits::min_exponent + 1) * 69898LL) /
+               100000 +
+           2;
+}
+
+// 十进制转浮点数时参与精确计算的有效数字个数，之后的数字只记录是否非零；中点都不超过这么多位，截断不会改变舍入的结果
+inline constexpr size_t MAX_DECIMAL_DIGITS = MaxMidpointDigits();
+
+// 十进制数字不超过decimal_digits位的操作数需要的大整数段数，留出求商时移位的余量
+constexpr size_t BigUintCapacity(const size_t decimal_digits) noexcept
+{
+    return (decimal_digits * 3322 / 1000 + std::numeric_limits<long double>::digits + 2) / 32 + 3;
+}
+
+// 上溢之前的分子或者下溢之前最小的数的分母，是最大的操作数
+inline constexpr size_t MAX_OPERAND_DIGITS =
+    std::max<size_t>(std::numeric_limits<long double>::max_exponent10 + 1,
+                     MAX_DECIMAL_DIGITS + 3 +
+                         static_cast<size_t>(std::numeric_limits<long double>::max_digits10 -
+                                             std::numeric_limits<long double>::min_exponent10));
+
+// 编译期十进制转浮点数使用的定长大整数，按32位分段存放，低位在前，最高段不为0
+template <size_t Capacity> class BigUint
+{
+  public:
+    constexpr explicit BigUint(const uint32_t value) noexcept
+    {
+        limbs_[0] = value;
+        size_ = value == 0 ? 0 : 1;
+    }
+
+    // *this = *this * factor + addend
+    constexpr void MulAdd(const uint32_t factor, const uint32_t addend) noexcept
+    {
+        uint64_t carry = addend;
+        for (size_t i = 0; i < size_; ++i)
+        {
+            carry += static_cast<uint64_t>(limbs_[i]) * factor;
+            limbs_[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0)
+        {
+            limbs_[size_++] = static_cast<uint32_t>(carry);
+        }
+    }
+
+    // 10^k = 5^k * 2^k，2^k直接计入二进制指数，大整数只需要乘以5^k
+    constexpr void MulPow5(unsigned long long exponent) noexcept
+    {
+        for (; exponent >= 13; exponent -= 13)
+        {
+            MulAdd(1220703125, 0); // 5^13
+        }
+        uint32_t factor = 1;
+        for (; exponent > 0; --exponent)
+        {
+            factor *= 5;
+        }
+        MulAdd(factor, 0);
+    }
+
+    constexpr void ShiftLeft(const size_t bits) noexcept
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+
+        // 从高位往低位移动，目标位置总是不低于源位置，不会覆盖还没有移动的段
+        const size_t limbs = bits / 32;
+        const size_t rest = bits % 32;
+        limbs_[size_ + limbs] = 0;
+        for (size_t i = size_; i-- > 0;)
+        {
+            const uint64_t shifted = static_cast<uint64_t>(limbs_[i]) << rest;
+            limbs_[i + limbs + 1] |= static_cast<uint32_t>(shifted >> 32);
+            limbs_[i + limbs] = static_cast<uint32_t>(shifted);
+        }
+        for (size_t i = 0; i < limbs; ++i)
+        {
+            limbs_[i] = 0;
+        }
+        size_ += limbs + 1;
+        Trim();
+    }
+
+    // 长除法(Knuth算法D)，商放入quotient，*this变为余数，返回余数是否不为0；divisor不为0，会被规格化
+    constexpr bool DivideBy(BigUint &divisor, BigUint &quotient) noexcept
+    {
+        if (Compare(divisor) < 0)
+        {
+            return !IsZero();
+        }
+
+        // 规格化到除数最高段的最高位为1，此时由最高两段估计的试商最多比真实的商大2
+        const size_t normalize = divisor.size_ * 32 - divisor.BitLength();
+        divisor.ShiftLeft(normalize);
+        ShiftLeft(normalize);
+
+        const size_t n = divisor.size_;
+        const size_t m = size_ - n;
+        const uint64_t divisor_top = divisor.limbs_[n - 1];
+        const uint64_t divisor_next = n >= 2 ? divisor.limbs_[n - 2] : 0;
+        limbs_[size_] = 0;
+        for (size_t j = m + 1; j-- > 0;)
+        {
+            const uint64_t top = (static_cast<uint64_t>(limbs_[j + n]) << 32) | limbs_[j + n - 1];
+            uint64_t guess = top / divisor_top;
+            uint64_t rest = top % divisor_top;
+            while (guess >> 32 != 0 || (n >= 2 && guess * divisor_next > ((rest << 32) | limbs_[j + n - 2])))
+            {
+                --guess;
+                rest += divisor_top;
+                if (rest >> 32 != 0)
+                {
+                    break;
+                }
+            }
+
+            // 减去guess * divisor，减成负数时说明试商大了1，再加回一次
+            uint64_t carry = 0;
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const uint64_t product = guess * divisor.limbs_[i] + carry;
+                carry = product >> 32;
+                const uint64_t diff = static_cast<uint64_t>(limbs_[i + j]) - (product & 0xFFFFFFFF) - borrow;
+                limbs_[i + j] = static_cast<uint32_t>(diff);
+                borrow = diff >> 63;
+            }
+            const uint64_t diff = static_cast<uint64_t>(limbs_[j + n]) - carry - borrow;
+            limbs_[j + n] = static_cast<uint32_t>(diff);
+            if (diff >> 63 != 0)
+            {
+                --guess;
+                carry = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const uint64_t sum = static_cast<uint64_t>(limbs_[i + j]) + divisor.limbs_[i] + carry;
+                    limbs_[i + j] = static_cast<uint32_t>(sum);
+                    carry = sum >> 32;
+                }
+                limbs_[j + n] = static_cast<uint32_t>(limbs_[j + n] + carry);
+            }
+            quotient.limbs_[j] = static_cast<uint32_t>(guess);
+        }
+
+        quotient.size_ = m + 1;
+        quotient.Trim();
+        size_ = n;
+        Trim();
+        return !IsZero();
+    }
+
+    [[nodiscard]] constexpr int Compare(const BigUint &other) const noexcept
+    {
+        if (size_ != other.size_)
+        {
+            return size_ < other.size_ ? -1 : 1;
+        }
+        for (size_t i = size_; i-- > 0;)
+        {
+            if (limbs_[i] != other.limbs_[i])
+            {
+                return limbs_[i] < other.limbs_[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    [[nodiscard]] constexpr size_t BitLength() const noexcept
+    {
+        if (size_ == 0)
+        {
+            return 0;
+        }
+        size_t bits = (size_ - 1) * 32;
+        for (uint32_t top = limbs_[size_ - 1]; top != 0; top >>= 1)
+        {
+            ++bits;
+        }
+        return bits;
+    }
+
+    [[nodiscard]] constexpr bool Bit(const size_t index) const noexcept
+    {
+        return index / 32 < size_ && ((limbs_[index / 32] >> (index % 32)) & 1) != 0;
+    }
+
+    // 低于count的位是否全部为0
+    [[nodiscard]] constexpr bool LowBitsZero(const size_t count) const noexcept
+    {
+        for (size_t i = 0; i < count / 32 && i < size_; ++i)
+        {
+            if (limbs_[i] != 0)
+            {
+                return false;
+            }
+        }
+        const size_t rest = count % 32;
+        return count / 32 >= size_ || rest == 0 || (limbs_[count / 32] & ((uint32_t{1} << rest) - 1)) == 0;
+    }
+
+    [[nodiscard]] constexpr bool IsZero() const noexcept
+    {
+        return size_ == 0;
+    }
+
+  private:
+    uint32_t limbs_[Capacity]{}; // 不使用std::array，编译期求值时每次下标访问少一次函数调用
+    size_t size_{0};
+
+    constexpr void Trim() noexcept
+    {
+        while (size_ > 0 && limbs_[size_ - 1] == 0)
+        {
+            --size_;
+        }
+    }
+};
+
+// value乘以2^exponent，中间结果都在value和最终结果之间，只要最终结果可以精确表示，每一步都是精确的
+constexpr long double ScaleByPowerOfTwo(long double value, long long exponent) noexcept
+{
+    for (; exponent >= 32; exponent -= 32)
+    {
+        value *= 0x1p32L;
+    }
+    for (; exponent <= -32; exponent += 32)
+    {
+        value *= 0x1p-32L;
+    }
+    for (; exponent > 0; --exponent)
+    {
+        value *= 2;
+    }
+    for (; exponent < 0; ++exponent)
+    {
+        value /= 2;
+    }
+    return value;
+}
+
+// 10的幂可以精确表示为long double的最大指数，即5^k < 2^digits的最大k
+constexpr long long ExactPow10Limit() noexcept
+{
+    const long double limit = ScaleByPowerOfTwo(1, std::numeric_limits<long double>::digits);
+    long double pow5 = 1;
+    long long exponent = 0;
+    for (; pow5 * 5 < limit; ++exponent)
+    {
+        pow5 *= 5;
+    }
+    return exponent;
+}
+
+// 把numerator / denominator * 2^binary_exponent舍入为long double，两者都不为0，超出long double的范围时返回false
+template <size_t Capacity>
+constexpr bool DivideToFloat(BigUint<Capacity> &numerator, BigUint<Capacity> &denominator, long long binary_exponent,
+                             long double &value) noexcept
+{
+    using Limits = std::numeric_limits<long double>;
+
+    // 移位使商落在[2^digits, 2^(digits + 2))之间，有效位之外至少还有一位，与余数一起决定舍入
+    const long long shift = Limits::digits + 1 - (static_cast<long long>(numerator.BitLength()) -
+                                                  static_cast<long long>(denominator.BitLength()));
+    if (shift > 0)
+    {
+        numerator.ShiftLeft(static_cast<size_t>(shift));
+    }
+    else
+    {
+        denominator.ShiftLeft(static_cast<size_t>(-shift));
+    }
+    binary_exponent -= shift;
+    BigUint<Capacity> quotient(0);
+    const bool inexact = numerator.DivideBy(denominator, quotient);
+
+    // 最高位和最低有效位的指数，非规格化数的有效位数更少，舍去的位数至少为1
+    const long long top = static_cast<long long>(quotient.BitLength()) - 1 + binary_exponent;
+    if (top >= Limits::max_exponent)
+    {
+        return false;
+    }
+    const long long lowest = std::max<long long>(top, Limits::min_exponent - 1) - (Limits::digits - 1);
+    const auto drop = static_cast<size_t>(lowest - binary_exponent);
+
+    value = 0;
+    for (size_t bit = quotient.BitLength(); bit-- > drop;)
+    {
+        value = value * 2 + (quotient.Bit(bit) ? 1 : 0);
+    }
+    // 就近舍入，正好在中间时取偶数，与strtold一致
+    if (quotient.Bit(drop - 1) && (quotient.Bit(drop) || inexact || !quotient.LowBitsZero(drop - 1)))
+    {
+        value += 1;
+    }
+
+    // 进位到2^digits时指数加1，最大的指数上会因此上溢
+    if (top == Limits::max_exponent - 1 && value == ScaleByPowerOfTwo(1, Limits::digits))
+    {
+        return false;
+    }
+    value = ScaleByPowerOfTwo(value, lowest);
+    return true;
+}
+
+// 用大整数精确计算count位有效数字乘以10^exponent，truncated表示之后还有被丢弃的非零数字
+template <size_t Capacity>
+constexpr bool ExactDecimalToFloat(const std::string_view digits, const size_t count, const bool truncated,
+                                   long long exponent, long double &value) noexcept
+{
+    // 有效数字每9位一组读入分子
+    BigUint<Capacity> numerator(0);
+    size_t read = 0;
+    uint32_t chunk = 0;
+    uint32_t chunk_scale = 1;
+    for (size_t i = 0; i < digits.size() && read < count; ++i)
+    {
+        if (digits[i] == '.' || (read == 0 && digits[i] == '0'))
+        {
+            continue;
+        }
+        chunk = chunk * 10 + static_cast<uint32_t>(digits[i] - '0');
+        chunk_scale *= 10;
+        ++read;
+        if (chunk_scale == 1000000000 || read == count)
+        {
+            numerator.MulAdd(chunk_scale, chunk);
+            chunk = 0;
+            chunk_scale = 1;
+        }
+    }
+    if (truncated)
+    {
+        // 在末尾补一位1代替丢弃的数字，数值仍然落在相同的两个舍入边界之间
+        numerator.MulAdd(10, 1);
+        --exponent;
+    }
+
+    BigUint<Capacity> denominator(1);
+    if (exponent >= 0)
+    {
+        numerator.MulPow5(static_cast<unsigned long long>(exponent));
+    }
+    else
+    {
+        denominator.MulPow5(static_cast<unsigned long long>(-exponent));
+    }
+    return DivideToFloat(numerator, denominator, exponent, value);
+}
+
+// 把十进制数转换为最接近的long double，与strtold的舍入结果相同，超出long double的范围时返回false
+// digits为去掉符号和指数部分的数字，可以带小数点，exponent为指数部分的值
+// 位数很多或者指数很大的数需要较多的编译期求值步骤，上千位的数字可能需要调大-fconstexpr-ops-limit
+constexpr bool DecimalToFloat(const std::string_view digits, long long exponent, long double &value) noexcept
+{
+    using Limits = std::numeric_limits<long double>;
+
+    // 统计有效数字，前导零不算，小数部分的每一位使指数减1
+    size_t count = 0;
+    unsigned long long head = 0; // 前19位有效数字
+    bool truncated = false;      // 丢弃的有效数字中是否有非零数字
+    bool in_fraction = false;
+    for (const char ch : digits)
+    {
+        if (ch == '.')
+        {
+            in_fraction = true;
+            continue;
+        }
+        if (count == MAX_DECIMAL_DIGITS)
+        {
+            truncated = truncated || ch != '0';
+            exponent += in_fraction ? 0 : 1;
+            continue;
+        }
+        if (count == 0 && ch == '0')
+        {
+            exponent -= in_fraction ? 1 : 0;
+            continue;
+        }
+        head = count < 19 ? head * 10 + static_cast<unsigned long long>(ch - '0') : head;
+        ++count;
+        exponent -= in_fraction ? 1 : 0;
+    }
+
+    value = 0;
+    if (count == 0)
+    {
+        return true;
+    }
+
+    // 数值位于[10^(magnitude - 1), 10^magnitude)之间，明显上溢或者下溢的数不需要精确计算
+    const long long magnitude = static_cast<long long>(count) + exponent;
+    if (magnitude - 1 > Limits::max_exponent10)
+    {
+        return false;
+    }
+    if (magnitude < Limits::min_exponent10 - Limits::max_digits10 - 1)
+    {
+        return true;
+    }
+
+    // 有效数字和10的幂都能精确表示时，一次乘法或除法的结果就是正确舍入的
+    constexpr long long EXACT_POW10 = ExactPow10Limit();
+    constexpr auto EXACT_DIGITS = static_cast<size_t>(std::min(19, Limits::digits10));
+    if (!truncated && count <= EXACT_DIGITS && exponent >= -EXACT_POW10 && exponent <= EXACT_POW10)
+    {
+        long double scale = 1;
+        for (long long i = 0; i < (exponent < 0 ? -exponent : exponent); ++i)
+        {
+            scale *= 10;
+        }
+        value = exponent < 0 ? static_cast<long double>(head) / scale : static_cast<long double>(head) * scale;
+        return true;
+    }
+
+    // 其余情况用大整数精确计算，容量按实际的数量级选择，常见的数不需要初始化和遍历最大的容量
+    const size_t operand_digits = count + 2 + static_cast<size_t>(exponent < 0 ? -exponent : exponent);
+    if (operand_digits <= 64)
+    {
+        return ExactDecimalToFloat<BigUintCapacity(64)>(digits, count, truncated, exponent, value);
+    }
+    if (operand_digits <= 400)
+    {
+        return ExactDecimalToFloat<BigUintCapacity(400)>(digits, count, truncated, exponent, value);
+    }
+    return ExactDecimalToFloat<BigUintCapacity(MAX_OPERAND_DIGITS)>(digits, count, truncated, exponent, value);
+}
+
+// 编译期递归下降解析器，直接在字符上运行，复用Lexer的dfa，不生成token流
+template <typename Sink> class StaticParser
+{
+  public:
+    constexpr StaticParser(const std::string_view source, Sink &sink) noexcept : source_(source), sink_(sink)
+    {
+    }
+
+    constexpr StaticParseResult Parse() noexcept
+    {
+        SkipSpace();
+        if (Current() != '{' && Current() != '[')
+        {
+            Fail(ERR_MISMATCH_TOP_LEVEL);
+        }
+        else if (ParseValue())
+        {
+            SkipSpace();
+            if (pos_ != source_.size())
+            {
+                Fail(ERR_TRAILING_CONTENT);
+            }
+        }
+
+        StaticParseResult result;
+        result.ok_ = err_desc_ == nullptr;
+        result.nodes_ = sink_.NodeCount();
+        result.chars_ = sink_.CharCount();
+        result.err_desc_ = err_desc_ == nullptr ? "" : err_desc_;
+        result.err_offset_ = err_offset_;
+        return result;
+    }
+
+  private:
+    std::string_view source_;
+    Sink &sink_;
+    size_t pos_{0};
+    size_t depth_{0};
+    const char *err_desc_{nullptr};
+    size_t err_offset_{0};
+
+    [[nodiscard]] constexpr char Current() const noexcept
+    {
+        return pos_ < source_.size() ? source_[pos_] : '\0';
+    }
+
+    constexpr void SkipSpace() noexcept
+    {
+        while (pos_ < source_.size() && IsJsonSpace(source_[pos_]))
+        {
+            ++pos_;
+        }
+    }
+
+    constexpr bool Fail(const char *err_desc) noexcept
+    {
+        if (err_desc_ == nullptr)
+        {
+            err_desc_ = err_desc;
+            err_offset_ = pos_;
+        }
+        return false;
+    }
+
+    constexpr bool ParseValue() noexcept
+    {
+        switch (Current())
+        {
+        case '{':
+            return ParseObject();
+        case '[':
+            return ParseArray();
+        case '"':
+            return ParseString();
+        case 't':
+        case 'f':
+        case 'n':
+            return ParseLiteral();
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return ParseNumber();
+        case '\0':
+        case ',':
+        case ']':
+        case '}':
+        case ':':
+            return Fail(ERR_EXPECTED_JSON_VALUE_TYPE);
+        default:
+            return Fail(ERR_UNKNOWN_VALUE);
+        }
+    }
+
+    constexpr bool ParseObject() noexcept
+    {
+        if (++depth_ > STATIC_JSON_MAX_DEPTH)
+        {
+            return Fail(ERR_NESTING_TOO_DEEP);
+        }
+
+        const size_t node = sink_.AddNode(JsonType::Object);
+        size_t count = 0;
+        ++pos_; // 跳过{
+        SkipSpace();
+        if (Current() != '}')
+        {
+            while (true)
+            {
+                if (Current() != '"')
+                {
+                    return Fail(ERR_OBJECT_KEY_MUST_BE_STRING);
+                }
+                if (!ParseString())
+                {
+                    return false;
+                }
+
+                SkipSpace();
+                if (Current() != ':')
+                {
+                    return Fail(ERR_COLON_EXPECTED);
+                }
+                ++pos_;
+                SkipSpace();
+                if (!ParseValue())
+                {
+                    return false;
+                }
+                ++count;
+
+                SkipSpace();
+                if (Current() == '}')
+                {
+                    break;
+                }
+                if (Current() != ',')
+                {
+                    return Fail(ERR_COMMA_OR_BRACE_EXPECTED);
+                }
+                ++pos_;
+                SkipSpace();
+                if (Current() == '}')
+                {
+                    if (!ALLOW_TRAILING_COMMA)
+                    {
+                        return Fail(ERR_TRAILING_COMMA);
+                    }
+                    break;
+                }
+            }
+        }
+        ++pos_; // 跳过}
+
+        sink_.SetLength(node, count);
+        sink_.SetEnd(node);
+        --depth_;
+        return true;
+    }
+
+    constexpr bool ParseArray() noexcept
+    {
+        if (++depth_ > STATIC_JSON_MAX_DEPTH)
+        {
+            return Fail(ERR_NESTING_TOO_DEEP);
+        }
+
+        const size_t node = sink_.AddNode(JsonType::Array);
+        size_t count = 0;
+        ++pos_; // 跳过[
+        SkipSpace();
+        if (Current() != ']')
+        {
+            while (true)
+            {
+                if (!ParseValue())
+                {
+                    return false;
+                }
+                ++count;
+
+                SkipSpace();
+                if (Current() == ']')
+                {
+                    break;
+                }
+                if (Current() != ',')
+                {
+                    return Fail(ERR_COMMA_OR_BRACKET_EXPECTED);
+                }
+                ++pos_;
+                SkipSpace();
+                if (Current() == ']')
+                {
+                    if (!ALLOW_TRAILING_COMMA)
+                    {
+                        return Fail(ERR_TRAILING_COMMA);
+                    }
+                    break;
+                }
+            }
+        }
+        ++pos_; // 跳过]
+
+        sink_.SetLength(node, count);
+        sink_.SetEnd(node);
+        --depth_;
+        return true;
+    }
+
+    constexpr void PushCodepoint(const unsigned long codepoint) noexcept
+    {
+        // 与运行期的EncodeUtf8保持一致，\u转义最多只有4位十六进制，所以最多3个字节
+        if (codepoint <= 0x7F)
+        {
+            sink_.PushChar(static_cast<char>(codepoint));
+        }
+        else if (codepoint <= 0x7FF)
+        {
+            sink_.PushChar(static_cast<char>(0xC0 | (codepoint >> 6)));
+            sink_.PushChar(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else
+        {
+            sink_.PushChar(static_cast<char>(0xE0 | (codepoint >> 12)));
+            sink_.PushChar(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            sink_.PushChar(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    constexpr bool ParseString() noexcept
+    {
+        const size_t node = sink_.AddNode(JsonType::String);
+        const size_t begin = sink_.CharCount();
+        StringDfaStat cur_stat = StringDfaStat::IN_STRING;
+        ++pos_; // 跳过起始引号
+
+        while (cur_stat != StringDfaStat::STRING_END)
+        {
+            const char cur_char = Current();
+            if (cur_char == '\n' || pos_ >= source_.size())
+            {
+                return Fail(ERR_MISSING_QUOTATION_MARK);
+            }
+
+            if (cur_stat == StringDfaStat::IN_STRING)
+            {
+                if (cur_char == '"')
+                {
+                    cur_stat = StringDfaStat::STRING_END;
+                }
+                else if (cur_char == '\\')
+                {
+                    cur_stat = StringDfaStat::STRING_ESCAPE;
+                }
+                else
+                {
+                    sink_.PushChar(cur_char);
+                }
+                ++pos_;
+            }
+            else if (const char unescaped = UnescapeChar(cur_char); unescaped != '\0')
+            {
+                sink_.PushChar(unescaped);
+                cur_stat = StringDfaStat::IN_STRING;
+                ++pos_;
+            }
+            else if (cur_char == 'u')
+            {
+                ++pos_;
+                unsigned long codepoint = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (Current() == '\n' || pos_ >= source_.size())
+                    {
+                        return Fail(ERR_INCOMPLETE_UNICODE_ESCAPE);
+                    }
+                    if (!IsHexDigit(Current()))
+                    {
+                        return Fail(ERR_INVALID_UNICODE_ESCAPE);
+                    }
+                    codepoint = codepoint * 16 + HexValue(Current());
+                    ++pos_;
+                }
+                PushCodepoint(codepoint);
+                cur_stat = StringDfaStat::IN_STRING;
+            }
+            else
+            {
+                return Fail(ERR_INVALID_ESCAPE);
+            }
+        }
+
+        sink_.SetString(node, begin);
+        sink_.SetEnd(node);
+        return true;
+    }
+
+    constexpr bool ParseNumber() noexcept
+    {
+        const size_t begin = pos_;
+        NumberDfaStat cur_stat = NumberDfaStat::NUMBER_START;
+        while (!IsTokenEnd(Current()))
+        {
+            cur_stat = NextNumberStat(cur_stat, Current());
+            if (cur_stat == NumberDfaStat::ERROR)
+            {
+                return Fail(ERR_INVALID_NUMBER);
+            }
+            ++pos_;
+        }
+        if (!IsNumberAccepting(cur_stat))
+        {
+            return Fail(ERR_INCOMPLETE_NUMBER);
+        }
+
+        // dfa已经保证了格式正确，这里只需要计算数值
+        const std::string_view raw = source_.substr(begin, pos_ - begin);
+        const bool negative = raw[0] == '-';
+        const size_t exponent_pos = std::min(raw.find_first_of("eE"), raw.size());
+        const std::string_view digits = raw.substr(negative ? 1 : 0, exponent_pos - (negative ? 1 : 0));
+
+        if (exponent_pos == raw.size() && digits.find('.') == std::string_view::npos)
+        {
+            unsigned long long mantissa = 0;
+            bool overflow = false;
+            for (const char ch : digits)
+            {
+                const auto digit = static_cast<unsigned long long>(ch - '0');
+                overflow = overflow || mantissa > (std::numeric_limits<unsigned long long>::max() - digit) / 10;
+                mantissa = overflow ? mantissa : mantissa * 10 + digit;
+            }
+
+            // 与运行期的Parser一致，超出long long范围的整数按浮点数处理
+            const unsigned long long limit =
+                static_cast<unsigned long long>(std::numeric_limits<long long>::max()) + (negative ? 1 : 0);
+            if (!overflow && mantissa <= limit)
+            {
+                const size_t node = sink_.AddNode(JsonType::Int);
+                // 先转成负数再取反会溢出，所以负数通过无符号减法得到
+                sink_.SetInt(node,
+                             negative ? static_cast<long long>(0ULL - mantissa) : static_cast<long long>(mantissa));
+                sink_.SetEnd(node);
+                return true;
+            }
+        }
+
+        long long exponent = 0;
+        if (exponent_pos < raw.size())
+        {
+            size_t index = exponent_pos + 1; // 跳过e或E
+            const bool exp_negative = raw[index] == '-';
+            index += exp_negative ? 1 : 0;
+            for (; index < raw.size() && exponent < 100000; ++index)
+            {
+                exponent = exponent * 10 + (raw[index] - '0');
+            }
+            exponent = exp_negative ? -exponent : exponent;
+        }
+
+        long double value = 0;
+        if (!DecimalToFloat(digits, exponent, value))
+        {
+            return Fail(ERR_NUMBER_OUT_OF_RANGE);
+        }
+        const size_t node = sink_.AddNode(JsonType::Float);
+        sink_.SetFloat(node, negative ? -value : value);
+        sink_.SetEnd(node);
+        return true;
+    }
+
+    constexpr bool ParseLiteral() noexcept
+    {
+        LiteralDfaStat cur_stat = LiteralDfaStat::LITERAL_START;
+        while (!IsLiteralAccepting(cur_stat))
+        {
+            cur_stat = NextLiteralStat(cur_stat, Current());
+            if (cur_stat == LiteralDfaStat::ERROR)
+            {
+                return Fail(ERR_INVALID_LITERAL);
+            }
+            ++pos_;
+        }
+        if (!IsTokenEnd(Current()))
+        {
+            return Fail(ERR_INVALID_LITERAL);
+        }
+
+        if (cur_stat == LiteralDfaStat::NULL_L2)
+        {
+            sink_.SetEnd(sink_.AddNode(JsonType::Null));
+        }
+        else
+        {
+            const size_t node = sink_.AddNode(JsonType::Bool);
+            sink_.SetBool(node, cur_stat == LiteralDfaStat::TRUE_E);
+            sink_.SetEnd(node);
+        }
+        return true;
+    }
+};
+} // namespace static_detail
+
+/**
+ * @brief Validates a json string in a constant expression and measures the storage a StaticJson needs for it.
+ *
+ * @param source The json text.
+ * @return The validation result, including the first error and its byte offset on failure.
+ */
+constexpr StaticParseResult ValidateStaticJson(const std::string_view source) noexcept
+{
+    static_detail::CountingSink sink;
+    return static_detail::StaticParser<static_detail::CountingSink>(source, sink).Parse();
+}
+
+// 编译期生成的只读json文档，通常不直接实例化，而是使用STATIC_JSON宏自动计算模板参数
+template <size_t NodeCount, size_t CharCount> class StaticJson
+{
+  public:
+    constexpr explicit StaticJson(const std::string_view source) noexcept
+    {
+        static_detail::StorageSink<NodeCount, CHAR_CAPACITY> sink(nodes_, chars_);
+        result_ = static_detail::StaticParser<static_detail::StorageSink<NodeCount, CHAR_CAPACITY>>(source, sink).Parse();
+        result_.ok_ = result_.ok_ && result_.nodes_ <= NodeCount && result_.chars_ <= CHAR_CAPACITY;
+    }
+
+    /**
+     * @brief Checks if the source was parsed successfully, STATIC_JSON already rejects malformed literals at compile
+     * time.
+     */
+    [[nodiscard]] constexpr bool Ok() const noexcept
+    {
+        return result_.ok_;
+    }
+
+    [[nodiscard]] constexpr StaticJsonView Root() const noexcept
+    {
+        return Ok() ? StaticJsonView(nodes_.data(), chars_.data(), 0) : StaticJsonView();
+    }
+
+    [[nodiscard]] constexpr StaticJsonView operator[](const std::string_view key) const noexcept
+    {
+        return Root()[key];
+    }
+
+    [[nodiscard]] constexpr StaticJsonView operator[](const size_t index) const noexcept
+    {
+        return Root()[index];
+    }
+
+    /**
+     * @brief Materializes the whole document as a runtime JsonValue.
+     */
+    [[nodiscard]] JsonValue ToJsonValue() const
+    {
+        return Root().ToJsonValue();
+    }
+
+  private:
+    static constexpr size_t CHAR_CAPACITY = CharCount == 0 ? 1 : CharCount;
+
+    std::array<StaticNode, NodeCount> nodes_{};
+    std::array<char, CHAR_CAPACITY> chars_{};
+    StaticParseResult result_{};
+};
+
+// 在编译期解析json字面量，格式错误的json会导致编译失败
+#define STATIC_JSON(literal)                                                                                           \
+    [] {                                                                                                               \
+        constexpr std::string_view static_json_source = literal;                                                       \
+        constexpr ::simple_json::StaticParseResult static_json_result =                                                \
+            ::simple_json::ValidateStaticJson(static_json_source);                                                     \
+        static_assert(static_json_result.ok_, "malformed json literal, see simple_json::ValidateStaticJson");          \
+        return ::simple_json::StaticJson<static_json_result.nodes_, static_json_result.chars_>(static_json_source);    \
+    }()
+} // namespace simple_json
+
+#endif // STATIC_JSON_H
@@ -0,0 +1,92 @@
+#ifndef TRY_PARSE_H
+#define TRY_PARSE_H
+
+#include "config.h"
+#include "json_type.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace simple_json
+{
+// 不抛异常的解析入口报告的错误类型，与config.h中的错误提示一一对应
+enum class ErrorCode : uint8_t
+{
+    NONE,
+    UNKNOWN_VALUE,
+    MISSING_QUOTATION_MARK,
+    INVALID_ESCAPE,
+    INCOMPLETE_UNICODE_ESCAPE,
+    INVALID_UNICODE_ESCAPE,
+    INCOMPLETE_NUMBER,
+    INVALID_NUMBER,
+    INVALID_LITERAL,
+    MISMATCH_TOP_LEVEL,
+    EXPECTED_JSON_VALUE_TYPE,
+    COLON_EXPECTED,
+    COMMA_OR_BRACKET_EXPECTED,
+    COMMA_OR_BRACE_EXPECTED,
+    TRAILING_COMMA,
+    OBJECT_KEY_MUST_BE_STRING,
+    TRAILING_CONTENT,
+    NESTING_TOO_DEEP,
+    INPUT_TOO_LARGE,
+    STRING_TOO_LONG,
+    TOO_MANY_ELEMENTS
+};
+
+// 解析遇到的第一个错误
+struct ParseError
+{
+    ErrorCode code_{ErrorCode::NONE};
+    size_t offset_{0}; // 出错的token在原始字符串中的字节偏移
+
+    [[nodiscard]] bool Ok() const noexcept
+    {
+        return code_ == ErrorCode::NONE;
+    }
+};
+
+// TryParse的资源限制，超过任意一项都会立即失败，默认只限制嵌套层数
+struct ParseLimits
+{
+    size_t max_depth_{MAX_PARSE_DEPTH};                            // 最大嵌套层数
+    size_t max_input_size_{std::numeric_limits<size_t>::max()};    // 输入的最大字节数
+    size_t max_string_length_{std::numeric_limits<size_t>::max()}; // 单个字符串或键解码后的最大字节数
+    size_t max_elements_{std::numeric_limits<size_t>::max()};      // 整个文档中值的最大个数，包括容器本身
+};
+
+/**
+ * @brief Gets the error description of an error code, the same text the throwing parser uses.
+ */
+[[nodiscard]] const char *ErrorDescription(ErrorCode code) noexcept;
+
+/**
+ * @brief Parses a json document without throwing and stops at the first error. It works directly on the characters,
+ * no token stream or error message is built, so rejecting invalid input costs about as much as scanning it up to the
+ * error. Valid documents give the same json data struct as Json::FromString; unclosed containers and content after the
+ * top level value are rejected. Containers are tracked on an explicit stack instead of the call stack, so the nesting
+ * depth is bounded by limits.max_depth_ only.
+ *
+ * @param json_str The document, the top level must be an object or an array.
+ * @param value Receives the json data struct, left null on error.
+ * @param limits Resource limits, checked as the document is read.
+ * @return The first error and its byte offset, ErrorCode::NONE on success.
+ */
+[[nodiscard]] ParseError TryParse(std::string_view json_str, JsonValue &value, const ParseLimits &limits = {}) noexcept;
+
+/**
+ * @brief Formats an error returned by TryParse in the same highlighted format as the throwing parser. Only needed
+ * when the diagnostics are shown to someone.
+ *
+ * @param json_str The document that was parsed.
+ * @param error The error returned by TryParse.
+ * @return The multi-line error message, empty if there was no error.
+ */
+[[nodiscard]] std::string DescribeError(std::string_view json_str, const ParseError &error);
+} // namespace simple_json
+
+#endif // TRY_PARSE_H
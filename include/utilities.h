@@ -1,7 +1,12 @@
 #ifndef UTILITIES_H
 #define UTILITIES_H
 
+#include "json_type.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace simple_json
 {
@@ -10,6 +15,16 @@ std::string EncodeUtf8(unsigned long codepoint) noexcept; // 将unicode序列解
 std::string ConvertUnicodeEscape(const std::string &escape) noexcept; // 解析unicode序列
 
 bool IsAscii(int ch) noexcept; // 判断一个字符是不是ascii字符
+
+void AppendEscaped(std::string &out, std::string_view str); // 将字符串按json规则转义并加上引号后追加到out
+
+void AppendBase64Url(std::string &out, std::string_view bytes); // 将字节序列按不带填充的base64url编码后追加到out
+
+size_t HashCombine(size_t seed, size_t value) noexcept; // 将value的哈希值混合到seed中
+
+uint64_t MixHash(uint64_t value) noexcept; // MurmurHash3的fmix64，输入的每一位都会影响输出的所有位
+
+void AppendJson(std::string &out, const JsonValue &value); // 将json值以紧凑格式序列化后追加到out，非有限浮点数输出为null
 } // namespace simple_json
 
 #endif // UTILITIES_H
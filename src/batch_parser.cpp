@@ -0,0 +1,164 @@
+#include "batch_parser.h"
+#include "config.h"
+#include "try_parse.h"
+
+#include <algorithm>
+#include <exception>
+#include <numeric>
+
+namespace simple_json
+{
+BatchParser::BatchParser(const size_t thread_count)
+{
+    const size_t count = std::max<size_t>(thread_count, 1);
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+
+    // 第0个工作者由调用ParseBatch的线程充当
+    for (size_t i = 1; i < count; ++i)
+    {
+        workers_[i]->thread_ = std::thread(&BatchParser::Run, this, i);
+    }
+}
+
+BatchParser::~BatchParser()
+{
+    {
+        const std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (const auto &worker : workers_)
+    {
+        if (worker->thread_.joinable())
+        {
+            worker->thread_.join();
+        }
+    }
+}
+
+std::vector<BatchResult> BatchParser::ParseBatch(const std::string_view *documents, const size_t count)
+{
+    std::vector<BatchResult> results(count);
+    if (count == 0)
+    {
+        return results;
+    }
+
+    const std::lock_guard batch_lock(batch_mutex_);
+
+    // 先发布本批次的输入输出，工作者从队列中取到任务时通过队列的锁看到它们
+    documents_ = documents;
+    results_ = results.data();
+    remaining_.store(count, std::memory_order_relaxed);
+
+    // 按大小降序轮流分给各个队列，大文档最先开始，窃取者从队尾拿走的是最小的文档
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [documents](const size_t a, const size_t b) { return documents[a].size() > documents[b].size(); });
+    for (size_t i = 0; i < count; ++i)
+    {
+        Worker &worker = *workers_[i % workers_.size()];
+        const std::lock_guard lock(worker.mutex_);
+        worker.tasks_.push_back(order[i]);
+    }
+
+    {
+        const std::lock_guard lock(mutex_);
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    RunTasks(0);
+
+    // 当前线程没有任务可取时，其他工作者可能还在解析最后几个文档
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [this] { return remaining_.load(std::memory_order_acquire) == 0; });
+    documents_ = nullptr;
+    results_ = nullptr;
+    return results;
+}
+
+void BatchParser::Run(const size_t worker_index)
+{
+    size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            start_cv_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+            if (stopping_)
+            {
+                return;
+            }
+            seen = generation_;
+        }
+        RunTasks(worker_index);
+    }
+}
+
+void BatchParser::RunTasks(const size_t worker_index)
+{
+    size_t task = 0;
+    while (NextTask(worker_index, task))
+    {
+        BatchResult &result = results_[task];
+#if SIMPLE_JSON_EXCEPTIONS
+        try
+        {
+            result.value_ = workers_[worker_index]->parser_.Parse(documents_[task]);
+        }
+        catch (const std::exception &e)
+        {
+            result.error_ = e.what();
+        }
+#else
+        // 关闭异常时改用不抛异常的解析入口，错误信息只包含第一个错误
+        if (const ParseError error = TryParse(documents_[task], result.value_); !error.Ok())
+        {
+            result.error_ = DescribeError(documents_[task], error);
+        }
+#endif
+
+        // 最后一个完成的文档唤醒等待中的ParseBatch
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            const std::lock_guard lock(mutex_);
+            done_cv_.notify_all();
+        }
+    }
+}
+
+bool BatchParser::NextTask(const size_t worker_index, size_t &task)
+{
+    {
+        Worker &own = *workers_[worker_index];
+        const std::lock_guard lock(own.mutex_);
+        if (!own.tasks_.empty())
+        {
+            task = own.tasks_.front();
+            own.tasks_.pop_front();
+            return true;
+        }
+    }
+
+    // 自己的队列空了，从其他队列的尾部窃取
+    for (size_t offset = 1; offset < workers_.size(); ++offset)
+    {
+        Worker &victim = *workers_[(worker_index + offset) % workers_.size()];
+        const std::lock_guard lock(victim.mutex_);
+        if (!victim.tasks_.empty())
+        {
+            task = victim.tasks_.back();
+            victim.tasks_.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace simple_json
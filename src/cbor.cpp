@@ -0,0 +1,550 @@
+#include "cbor.h"
+#include "config.h"
+#include "utilities.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+constexpr uint8_t MAJOR_UNSIGNED = 0;
+constexpr uint8_t MAJOR_NEGATIVE = 1;
+constexpr uint8_t MAJOR_BYTES = 2;
+constexpr uint8_t MAJOR_TEXT = 3;
+constexpr uint8_t MAJOR_ARRAY = 4;
+constexpr uint8_t MAJOR_MAP = 5;
+constexpr uint8_t MAJOR_TAG = 6;
+constexpr uint8_t MAJOR_SIMPLE = 7;
+
+constexpr uint8_t INFO_FALSE = 20;
+constexpr uint8_t INFO_TRUE = 21;
+constexpr uint8_t INFO_NULL = 22;
+constexpr uint8_t INFO_UNDEFINED = 23;
+constexpr uint8_t INFO_HALF = 25;
+constexpr uint8_t INFO_FLOAT = 26;
+constexpr uint8_t INFO_DOUBLE = 27;
+constexpr uint8_t INFO_INDEFINITE = 31;
+constexpr uint8_t BREAK = 0xff;
+
+// 参数小于24时直接放在首字节中，否则使用能容纳它的最短的1、2、4或8字节大端序
+void AppendHead(std::string &out, const uint8_t major, const uint64_t argument)
+{
+    const auto initial = static_cast<uint8_t>(major << 5);
+    if (argument < 24)
+    {
+        out.push_back(static_cast<char>(initial | argument));
+        return;
+    }
+
+    uint8_t info = 27;
+    if (argument <= 0xff)
+    {
+        info = 24;
+    }
+    else if (argument <= 0xffff)
+    {
+        info = 25;
+    }
+    else if (argument <= 0xffffffff)
+    {
+        info = 26;
+    }
+    out.push_back(static_cast<char>(initial | info));
+    for (int shift = (8 << (info - 24)) - 8; shift >= 0; shift -= 8)
+    {
+        out.push_back(static_cast<char>((argument >> shift) & 0xff));
+    }
+}
+
+// float能被半精度浮点数精确表示时返回true
+bool ToHalf(const float value, uint16_t &half) noexcept
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (std::isinf(value) || value == 0.0F)
+    {
+        half = static_cast<uint16_t>(sign | (std::isinf(value) ? 0x7c00 : 0));
+        return true;
+    }
+    if (exponent >= 31 || exponent < -10)
+    {
+        return false;
+    }
+    if (exponent <= 0)
+    {
+        // 非规格化数，隐含的最高位需要显式移入尾数
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        if ((mantissa & ((1U << shift) - 1)) != 0)
+        {
+            return false;
+        }
+        half = static_cast<uint16_t>(sign | (mantissa >> shift));
+        return true;
+    }
+    if ((mantissa & 0x1fff) != 0)
+    {
+        return false;
+    }
+    half = static_cast<uint16_t>(sign | (exponent << 10) | (mantissa >> 13));
+    return true;
+}
+
+double FromHalf(const uint16_t half) noexcept
+{
+    const int exponent = (half >> 10) & 0x1f;
+    const int mantissa = half & 0x3ff;
+    double value = 0;
+    if (exponent == 0)
+    {
+        value = std::ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    }
+    return (half & 0x8000) != 0 ? -value : value;
+}
+
+// 使用能够无损表示该值的最短浮点格式
+void AppendFloat(std::string &out, const long double value)
+{
+    if (std::isnan(value))
+    {
+        out.append("\xf9\x7e\x00", 3);
+        return;
+    }
+
+    const auto as_double = static_cast<double>(value);
+    const auto as_float = static_cast<float>(as_double);
+    uint16_t half = 0;
+    if (static_cast<double>(as_float) == as_double && ToHalf(as_float, half))
+    {
+        out.push_back(static_cast<char>((MAJOR_SIMPLE << 5) | INFO_HALF));
+        out.push_back(static_cast<char>(half >> 8));
+        out.push_back(static_cast<char>(half & 0xff));
+    }
+    else if (static_cast<double>(as_float) == as_double)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &as_float, sizeof(bits));
+        out.push_back(static_cast<char>((MAJOR_SIMPLE << 5) | INFO_FLOAT));
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<char>((bits >> shift) & 0xff));
+        }
+    }
+    else
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &as_double, sizeof(bits));
+        out.push_back(static_cast<char>((MAJOR_SIMPLE << 5) | INFO_DOUBLE));
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<char>((bits >> shift) & 0xff));
+        }
+    }
+}
+
+} // namespace
+
+void AppendCbor(std::string &out, const JsonValue &value)
+{
+    switch (value.GetType())
+    {
+    case JsonType::Object: {
+        const auto &object = value.GetVal<JsonType::Object>();
+        AppendHead(out, MAJOR_MAP, object.size());
+        for (const auto &[key, member] : object)
+        {
+            AppendHead(out, MAJOR_TEXT, key.size());
+            out.append(key);
+            AppendCbor(out, member);
+        }
+        break;
+    }
+    case JsonType::Array: {
+        const auto &array = value.GetVal<JsonType::Array>();
+        AppendHead(out, MAJOR_ARRAY, array.size());
+        for (const JsonValue &element : array)
+        {
+            AppendCbor(out, element);
+        }
+        break;
+    }
+    case JsonType::String: {
+        const std::string &str = value.GetVal<JsonType::String>();
+        AppendHead(out, MAJOR_TEXT, str.size());
+        out.append(str);
+        break;
+    }
+    case JsonType::Int: {
+        // 负数n编码为-1-n，按无符号数计算避免溢出
+        const long long number = value.GetVal<JsonType::Int>();
+        if (number >= 0)
+        {
+            AppendHead(out, MAJOR_UNSIGNED, static_cast<uint64_t>(number));
+        }
+        else
+        {
+            AppendHead(out, MAJOR_NEGATIVE, ~static_cast<uint64_t>(number));
+        }
+        break;
+    }
+    case JsonType::Float:
+        AppendFloat(out, value.GetVal<JsonType::Float>());
+        break;
+    case JsonType::Bool:
+        AppendHead(out, MAJOR_SIMPLE, value.GetVal<JsonType::Bool>() ? INFO_TRUE : INFO_FALSE);
+        break;
+    case JsonType::Null:
+        AppendHead(out, MAJOR_SIMPLE, INFO_NULL);
+        break;
+    }
+}
+
+std::string ToCbor(const JsonValue &value)
+{
+    std::string out;
+    AppendCbor(out, value);
+    return out;
+}
+
+JsonValue FromCbor(const std::string_view data)
+{
+    CborReader reader(data);
+    JsonBuilder builder;
+    if (!reader.Parse(builder))
+    {
+        reader.ThrowError();
+    }
+    return builder.TakeValue();
+}
+
+bool CborReader::Parse(SaxHandler &handler)
+{
+    pos_ = 0;
+    error_.clear();
+    frames_.clear();
+
+    do
+    {
+        // map中的每个成员先读取键，json只允许字符串作为键
+        if (!frames_.empty() && frames_.back().is_map_)
+        {
+            uint8_t major = 0;
+            uint8_t info = 0;
+            uint64_t argument = 0;
+            std::string_view key;
+            if (!ReadHead(major, info, argument))
+            {
+                return false;
+            }
+            if (major != MAJOR_TEXT)
+            {
+                return Fail("map key must be a text string");
+            }
+            if (!ReadString(major, argument, info == INFO_INDEFINITE, key))
+            {
+                return false;
+            }
+            if (!handler.Key(key))
+            {
+                return Abort(handler);
+            }
+        }
+
+        bool container = false;
+        if (!ReadItem(handler, container))
+        {
+            return false;
+        }
+        if (!container)
+        {
+            CompleteMember();
+        }
+
+        // 关闭所有已经读完的容器，definite长度看剩余个数，indefinite长度看是否遇到break
+        while (!frames_.empty())
+        {
+            const Frame &frame = frames_.back();
+            if (frame.indefinite_)
+            {
+                if (pos_ >= data_.size())
+                {
+                    return Fail("unexpected end of data");
+                }
+                if (static_cast<uint8_t>(data_[pos_]) != BREAK)
+                {
+                    break;
+                }
+                ++pos_;
+            }
+            else if (frame.remaining_ != 0)
+            {
+                break;
+            }
+
+            const bool is_map = frame.is_map_;
+            const size_t count = frame.count_;
+            frames_.pop_back();
+            if (!(is_map ? handler.EndObject(count) : handler.EndArray(count)))
+            {
+                return Abort(handler);
+            }
+            CompleteMember();
+        }
+    } while (!frames_.empty());
+
+    if (pos_ != data_.size())
+    {
+        return Fail("unexpected data after the top level item");
+    }
+    return true;
+}
+
+void CborReader::ThrowError() const
+{
+    SIMPLE_JSON_THROW(std::runtime_error(error_));
+}
+
+bool CborReader::Fail(const std::string &err_desc)
+{
+    error_ = ERR_INVALID_CBOR + err_desc + " at byte " + std::to_string(pos_);
+    return false;
+}
+
+bool CborReader::Abort(const SaxHandler &handler)
+{
+    error_ = handler.GetError();
+    if (error_.empty())
+    {
+        error_ = ERR_SAX_HANDLER_STOPPED;
+    }
+    return false;
+}
+
+bool CborReader::ReadHead(uint8_t &major, uint8_t &info, uint64_t &argument)
+{
+    if (pos_ >= data_.size())
+    {
+        return Fail("unexpected end of data");
+    }
+    const auto initial = static_cast<uint8_t>(data_[pos_++]);
+    major = initial >> 5;
+    info = initial & 0x1f;
+    argument = info;
+    if (info < 24 || info == INFO_INDEFINITE)
+    {
+        return true;
+    }
+    if (info > 27)
+    {
+        return Fail("reserved additional information " + std::to_string(info));
+    }
+
+    const size_t size = size_t{1} << (info - 24);
+    if (data_.size() - pos_ < size)
+    {
+        return Fail("unexpected end of data");
+    }
+    argument = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        argument = (argument << 8) | static_cast<uint8_t>(data_[pos_++]);
+    }
+    return true;
+}
+
+bool CborReader::ReadString(const uint8_t major, const uint64_t length, const bool indefinite,
+                            std::string_view &value)
+{
+    if (!indefinite)
+    {
+        if (data_.size() - pos_ < length)
+        {
+            return Fail("unexpected end of data");
+        }
+        value = data_.substr(pos_, length);
+        pos_ += length;
+        if (major == MAJOR_BYTES)
+        {
+            // RFC 8949第6.1节，字节串转换为不带填充的base64url字符串
+            scratch_.clear();
+            AppendBase64Url(scratch_, value);
+            value = scratch_;
+        }
+        return true;
+    }
+
+    // indefinite长度的字符串由同类型的definite分段组成，以break结束
+    scratch_.clear();
+    while (true)
+    {
+        if (pos_ >= data_.size())
+        {
+            return Fail("unexpected end of data");
+        }
+        if (static_cast<uint8_t>(data_[pos_]) == BREAK)
+        {
+            ++pos_;
+            break;
+        }
+
+        uint8_t chunk_major = 0;
+        uint8_t chunk_info = 0;
+        uint64_t chunk_length = 0;
+        if (!ReadHead(chunk_major, chunk_info, chunk_length))
+        {
+            return false;
+        }
+        if (chunk_major != major || chunk_info == INFO_INDEFINITE)
+        {
+            return Fail("invalid chunk in an indefinite length string");
+        }
+        if (data_.size() - pos_ < chunk_length)
+        {
+            return Fail("unexpected end of data");
+        }
+        scratch_.append(data_.substr(pos_, chunk_length));
+        pos_ += chunk_length;
+    }
+
+    if (major == MAJOR_BYTES)
+    {
+        std::string encoded;
+        AppendBase64Url(encoded, scratch_);
+        scratch_ = std::move(encoded);
+    }
+    value = scratch_;
+    return true;
+}
+
+bool CborReader::ReadItem(SaxHandler &handler, bool &container)
+{
+    uint8_t major = 0;
+    uint8_t info = 0;
+    uint64_t argument = 0;
+    if (!ReadHead(major, info, argument))
+    {
+        return false;
+    }
+
+    // 标签只是对内容的语义说明，转换为json时忽略
+    while (major == MAJOR_TAG)
+    {
+        if (info == INFO_INDEFINITE)
+        {
+            return Fail("invalid tag");
+        }
+        if (!ReadHead(major, info, argument))
+        {
+            return false;
+        }
+    }
+
+    bool accepted = true;
+    switch (major)
+    {
+    case MAJOR_UNSIGNED:
+    case MAJOR_NEGATIVE:
+        if (info == INFO_INDEFINITE)
+        {
+            return Fail("integer with indefinite length");
+        }
+        if (argument > static_cast<uint64_t>(LLONG_MAX))
+        {
+            return Fail("integer out of range");
+        }
+        accepted = handler.Int(major == MAJOR_UNSIGNED ? static_cast<long long>(argument)
+                                                       : -1 - static_cast<long long>(argument));
+        break;
+    case MAJOR_BYTES:
+    case MAJOR_TEXT: {
+        std::string_view value;
+        if (!ReadString(major, argument, info == INFO_INDEFINITE, value))
+        {
+            return false;
+        }
+        accepted = handler.String(value);
+        break;
+    }
+    case MAJOR_ARRAY:
+    case MAJOR_MAP:
+        // 与文本解析器相同的嵌套上限，生成的树过深时析构和遍历会耗尽栈
+        if (frames_.size() >= MAX_PARSE_DEPTH)
+        {
+            return Fail("nesting is too deep");
+        }
+        accepted = major == MAJOR_MAP ? handler.StartObject() : handler.StartArray();
+        frames_.push_back(Frame{major == MAJOR_MAP, info == INFO_INDEFINITE, argument, 0});
+        container = true;
+        break;
+    default:
+        switch (info)
+        {
+        case INFO_FALSE:
+        case INFO_TRUE:
+            accepted = handler.Bool(info == INFO_TRUE);
+            break;
+        case INFO_NULL:
+        case INFO_UNDEFINED:
+            accepted = handler.Null();
+            break;
+        case INFO_HALF:
+            accepted = handler.Float(FromHalf(static_cast<uint16_t>(argument)));
+            break;
+        case INFO_FLOAT: {
+            const auto bits = static_cast<uint32_t>(argument);
+            float number = 0;
+            std::memcpy(&number, &bits, sizeof(number));
+            accepted = handler.Float(number);
+            break;
+        }
+        case INFO_DOUBLE: {
+            double number = 0;
+            std::memcpy(&number, &argument, sizeof(number));
+            accepted = handler.Float(number);
+            break;
+        }
+        case INFO_INDEFINITE:
+            return Fail("unexpected break");
+        default:
+            return Fail("unsupported simple value " + std::to_string(argument));
+        }
+        break;
+    }
+    return accepted || Abort(handler);
+}
+
+void CborReader::CompleteMember() noexcept
+{
+    if (frames_.empty())
+    {
+        return;
+    }
+    Frame &frame = frames_.back();
+    ++frame.count_;
+    if (!frame.indefinite_)
+    {
+        --frame.remaining_;
+    }
+}
+} // namespace simple_json
@@ -0,0 +1,359 @@
+#include "chunk_reader.h"
+#include "config.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if ENABLE_GZIP
+#include <zlib.h>
+#endif
+
+#if ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+// 解压线程和解析线程之间的有界队列
+class ChunkQueue
+{
+  public:
+    // 队列满时阻塞，消费者已经退出时返回false
+    bool Push(std::string &&chunk)
+    {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] { return chunks_.size() < CHUNK_QUEUE_DEPTH || cancelled_; });
+        if (cancelled_)
+        {
+            return false;
+        }
+
+        chunks_.push_back(std::move(chunk));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // 队列空时阻塞，生产者已经结束并且队列为空时返回false
+    bool Pop(std::string &chunk)
+    {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return !chunks_.empty() || closed_; });
+        if (chunks_.empty())
+        {
+            return false;
+        }
+
+        chunk = std::move(chunks_.front());
+        chunks_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // 生产者结束，error为生产者抛出的异常
+    void Close(std::exception_ptr error) noexcept
+    {
+        const std::lock_guard lock(mutex_);
+        closed_ = true;
+        error_ = std::move(error);
+        not_empty_.notify_one();
+    }
+
+    // 消费者退出，唤醒可能阻塞在Push中的生产者
+    void Cancel() noexcept
+    {
+        const std::lock_guard lock(mutex_);
+        cancelled_ = true;
+        not_full_.notify_one();
+    }
+
+    [[nodiscard]] std::exception_ptr Error() noexcept
+    {
+        const std::lock_guard lock(mutex_);
+        return error_;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<std::string> chunks_;
+    bool closed_ = false;
+    bool cancelled_ = false;
+    std::exception_ptr error_;
+};
+
+// 从文件中读取至多CHUNK_SIZE字节，返回读取到的字节数，0表示文件已经读完
+size_t ReadInput(std::istream &fs, std::string &input)
+{
+    input.resize(CHUNK_SIZE);
+    fs.read(input.data(), static_cast<std::streamsize>(CHUNK_SIZE));
+    if (fs.bad())
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    return static_cast<size_t>(fs.gcount());
+}
+
+void CopyPlain(std::istream &fs, ChunkQueue &queue)
+{
+    std::string chunk;
+    while (const size_t read = ReadInput(fs, chunk))
+    {
+        chunk.resize(read);
+        if (!queue.Push(std::move(chunk)))
+        {
+            return;
+        }
+    }
+}
+
+#if ENABLE_GZIP
+void InflateGzip(std::istream &fs, ChunkQueue &queue)
+{
+    z_stream stream{};
+    // 窗口取最大值15，加32表示自动识别gzip或zlib头
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_DECOMPRESS + std::string("zlib initialization failed")));
+    }
+    const std::unique_ptr<z_stream, int (*)(z_stream *)> guard(&stream, inflateEnd);
+
+    std::string input;
+    std::string output(CHUNK_SIZE, '\0');
+    size_t filled = 0;
+    bool need_input = true;   // 上一次inflate没有写满输出缓冲区，说明已经用完了全部输入
+    bool member_end = false;  // 是否刚好结束了一个gzip成员，结束时输出可能正好写满，仍然要读取输入判断后面是否还有成员
+    while (true)
+    {
+        if (stream.avail_in == 0 && (need_input || member_end))
+        {
+            const size_t read = ReadInput(fs, input);
+            if (read == 0)
+            {
+                break;
+            }
+            stream.next_in = reinterpret_cast<Bytef *>(input.data());
+            stream.avail_in = static_cast<uInt>(read);
+        }
+
+        if (member_end)
+        {
+            // 多个gzip成员拼接而成的文件，有新的输入时才开始下一个成员，解压结果依次连接
+            inflateReset(&stream);
+            member_end = false;
+        }
+
+        stream.next_out = reinterpret_cast<Bytef *>(output.data() + filled);
+        stream.avail_out = static_cast<uInt>(CHUNK_SIZE - filled);
+        const int status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+        {
+            SIMPLE_JSON_THROW(
+                std::runtime_error(ERR_DECOMPRESS + std::string(stream.msg != nullptr ? stream.msg : "gzip error")));
+        }
+
+        member_end = status == Z_STREAM_END;
+        need_input = stream.avail_out != 0;
+        filled = CHUNK_SIZE - stream.avail_out;
+        if (filled == CHUNK_SIZE)
+        {
+            if (!queue.Push(std::move(output)))
+            {
+                return;
+            }
+            output.assign(CHUNK_SIZE, '\0');
+            filled = 0;
+        }
+    }
+
+    if (!member_end)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_DECOMPRESS + std::string("unexpected end of gzip data")));
+    }
+
+    output.resize(filled);
+    if (!output.empty())
+    {
+        queue.Push(std::move(output));
+    }
+}
+#endif
+
+#if ENABLE_ZSTD
+void DecompressZstd(std::istream &fs, ChunkQueue &queue)
+{
+    const std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream *)> stream(ZSTD_createDStream(), ZSTD_freeDStream);
+    if (!stream)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_DECOMPRESS + std::string("zstd initialization failed")));
+    }
+
+    std::string input;
+    std::string output(CHUNK_SIZE, '\0');
+    ZSTD_inBuffer in{input.data(), 0, 0};
+    ZSTD_outBuffer out{output.data(), CHUNK_SIZE, 0};
+    bool need_input = true;  // 上一次解压没有写满输出缓冲区，说明已经用完了全部输入
+    bool frame_end = false;  // 是否刚好结束了一个zstd帧，结束时输出可能正好写满，仍然要读取输入判断后面是否还有帧
+    while (true)
+    {
+        // 帧结束后没有输入时不能继续调用解压，否则返回值变为下一帧的提示，看不出文件是否完整结束
+        if (in.pos == in.size && (need_input || frame_end))
+        {
+            const size_t read = ReadInput(fs, input);
+            if (read == 0)
+            {
+                break;
+            }
+            in = {input.data(), read, 0};
+        }
+
+        const size_t status = ZSTD_decompressStream(stream.get(), &out, &in);
+        if (ZSTD_isError(status) != 0)
+        {
+            SIMPLE_JSON_THROW(std::runtime_error(ERR_DECOMPRESS + std::string(ZSTD_getErrorName(status))));
+        }
+
+        // 返回0表示当前帧已经结束，后面可能还有拼接的帧
+        frame_end = status == 0;
+        need_input = out.pos < out.size;
+        if (out.pos == CHUNK_SIZE)
+        {
+            if (!queue.Push(std::move(output)))
+            {
+                return;
+            }
+            output.assign(CHUNK_SIZE, '\0');
+            out = {output.data(), CHUNK_SIZE, 0};
+        }
+    }
+
+    if (!frame_end)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_DECOMPRESS + std::string("unexpected end of zstd data")));
+    }
+
+    output.resize(out.pos);
+    if (!output.empty())
+    {
+        queue.Push(std::move(output));
+    }
+}
+#endif
+
+void Produce(std::istream &fs, const Compression compression, ChunkQueue &queue)
+{
+    switch (compression)
+    {
+    case Compression::NONE:
+        CopyPlain(fs, queue);
+        break;
+    case Compression::GZIP:
+#if ENABLE_GZIP
+        InflateGzip(fs, queue);
+#endif
+        break;
+    case Compression::ZSTD:
+#if ENABLE_ZSTD
+        DecompressZstd(fs, queue);
+#endif
+        break;
+    }
+}
+} // namespace
+
+std::optional<Compression> CompressionOf(const std::filesystem::path &file_path)
+{
+    const std::filesystem::path extension = file_path.extension();
+    if (extension == ".json")
+    {
+        return Compression::NONE;
+    }
+
+    // 压缩文件要求去掉压缩扩展名之后仍然是.json文件
+    if (file_path.stem().extension() != ".json")
+    {
+        return std::nullopt;
+    }
+    if (extension == ".gz")
+    {
+        return Compression::GZIP;
+    }
+    if (extension == ".zst")
+    {
+        return Compression::ZSTD;
+    }
+    return std::nullopt;
+}
+
+void ReadChunks(const std::filesystem::path &file_path, const Compression compression,
+                const std::function<void(std::string_view)> &sink)
+{
+    if ((compression == Compression::GZIP && !ENABLE_GZIP) || (compression == Compression::ZSTD && !ENABLE_ZSTD))
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_UNSUPPORTED_COMPRESSION + file_path.extension().string()));
+    }
+
+    std::ifstream fs(file_path, std::ios::in | std::ios::binary);
+    if (!fs.is_open())
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+
+    // 后台线程读取并解压，当前线程消费已经解压好的数据块，两者同时进行
+    ChunkQueue queue;
+    std::thread worker([&fs, compression, &queue] {
+#if SIMPLE_JSON_EXCEPTIONS
+        try
+        {
+            Produce(fs, compression, queue);
+            queue.Close(nullptr);
+        }
+        catch (...)
+        {
+            queue.Close(std::current_exception());
+        }
+#else
+        // 关闭异常时，解压出错会直接终止程序，不会走到这里
+        Produce(fs, compression, queue);
+        queue.Close(nullptr);
+#endif
+    });
+
+    // 无论sink是否抛异常，都要让后台线程退出并等待它结束
+    struct Joiner
+    {
+        ChunkQueue &queue_;
+        std::thread &worker_;
+        ~Joiner()
+        {
+            queue_.Cancel();
+            worker_.join();
+        }
+    } joiner{queue, worker};
+
+    std::string chunk;
+    while (queue.Pop(chunk))
+    {
+        sink(chunk);
+    }
+
+#if SIMPLE_JSON_EXCEPTIONS
+    if (const std::exception_ptr error = queue.Error())
+    {
+        std::rethrow_exception(error);
+    }
+#endif
+}
+} // namespace simple_json
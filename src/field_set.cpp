@@ -0,0 +1,265 @@
+#include "field_set.h"
+#include "config.h"
+#include "sax.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+// 按字段集合构建json，不需要的成员只检查语法，键的查找直接使用token中的字符串，不产生临时对象
+class Projector
+{
+  public:
+    Projector(const JsonData &json_data, const FieldSet &fields) noexcept
+        : sax_(json_data), reader_(sax_.Reader()), fields_(fields)
+    {
+    }
+
+    JsonValue Run()
+    {
+        const Token *top = reader_.Current();
+        if (top->type_ != TokenType::LBRACE && top->type_ != TokenType::LBRACKET)
+        {
+            Fail(ERR_MISMATCH_TOP_LEVEL, top);
+        }
+
+        JsonValue result;
+        if (top->type_ == TokenType::LBRACE)
+        {
+            ProjectObject(0, result);
+        }
+        else
+        {
+            ProjectArray(0, result);
+        }
+        return result;
+    }
+
+  private:
+    SaxReader sax_; // 用于构建需要整体保留的子树
+    TokenReader &reader_;
+    const FieldSet &fields_;
+    ErrReporter err_reporter_;
+
+    // 记录错误并立即抛出异常
+    void Fail(std::string err_desc, const Token *token, const size_t highlight_pos = 0, const size_t highlight_len = 0)
+    {
+        err_reporter_.AddError(reader_.MakeErrInfo(std::move(err_desc), token, highlight_pos, highlight_len));
+        err_reporter_.ThrowError();
+    }
+
+    // 游标位于值的第一个token上，返回时位于值的最后一个token上；值与字段集合不匹配时返回false
+    bool ProjectValue(const size_t node, JsonValue &out)
+    {
+        if (fields_.GetNode(node).whole_)
+        {
+            JsonBuilder builder;
+            if (!sax_.ParseValue(builder))
+            {
+                sax_.ThrowError();
+            }
+            out = builder.TakeValue();
+            return true;
+        }
+
+        const Token *token = reader_.Current();
+        switch (token->type_)
+        {
+        case TokenType::LBRACE:
+            ProjectObject(node, out);
+            return true;
+        case TokenType::LBRACKET:
+            ProjectArray(node, out);
+            return true;
+        case TokenType::STR:
+        case TokenType::NUM:
+        case TokenType::TRUE:
+        case TokenType::FALSE:
+        case TokenType::NULL_:
+            return false; // 需要从标量中取成员，不可能匹配
+        default:
+            Fail(ERR_EXPECTED_JSON_VALUE_TYPE, token);
+            return false;
+        }
+    }
+
+    // 需要的成员全部读到之后仍要读完整个对象，后面可能还有重复的键
+    void ProjectObject(const size_t node, JsonValue &out)
+    {
+        const auto &children = fields_.GetNode(node).children_;
+        out = std::unordered_map<std::string, JsonValue>{};
+        auto &object = out.GetVal<JsonType::Object>();
+
+        if (reader_.Advance()->type_ == TokenType::RBRACE)
+        {
+            return;
+        }
+        while (true)
+        {
+            const Token *key = reader_.Current();
+            if (key->type_ != TokenType::STR)
+            {
+                Fail(ERR_OBJECT_KEY_MUST_BE_STRING, key);
+            }
+            if (reader_.Peek()->type_ != TokenType::COLON)
+            {
+                Fail(ERR_COLON_EXPECTED, key, key->col_ + key->len_, 1);
+            }
+            reader_.Advance();
+            reader_.Advance();
+
+            const auto child = children.find(key->raw_value_);
+            if (child != children.end())
+            {
+                // 与Parser一致，重复的键以最后一个为准，后出现的值重新投影并覆盖先前的结果
+                JsonValue value;
+                if (ProjectValue(child->second, value))
+                {
+                    object[key->raw_value_] = std::move(value);
+                }
+                else
+                {
+                    object.erase(key->raw_value_);
+                }
+            }
+            else
+            {
+                Skip();
+            }
+
+            if (ReadSeparator(TokenType::RBRACE))
+            {
+                return;
+            }
+        }
+    }
+
+    void ProjectArray(const size_t node, JsonValue &out)
+    {
+        out = std::vector<JsonValue>{};
+        auto &array = out.GetVal<JsonType::Array>();
+
+        if (reader_.Advance()->type_ == TokenType::RBRACKET)
+        {
+            return;
+        }
+        while (true)
+        {
+            JsonValue value;
+            if (ProjectValue(node, value))
+            {
+                array.push_back(std::move(value));
+            }
+            if (ReadSeparator(TokenType::RBRACKET))
+            {
+                return;
+            }
+        }
+    }
+
+    void Skip()
+    {
+        if (const char *err_desc = nullptr; !reader_.SkipValue(err_desc))
+        {
+            Fail(err_desc, reader_.Current());
+        }
+    }
+
+    // 游标位于某个成员的最后一个token上，读取逗号或右括号；返回true表示容器已经结束
+    bool ReadSeparator(const TokenType close)
+    {
+        const Token *last = reader_.Current();
+        const Token *next = reader_.Advance();
+        if (next->type_ == close)
+        {
+            return true;
+        }
+        if (next->type_ != TokenType::COMMA)
+        {
+            Fail(close == TokenType::RBRACE ? ERR_COMMA_OR_BRACE_EXPECTED : ERR_COMMA_OR_BRACKET_EXPECTED, last,
+                 last->col_ + last->len_, 1);
+        }
+        if (reader_.Advance()->type_ == close)
+        {
+            if (!ALLOW_TRAILING_COMMA)
+            {
+                Fail(ERR_TRAILING_COMMA, next);
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+FieldSet::FieldSet()
+{
+    nodes_.emplace_back();
+}
+
+FieldSet::FieldSet(const std::initializer_list<std::string_view> dotted_paths) : FieldSet()
+{
+    for (const std::string_view path : dotted_paths)
+    {
+        Add(path);
+    }
+}
+
+void FieldSet::Add(const std::string_view dotted_path)
+{
+    std::vector<std::string> keys;
+    size_t begin = 0;
+    while (true)
+    {
+        const size_t end = dotted_path.find('.', begin);
+        keys.emplace_back(dotted_path.substr(begin, end == std::string_view::npos ? end : end - begin));
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        begin = end + 1;
+    }
+    Add(keys);
+}
+
+void FieldSet::Add(const std::vector<std::string> &keys)
+{
+    size_t cur = 0;
+    for (const std::string &key : keys)
+    {
+        if (nodes_[cur].whole_)
+        {
+            return; // 更短的路径已经保留了整个子树
+        }
+
+        const auto child = nodes_[cur].children_.find(key);
+        if (child != nodes_[cur].children_.end())
+        {
+            cur = child->second;
+            continue;
+        }
+        const size_t next = nodes_.size();
+        nodes_.emplace_back();
+        nodes_[cur].children_.emplace(key, next);
+        cur = next;
+    }
+
+    // 保留整个子树，不再需要更深的路径
+    nodes_[cur].whole_ = true;
+    nodes_[cur].children_.clear();
+}
+
+JsonValue FieldSet::Project(const JsonData &json_data) const
+{
+    Projector projector(json_data, *this);
+    return projector.Run();
+}
+} // namespace simple_json
@@ -0,0 +1,323 @@
+#include "json_diff.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+constexpr size_t MAX_EDIT_DISTANCE = 1024; // 数组编辑距离超过该值时改为按位置逐个比较，避免最坏情况下的平方复杂度
+
+// 计算子树的哈希值，与JsonValue::Hash一致；容器未缓存哈希值时按节点地址记录，每个节点在一次diff中只计算一次
+class SubtreeHasher
+{
+  public:
+    size_t Hash(const JsonValue &value)
+    {
+        if (CACHE_HASH || (value.GetType() != JsonType::Object && value.GetType() != JsonType::Array))
+        {
+            return value.Hash();
+        }
+        if (const auto iter = memo_.find(&value); iter != memo_.end())
+        {
+            return iter->second;
+        }
+
+        size_t hash = 0;
+        if (value.GetType() == JsonType::Object)
+        {
+            const auto &object = value.GetVal<JsonType::Object>();
+            size_t sum = 0;
+            for (const auto &[key, member] : object)
+            {
+                sum += static_cast<size_t>(MixHash(HashCombine(std::hash<std::string>{}(key), Hash(member))));
+            }
+            hash = HashCombine(HashCombine(static_cast<size_t>(JsonType::Object), object.size()), sum);
+        }
+        else
+        {
+            const auto &array = value.GetVal<JsonType::Array>();
+            hash = HashCombine(static_cast<size_t>(JsonType::Array), array.size());
+            for (const JsonValue &element : array)
+            {
+                hash = HashCombine(hash, Hash(element));
+            }
+        }
+        hash = hash == 0 ? 1 : hash;
+        memo_.emplace(&value, hash);
+        return hash;
+    }
+
+  private:
+    std::unordered_map<const JsonValue *, size_t> memo_;
+};
+
+// 把pointer的一段按RFC 6901转义后追加到path
+void AppendSegment(std::string &path, const std::string &key)
+{
+    path += '/';
+    for (const char ch : key)
+    {
+        if (ch == '~')
+        {
+            path += "~0";
+        }
+        else if (ch == '/')
+        {
+            path += "~1";
+        }
+        else
+        {
+            path += ch;
+        }
+    }
+}
+
+class Differ
+{
+  public:
+    JsonValue TakePatch() noexcept
+    {
+        return JsonValue(std::move(patch_));
+    }
+
+    void Compare(const JsonValue &source, const JsonValue &target)
+    {
+        if (Same(source, target))
+        {
+            return;
+        }
+
+        if (source.GetType() == JsonType::Object && target.GetType() == JsonType::Object)
+        {
+            CompareObject(source.GetVal<JsonType::Object>(), target.GetVal<JsonType::Object>());
+        }
+        else if (source.GetType() == JsonType::Array && target.GetType() == JsonType::Array)
+        {
+            CompareArray(source.GetVal<JsonType::Array>(), target.GetVal<JsonType::Array>());
+        }
+        else
+        {
+            Emit("replace", &target);
+        }
+    }
+
+  private:
+    // 编辑脚本中的一步，Keep同时消耗两边，Delete只消耗source，Insert只消耗target
+    enum class Edit : uint8_t
+    {
+        Keep,
+        Delete,
+        Insert
+    };
+
+    SubtreeHasher hasher_;
+    std::string path_;
+    std::vector<JsonValue> patch_;
+
+    void Emit(const char *op, const JsonValue *value)
+    {
+        std::unordered_map<std::string, JsonValue> operation{{"op", JsonValue(op)}, {"path", JsonValue(path_)}};
+        if (value != nullptr)
+        {
+            operation.emplace("value", *value);
+        }
+        patch_.emplace_back(std::move(operation));
+    }
+
+    void CompareObject(const std::unordered_map<std::string, JsonValue> &source,
+                       const std::unordered_map<std::string, JsonValue> &target)
+    {
+        const size_t length = path_.size();
+        for (const auto &[key, value] : source)
+        {
+            AppendSegment(path_, key);
+            if (const auto iter = target.find(key); iter == target.end())
+            {
+                Emit("remove", nullptr);
+            }
+            else
+            {
+                Compare(value, iter->second);
+            }
+            path_.resize(length);
+        }
+        for (const auto &[key, value] : target)
+        {
+            if (source.find(key) == source.end())
+            {
+                AppendSegment(path_, key);
+                Emit("add", &value);
+                path_.resize(length);
+            }
+        }
+    }
+
+    // 哈希值只用来快速排除不相等的子树，哈希值相同时仍要逐个比较，碰撞的子树不能当作没有变化
+    bool Same(const JsonValue &lhs, const JsonValue &rhs)
+    {
+        return hasher_.Hash(lhs) == hasher_.Hash(rhs) && lhs == rhs;
+    }
+
+    void CompareArray(const std::vector<JsonValue> &source, const std::vector<JsonValue> &target)
+    {
+        // 去掉相同的前缀和后缀，常见的追加、删除和局部修改只剩下很短的中间部分
+        size_t prefix = 0;
+        while (prefix < source.size() && prefix < target.size() && Same(source[prefix], target[prefix]))
+        {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while (suffix < source.size() - prefix && suffix < target.size() - prefix &&
+               Same(source[source.size() - 1 - suffix], target[target.size() - 1 - suffix]))
+        {
+            ++suffix;
+        }
+
+        std::vector<Edit> script;
+        if (!ShortestEdit(source, target, prefix, suffix, script))
+        {
+            // 差异太大，全部作为一段连续的删除和插入，输出时按位置逐个比较
+            script.assign(source.size() - prefix - suffix, Edit::Delete);
+            script.insert(script.end(), target.size() - prefix - suffix, Edit::Insert);
+        }
+        EmitScript(source, target, prefix, script);
+    }
+
+    // Myers差分算法，在哈希值序列上求最短编辑脚本，复杂度与编辑距离成正比
+    bool ShortestEdit(const std::vector<JsonValue> &source, const std::vector<JsonValue> &target, const size_t prefix,
+                      const size_t suffix, std::vector<Edit> &script)
+    {
+        const auto n = static_cast<long long>(source.size() - prefix - suffix);
+        const auto m = static_cast<long long>(target.size() - prefix - suffix);
+        const auto max_d = std::min(n + m, static_cast<long long>(MAX_EDIT_DISTANCE));
+        const auto same = [&](const long long x, const long long y) {
+            return Same(source[prefix + static_cast<size_t>(x)], target[prefix + static_cast<size_t>(y)]);
+        };
+
+        // v[k + offset]为对角线k上能到达的最远x，trace[d]保存第d轮后对角线-d到d上的值用于回溯
+        const long long offset = max_d + 1;
+        std::vector<long long> v(static_cast<size_t>(2 * max_d + 3), 0);
+        std::vector<std::vector<long long>> trace;
+        long long found = -1;
+        for (long long d = 0; d <= max_d && found < 0; ++d)
+        {
+            for (long long k = -d; k <= d; k += 2)
+            {
+                long long x = (k == -d || (k != d && v[k - 1 + offset] < v[k + 1 + offset])) ? v[k + 1 + offset]
+                                                                                             : v[k - 1 + offset] + 1;
+                long long y = x - k;
+                while (x < n && y < m && same(x, y))
+                {
+                    ++x;
+                    ++y;
+                }
+                v[k + offset] = x;
+                if (x >= n && y >= m)
+                {
+                    found = d;
+                    break;
+                }
+            }
+            trace.emplace_back(v.begin() + (offset - d), v.begin() + (offset + d + 1));
+        }
+        if (found < 0)
+        {
+            return false;
+        }
+
+        // 从终点沿着保存的路径倒推，得到倒序的编辑脚本
+        long long x = n;
+        long long y = m;
+        for (long long d = found; d > 0; --d)
+        {
+            const std::vector<long long> &prev = trace[static_cast<size_t>(d - 1)];
+            const auto at = [&](const long long k) { return prev[static_cast<size_t>(k + d - 1)]; };
+            const long long k = x - y;
+            const long long prev_k = (k == -d || (k != d && at(k - 1) < at(k + 1))) ? k + 1 : k - 1;
+            const long long prev_x = at(prev_k);
+            const long long prev_y = prev_x - prev_k;
+            while (x > prev_x && y > prev_y)
+            {
+                script.push_back(Edit::Keep);
+                --x;
+                --y;
+            }
+            script.push_back(prev_k == k + 1 ? Edit::Insert : Edit::Delete);
+            x = prev_x;
+            y = prev_y;
+        }
+        script.insert(script.end(), static_cast<size_t>(x), Edit::Keep);
+        std::reverse(script.begin(), script.end());
+        return true;
+    }
+
+    // 两个Keep之间连续的删除和插入两两配对，配对的元素递归比较，其余的转换为remove和add
+    void EmitScript(const std::vector<JsonValue> &source, const std::vector<JsonValue> &target, const size_t prefix,
+                    const std::vector<Edit> &script)
+    {
+        const size_t length = path_.size();
+        size_t index = prefix; // 当前元素在修改过程中的数组里的下标
+        size_t src = prefix;
+        size_t dst = prefix;
+        for (size_t i = 0; i < script.size();)
+        {
+            if (script[i] == Edit::Keep)
+            {
+                ++index;
+                ++src;
+                ++dst;
+                ++i;
+                continue;
+            }
+
+            size_t deletes = 0;
+            size_t inserts = 0;
+            for (; i < script.size() && script[i] != Edit::Keep; ++i)
+            {
+                ++(script[i] == Edit::Delete ? deletes : inserts);
+            }
+
+            const size_t pairs = std::min(deletes, inserts);
+            for (size_t j = 0; j < pairs; ++j, ++index)
+            {
+                AppendSegment(path_, std::to_string(index));
+                Compare(source[src + j], target[dst + j]);
+                path_.resize(length);
+            }
+            for (size_t j = pairs; j < deletes; ++j)
+            {
+                AppendSegment(path_, std::to_string(index));
+                Emit("remove", nullptr);
+                path_.resize(length);
+            }
+            for (size_t j = pairs; j < inserts; ++j, ++index)
+            {
+                AppendSegment(path_, std::to_string(index));
+                Emit("add", &target[dst + j]);
+                path_.resize(length);
+            }
+            src += deletes;
+            dst += inserts;
+        }
+    }
+};
+
+} // namespace
+
+JsonValue Diff(const JsonValue &source, const JsonValue &target)
+{
+    Differ differ;
+    differ.Compare(source, target);
+    return differ.TakePatch();
+}
+} // namespace simple_json
@@ -0,0 +1,412 @@
+#include "json_editor.h"
+#include "config.h"
+#include "sax.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace simple_json
+{
+JsonEditor JsonEditor::FromFile(const std::filesystem::path &file_path)
+{
+    if (file_path.empty())
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(INVALID_PATH));
+    }
+    if (!file_path.has_extension() || file_path.extension() != ".json")
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(INVALID_FILE));
+    }
+
+    // 按字节读取，保留原始的换行符，未修改时写回的内容与原文件完全一致
+    std::ifstream fs(file_path, std::ios::in | std::ios::binary);
+    if (!fs.is_open())
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    std::string json_str{std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>()};
+    return JsonEditor(std::move(json_str));
+}
+
+void JsonEditor::Set(const JsonPointer &pointer, JsonValue value)
+{
+    const auto &segments = pointer.Segments();
+    if (segments.empty())
+    {
+        value_ = std::move(value);
+        spans_[0].replaced_ = true;
+        return;
+    }
+
+    // 同时沿着json值和源文本位置向下查找父节点，位置信息只在未被整体替换的部分有效
+    JsonValue *parent = &value_;
+    size_t span = 0;
+    bool tracking = true;
+    std::vector<size_t> path{0};
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        parent = JsonPointer::Step(*parent, segments[i]);
+        if (parent == nullptr)
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+        }
+        if (tracking)
+        {
+            const size_t child = spans_[span].replaced_ ? NO_SPAN : FindChild(spans_[span], segments[i]);
+            tracking = child != NO_SPAN;
+            if (tracking)
+            {
+                span = child;
+                path.push_back(child);
+            }
+        }
+    }
+    tracking = tracking && !spans_[span].replaced_;
+
+    const PointerSegment &last = segments.back();
+    if (parent->GetType() == JsonType::Object)
+    {
+        auto &object = parent->GetVal<JsonType::Object>();
+        const bool exists = object.find(last.key_) != object.end();
+        object[last.key_] = std::move(value);
+        if (tracking)
+        {
+            if (const size_t child = FindChild(spans_[span], last); child != NO_SPAN)
+            {
+                spans_[child].replaced_ = true;
+            }
+            else if (!exists)
+            {
+                spans_[span].inserted_.push_back(last.key_);
+            }
+        }
+    }
+    else if (parent->GetType() == JsonType::Array)
+    {
+        auto &array = parent->GetVal<JsonType::Array>();
+        const size_t index = last.key_ == "-" ? array.size() : last.index_;
+        if (index < array.size())
+        {
+            array[index] = std::move(value);
+            if (const size_t child = tracking ? FindChild(spans_[span], last) : NO_SPAN; child != NO_SPAN)
+            {
+                spans_[child].replaced_ = true;
+            }
+        }
+        else if (index == array.size())
+        {
+            array.push_back(std::move(value)); // 追加的元素在写出时直接从json值中序列化
+        }
+        else
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+        }
+    }
+    else
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+    }
+
+    for (const size_t index : path)
+    {
+        spans_[index].dirty_ = true;
+    }
+}
+
+void JsonEditor::Remove(const JsonPointer &pointer)
+{
+    const auto &segments = pointer.Segments();
+    if (segments.empty())
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+    }
+
+    JsonValue *parent = &value_;
+    size_t span = 0;
+    bool tracking = true;
+    std::vector<size_t> path{0};
+    for (size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+        parent = JsonPointer::Step(*parent, segments[i]);
+        if (parent == nullptr)
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+        }
+        if (tracking)
+        {
+            const size_t child = spans_[span].replaced_ ? NO_SPAN : FindChild(spans_[span], segments[i]);
+            tracking = child != NO_SPAN;
+            if (tracking)
+            {
+                span = child;
+                path.push_back(child);
+            }
+        }
+    }
+    tracking = tracking && !spans_[span].replaced_;
+
+    const PointerSegment &last = segments.back();
+    if (JsonPointer::Step(*parent, last) == nullptr)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+    }
+
+    if (parent->GetType() == JsonType::Object)
+    {
+        parent->GetVal<JsonType::Object>().erase(last.key_);
+        if (tracking)
+        {
+            // 重复的键全部删除，新增的成员直接从新增列表中去掉
+            for (const size_t child : spans_[span].children_)
+            {
+                if (spans_[child].key_ == last.key_)
+                {
+                    spans_[child].removed_ = true;
+                }
+            }
+            auto &inserted = spans_[span].inserted_;
+            inserted.erase(std::remove(inserted.begin(), inserted.end(), last.key_), inserted.end());
+        }
+    }
+    else
+    {
+        auto &array = parent->GetVal<JsonType::Array>();
+        if (const size_t child = tracking ? FindChild(spans_[span], last) : NO_SPAN; child != NO_SPAN)
+        {
+            spans_[child].removed_ = true;
+        }
+        array.erase(array.begin() + static_cast<std::ptrdiff_t>(last.index_));
+    }
+
+    for (const size_t index : path)
+    {
+        spans_[index].dirty_ = true;
+    }
+}
+
+std::string JsonEditor::ToString() const
+{
+    const std::string &source = json_data_.source_;
+    std::string out;
+    out.reserve(source.size());
+    out.append(source, 0, spans_[0].begin_);
+    Write(out, 0, value_);
+    out.append(source, spans_[0].end_, std::string::npos);
+    return out;
+}
+
+void JsonEditor::Save(const std::filesystem::path &file_path) const
+{
+    std::ofstream fs(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fs.is_open())
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    const std::string json_str = ToString();
+    fs.write(json_str.data(), static_cast<std::streamsize>(json_str.size()));
+}
+
+void JsonEditor::Load()
+{
+    // 先完整解析一遍，保证后面记录位置时token流的结构是合法的
+    SaxReader sax_reader(json_data_);
+    JsonBuilder builder;
+    if (!sax_reader.Parse(builder))
+    {
+        sax_reader.ThrowError();
+    }
+    value_ = builder.TakeValue();
+
+    TokenReader reader(json_data_);
+    BuildSpan(reader, Offset(reader.Current()));
+}
+
+size_t JsonEditor::BuildSpan(TokenReader &reader, const size_t item_begin)
+{
+    // 递归过程中spans_会扩容，只能通过下标访问当前节点
+    const size_t index = spans_.size();
+    const Token *token = reader.Current();
+    spans_.push_back(Span{item_begin, Offset(token), 0, {}, {}, {}});
+
+    if (token->type_ == TokenType::LBRACE || token->type_ == TokenType::LBRACKET)
+    {
+        const bool is_object = token->type_ == TokenType::LBRACE;
+        spans_[index].is_object_ = is_object;
+        const TokenType close = is_object ? TokenType::RBRACE : TokenType::RBRACKET;
+        reader.Advance();
+        while (reader.Current()->type_ != close)
+        {
+            size_t child = 0;
+            if (is_object)
+            {
+                const Token *key = reader.Current();
+                reader.Advance();
+                reader.Advance();
+                child = BuildSpan(reader, Offset(key));
+                spans_[child].key_ = key->raw_value_;
+            }
+            else
+            {
+                child = BuildSpan(reader, Offset(reader.Current()));
+            }
+            spans_[index].children_.push_back(child);
+
+            // 逗号之后允许紧跟右括号，是否合法已经在解析时检查过
+            if (reader.Advance()->type_ == TokenType::COMMA)
+            {
+                reader.Advance();
+            }
+        }
+    }
+
+    spans_[index].end_ = Offset(reader.Current()) + reader.Current()->len_;
+    return index;
+}
+
+size_t JsonEditor::Offset(const Token *token) const
+{
+    return json_data_.lines_index_.at(token->row_).first + token->col_;
+}
+
+size_t JsonEditor::FindChild(const Span &span, const PointerSegment &segment) const noexcept
+{
+    if (!span.is_object_)
+    {
+        // 数组元素，第index个未删除的元素
+        size_t live = 0;
+        for (const size_t child : span.children_)
+        {
+            if (!spans_[child].removed_ && live++ == segment.index_)
+            {
+                return child;
+            }
+        }
+        return NO_SPAN;
+    }
+
+    // 对象成员，与解析时一致，重复的键以最后一个为准
+    for (auto iter = span.children_.rbegin(); iter != span.children_.rend(); ++iter)
+    {
+        if (!spans_[*iter].removed_ && spans_[*iter].key_ == segment.key_)
+        {
+            return *iter;
+        }
+    }
+    return NO_SPAN;
+}
+
+void JsonEditor::Write(std::string &out, const size_t span_index, const JsonValue &value) const
+{
+    const std::string &source = json_data_.source_;
+    const Span &span = spans_[span_index];
+    if (span.replaced_ || (span.dirty_ && value.GetType() != JsonType::Object && value.GetType() != JsonType::Array))
+    {
+        AppendJson(out, value);
+        return;
+    }
+    if (!span.dirty_)
+    {
+        out.append(source, span.begin_, span.end_ - span.begin_);
+        return;
+    }
+
+    // 左括号到第一个成员之间、最后一个成员到右括号之间的文本原样保留
+    const bool is_object = value.GetType() == JsonType::Object;
+    const size_t head_end = span.children_.empty() ? span.end_ - 1 : spans_[span.children_.front()].item_begin_;
+    const size_t tail_begin = span.children_.empty() ? span.end_ - 1 : spans_[span.children_.back()].end_;
+    out.append(source, span.begin_, head_end - span.begin_);
+
+    bool any = false;
+    size_t live_index = 0;
+    for (size_t i = 0; i < span.children_.size(); ++i)
+    {
+        const Span &child = spans_[span.children_[i]];
+        if (child.removed_)
+        {
+            continue;
+        }
+
+        const JsonValue *child_value = nullptr;
+        if (is_object)
+        {
+            const auto &object = value.GetVal<JsonType::Object>();
+            const auto iter = object.find(child.key_);
+            child_value = iter == object.end() ? nullptr : &iter->second;
+        }
+        else if (live_index < value.GetVal<JsonType::Array>().size())
+        {
+            child_value = &value.GetVal<JsonType::Array>()[live_index++];
+        }
+        if (child_value == nullptr)
+        {
+            continue;
+        }
+
+        // 沿用该成员在源文本中前面的分隔符
+        if (any)
+        {
+            const size_t sep_begin = spans_[span.children_[i - 1]].end_;
+            out.append(source, sep_begin, child.item_begin_ - sep_begin);
+        }
+        out.append(source, child.item_begin_, child.begin_ - child.item_begin_);
+        Write(out, span.children_[i], *child_value);
+        any = true;
+    }
+
+    // 新增的成员使用源文本中第一个分隔符的风格
+    std::string separator = ",";
+    std::string colon = ":";
+    if (span.children_.size() >= 2)
+    {
+        const size_t sep_begin = spans_[span.children_[0]].end_;
+        separator = source.substr(sep_begin, spans_[span.children_[1]].item_begin_ - sep_begin);
+    }
+    if (is_object && !span.children_.empty())
+    {
+        const Span &first = spans_[span.children_.front()];
+        const std::string key_text = source.substr(first.item_begin_, first.begin_ - first.item_begin_);
+        colon = key_text.substr(key_text.rfind('"') + 1);
+    }
+
+    if (is_object)
+    {
+        const auto &object = value.GetVal<JsonType::Object>();
+        for (const std::string &key : span.inserted_)
+        {
+            const auto iter = object.find(key);
+            if (iter == object.end())
+            {
+                continue;
+            }
+            if (any)
+            {
+                out.append(separator);
+            }
+            AppendEscaped(out, key);
+            out.append(colon);
+            AppendJson(out, iter->second);
+            any = true;
+        }
+    }
+    else
+    {
+        const auto &array = value.GetVal<JsonType::Array>();
+        for (; live_index < array.size(); ++live_index)
+        {
+            if (any)
+            {
+                out.append(separator);
+            }
+            AppendJson(out, array[live_index]);
+            any = true;
+        }
+    }
+
+    out.append(source, tail_begin, span.end_ - tail_begin);
+}
+} // namespace simple_json
@@ -0,0 +1,466 @@
+#include "json_patch.h"
+#include "config.h"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+// 回滚日志中的一项，按相反的顺序执行即可恢复到patch应用之前的状态
+struct UndoEntry
+{
+    enum class Kind : uint8_t
+    {
+        Erase,   // 删除pointer处的值，被删除的值暂存起来供下一项Insert使用
+        Insert,  // 在pointer处插入值
+        Restore, // 把pointer处的值恢复为旧值，被替换掉的值同样暂存起来
+    };
+
+    Kind kind_;
+    const JsonPointer *pointer_;
+    size_t index_;            // 数组下标，已经把"-"换算成实际位置
+    JsonValue value_;         // Insert和Restore使用的值
+    bool use_carry_ = false;  // Insert使用上一项Erase或Restore暂存的值，用于撤销move而不复制
+};
+
+[[noreturn]] void ThrowPatchFailed(const size_t op_index, const std::string &detail)
+{
+    SIMPLE_JSON_THROW(
+        std::runtime_error(ERR_PATCH_FAILED + std::string("operation ") + std::to_string(op_index) + ", " + detail));
+}
+
+JsonValue *ResolveParent(JsonValue &root, const JsonPointer &pointer) noexcept
+{
+    const auto &segments = pointer.Segments();
+    JsonValue *cur = &root;
+    for (size_t i = 0; i + 1 < segments.size() && cur != nullptr; ++i)
+    {
+        cur = JsonPointer::Step(*cur, segments[i]);
+    }
+    return cur;
+}
+
+// 在目标上执行单个操作，每一步修改都记录到回滚日志中，失败时抛出异常由调用者回滚
+class PatchExecutor
+{
+  public:
+    explicit PatchExecutor(JsonValue &target) noexcept : target_(target)
+    {
+    }
+
+    // 失败时返回错误描述，成功时返回空字符串
+    std::string Add(const JsonPointer &path, JsonValue &&value)
+    {
+        if (path.Segments().empty())
+        {
+            undo_.push_back({UndoEntry::Kind::Restore, &path, 0, std::move(target_)});
+            target_ = std::move(value);
+            return {};
+        }
+
+        JsonValue *parent = ResolveParent(target_, path);
+        const PointerSegment &last = path.Segments().back();
+        if (parent != nullptr && parent->GetType() == JsonType::Object)
+        {
+            auto &object = parent->GetVal<JsonType::Object>();
+            if (const auto iter = object.find(last.key_); iter != object.end())
+            {
+                undo_.push_back({UndoEntry::Kind::Restore, &path, 0, std::move(iter->second)});
+                iter->second = std::move(value);
+            }
+            else
+            {
+                object.emplace(last.key_, std::move(value));
+                undo_.push_back({UndoEntry::Kind::Erase, &path, 0, JsonValue()});
+            }
+            return {};
+        }
+        if (parent != nullptr && parent->GetType() == JsonType::Array)
+        {
+            auto &array = parent->GetVal<JsonType::Array>();
+            const size_t index = last.key_ == "-" ? array.size() : last.index_;
+            if (index > array.size())
+            {
+                return "array index out of range at " + path.ToString();
+            }
+            array.insert(array.begin() + static_cast<std::ptrdiff_t>(index), std::move(value));
+            undo_.push_back({UndoEntry::Kind::Erase, &path, index, JsonValue()});
+            return {};
+        }
+        return "no container at " + path.ToString();
+    }
+
+    // 删除pointer处的值并通过removed返回，carry_for_undo为true时撤销会使用后一项Erase或Restore暂存的值，
+    // 没有这一项时需要调用KeepRemoved
+    std::string Remove(const JsonPointer &path, JsonValue &removed, const bool carry_for_undo)
+    {
+        JsonValue *parent = path.Segments().empty() ? nullptr : ResolveParent(target_, path);
+        const JsonValue *slot = parent == nullptr ? nullptr : JsonPointer::Step(*parent, path.Segments().back());
+        if (slot == nullptr)
+        {
+            return "no value at " + path.ToString();
+        }
+
+        const PointerSegment &last = path.Segments().back();
+        size_t index = 0;
+        if (parent->GetType() == JsonType::Object)
+        {
+            auto &object = parent->GetVal<JsonType::Object>();
+            const auto iter = object.find(last.key_);
+            removed = std::move(iter->second);
+            object.erase(iter);
+        }
+        else
+        {
+            auto &array = parent->GetVal<JsonType::Array>();
+            index = last.index_;
+            removed = std::move(array[index]);
+            array.erase(array.begin() + static_cast<std::ptrdiff_t>(index));
+        }
+
+        undo_.push_back({UndoEntry::Kind::Insert, &path, index, JsonValue(), carry_for_undo});
+        return {};
+    }
+
+    // remove操作或者插入失败的move操作，被删除的值直接移动到回滚日志中
+    void KeepRemoved(JsonValue &&removed)
+    {
+        undo_.back().value_ = std::move(removed);
+        undo_.back().use_carry_ = false;
+    }
+
+    std::string Replace(const JsonPointer &path, JsonValue &&value)
+    {
+        JsonValue *slot = path.Resolve(target_);
+        if (slot == nullptr)
+        {
+            return "no value at " + path.ToString();
+        }
+
+        size_t index = 0;
+        if (!path.Segments().empty())
+        {
+            index = path.Segments().back().index_;
+        }
+        undo_.push_back({UndoEntry::Kind::Restore, &path, index, std::move(*slot)});
+        *slot = std::move(value);
+        return {};
+    }
+
+    // 按相反的顺序撤销所有修改
+    void Rollback() noexcept
+    {
+        JsonValue carry;
+        for (auto iter = undo_.rbegin(); iter != undo_.rend(); ++iter)
+        {
+            UndoEntry &entry = *iter;
+            const auto &segments = entry.pointer_->Segments();
+            if (segments.empty())
+            {
+                carry = std::move(target_);
+                target_ = std::move(entry.value_);
+                continue;
+            }
+
+            JsonValue *parent = ResolveParent(target_, *entry.pointer_);
+            const PointerSegment &last = segments.back();
+            if (parent->GetType() == JsonType::Object)
+            {
+                auto &object = parent->GetVal<JsonType::Object>();
+                switch (entry.kind_)
+                {
+                case UndoEntry::Kind::Erase:
+                    carry = std::move(object[last.key_]);
+                    object.erase(last.key_);
+                    break;
+                case UndoEntry::Kind::Insert:
+                    object[last.key_] = entry.use_carry_ ? std::move(carry) : std::move(entry.value_);
+                    break;
+                case UndoEntry::Kind::Restore: {
+                    JsonValue &slot = object[last.key_];
+                    carry = std::move(slot);
+                    slot = std::move(entry.value_);
+                    break;
+                }
+                }
+            }
+            else
+            {
+                auto &array = parent->GetVal<JsonType::Array>();
+                const auto pos = array.begin() + static_cast<std::ptrdiff_t>(entry.index_);
+                switch (entry.kind_)
+                {
+                case UndoEntry::Kind::Erase:
+                    carry = std::move(*pos);
+                    array.erase(pos);
+                    break;
+                case UndoEntry::Kind::Insert:
+                    array.insert(pos, entry.use_carry_ ? std::move(carry) : std::move(entry.value_));
+                    break;
+                case UndoEntry::Kind::Restore:
+                    carry = std::move(*pos);
+                    *pos = std::move(entry.value_);
+                    break;
+                }
+            }
+        }
+        undo_.clear();
+    }
+
+  private:
+    JsonValue &target_;
+    std::vector<UndoEntry> undo_;
+};
+
+// prefix与pointer相同时同样返回true
+bool IsPrefix(const JsonPointer &prefix, const JsonPointer &pointer) noexcept
+{
+    const auto &lhs = prefix.Segments();
+    const auto &rhs = pointer.Segments();
+    if (lhs.size() > rhs.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (lhs[i].key_ != rhs[i].key_)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string &RequireString(const std::unordered_map<std::string, JsonValue> &op, const std::string &member,
+                                 const size_t op_index)
+{
+    const auto iter = op.find(member);
+    if (iter == op.end() || iter->second.GetType() != JsonType::String)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_PATCH + std::string("operation ") +
+                                                std::to_string(op_index) + " needs a string \"" + member + "\""));
+    }
+    return iter->second.GetVal<JsonType::String>();
+}
+
+} // namespace
+
+JsonPatch JsonPatch::Compile(const JsonValue &patch)
+{
+    if (patch.GetType() != JsonType::Array)
+    {
+        SIMPLE_JSON_THROW(
+            std::invalid_argument(ERR_INVALID_PATCH + std::string("a patch must be an array of operations")));
+    }
+
+    static const std::unordered_map<std::string, Operation::Op> OP_NAMES{
+        {"add", Operation::Op::Add},   {"remove", Operation::Op::Remove}, {"replace", Operation::Op::Replace},
+        {"move", Operation::Op::Move}, {"copy", Operation::Op::Copy},     {"test", Operation::Op::Test}};
+
+    JsonPatch compiled;
+    const auto &operations = patch.GetVal<JsonType::Array>();
+    compiled.operations_.reserve(operations.size());
+    for (size_t i = 0; i < operations.size(); ++i)
+    {
+        if (operations[i].GetType() != JsonType::Object)
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_PATCH + std::string("operation ") + std::to_string(i) +
+                                                    " is not an object"));
+        }
+        const auto &op = operations[i].GetVal<JsonType::Object>();
+
+        const std::string &name = RequireString(op, "op", i);
+        const auto op_name = OP_NAMES.find(name);
+        if (op_name == OP_NAMES.end())
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_PATCH + std::string("unknown op \"") + name + "\""));
+        }
+
+        Operation operation{op_name->second, JsonPointer(RequireString(op, "path", i)), JsonPointer(), JsonValue()};
+        switch (operation.op_)
+        {
+        case Operation::Op::Add:
+        case Operation::Op::Replace:
+        case Operation::Op::Test: {
+            const auto value = op.find("value");
+            if (value == op.end())
+            {
+                SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_PATCH + std::string("operation ") +
+                                                        std::to_string(i) + " needs a \"value\""));
+            }
+            operation.value_ = value->second;
+            break;
+        }
+        case Operation::Op::Move:
+        case Operation::Op::Copy:
+            operation.from_ = JsonPointer(RequireString(op, "from", i));
+            break;
+        case Operation::Op::Remove:
+            break;
+        }
+        compiled.operations_.push_back(std::move(operation));
+    }
+    return compiled;
+}
+
+void JsonPatch::Apply(JsonValue &target) const &
+{
+    ApplyImpl(operations_, target);
+}
+
+void JsonPatch::Apply(JsonValue &target) &&
+{
+    ApplyImpl(operations_, target);
+}
+
+template <typename Operations> void JsonPatch::ApplyImpl(Operations &operations, JsonValue &target)
+{
+    constexpr bool MOVE_VALUES = !std::is_const_v<Operations>;
+    const auto take_value = [](auto &operation) -> JsonValue {
+        if constexpr (MOVE_VALUES)
+        {
+            return std::move(operation.value_);
+        }
+        else
+        {
+            return operation.value_;
+        }
+    };
+
+    PatchExecutor executor(target);
+    for (size_t i = 0; i < operations.size(); ++i)
+    {
+        auto &operation = operations[i];
+        std::string err_desc;
+        switch (operation.op_)
+        {
+        case Operation::Op::Add:
+            err_desc = executor.Add(operation.path_, take_value(operation));
+            break;
+        case Operation::Op::Remove: {
+            JsonValue removed;
+            err_desc = executor.Remove(operation.path_, removed, false);
+            if (err_desc.empty())
+            {
+                executor.KeepRemoved(std::move(removed));
+            }
+            break;
+        }
+        case Operation::Op::Replace:
+            err_desc = executor.Replace(operation.path_, take_value(operation));
+            break;
+        case Operation::Op::Move: {
+            if (IsPrefix(operation.from_, operation.path_))
+            {
+                // 移动到自身什么也不做，移动到自己的子节点是非法的
+                if (operation.from_.Segments().size() != operation.path_.Segments().size())
+                {
+                    err_desc = "cannot move a value into one of its children";
+                }
+                else if (operation.from_.Resolve(target) == nullptr)
+                {
+                    err_desc = "no value at " + operation.from_.ToString();
+                }
+                break;
+            }
+            // 直接移动子树，撤销时再移动回来，全程不复制
+            JsonValue moved;
+            err_desc = executor.Remove(operation.from_, moved, true);
+            if (err_desc.empty())
+            {
+                err_desc = executor.Add(operation.path_, std::move(moved));
+                if (!err_desc.empty())
+                {
+                    // 插入失败时值没有被移走，回滚日志中也没有能交还它的那一项
+                    executor.KeepRemoved(std::move(moved));
+                }
+            }
+            break;
+        }
+        case Operation::Op::Copy: {
+            const JsonValue *source = operation.from_.Resolve(target);
+            if (source == nullptr)
+            {
+                err_desc = "no value at " + operation.from_.ToString();
+                break;
+            }
+            err_desc = executor.Add(operation.path_, JsonValue(*source));
+            break;
+        }
+        case Operation::Op::Test: {
+            const JsonValue *actual = operation.path_.Resolve(target);
+            if (actual == nullptr || *actual != operation.value_)
+            {
+                err_desc = "test failed at " + operation.path_.ToString();
+            }
+            break;
+        }
+        }
+
+        if (!err_desc.empty())
+        {
+            executor.Rollback();
+            ThrowPatchFailed(i, err_desc);
+        }
+    }
+}
+
+void ApplyMergePatch(JsonValue &target, const JsonValue &patch)
+{
+    if (patch.GetType() != JsonType::Object)
+    {
+        target = patch;
+        return;
+    }
+    if (target.GetType() != JsonType::Object)
+    {
+        target = std::unordered_map<std::string, JsonValue>{};
+    }
+
+    auto &object = target.GetVal<JsonType::Object>();
+    for (const auto &[key, value] : patch.GetVal<JsonType::Object>())
+    {
+        if (value.GetType() == JsonType::Null)
+        {
+            object.erase(key);
+        }
+        else
+        {
+            ApplyMergePatch(object[key], value);
+        }
+    }
+}
+
+void ApplyMergePatch(JsonValue &target, JsonValue &&patch)
+{
+    if (patch.GetType() != JsonType::Object)
+    {
+        target = std::move(patch);
+        return;
+    }
+    if (target.GetType() != JsonType::Object)
+    {
+        target = std::unordered_map<std::string, JsonValue>{};
+    }
+
+    auto &object = target.GetVal<JsonType::Object>();
+    for (auto &[key, value] : patch.GetVal<JsonType::Object>())
+    {
+        if (value.GetType() == JsonType::Null)
+        {
+            object.erase(key);
+        }
+        else
+        {
+            ApplyMergePatch(object[key], std::move(value));
+        }
+    }
+}
+} // namespace simple_json
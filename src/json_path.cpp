@@ -0,0 +1,641 @@
+#include "json_path.h"
+#include "config.h"
+#include "sax.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+constexpr size_t MAX_PATH_STEPS = 63; // 自动机的状态集合用一个uint64_t表示，最后一位是接受状态
+
+// 把JSONPath表达式编译成步骤序列
+class PathCompiler
+{
+  public:
+    explicit PathCompiler(const std::string_view path) noexcept : path_(path)
+    {
+    }
+
+    std::vector<PathStep> Compile()
+    {
+        SkipSpace();
+        Expect('$');
+        while (pos_ < path_.size())
+        {
+            if (Eat('.'))
+            {
+                const bool recursive = Eat('.');
+                if (recursive && Peek() == '[')
+                {
+                    ParseBracket(true);
+                }
+                else if (Eat('*'))
+                {
+                    PathStep step;
+                    step.recursive_ = recursive;
+                    steps_.push_back(std::move(step));
+                }
+                else
+                {
+                    PathStep step;
+                    step.kind_ = PathStep::Kind::Name;
+                    step.recursive_ = recursive;
+                    step.names_.push_back(ReadName());
+                    steps_.push_back(std::move(step));
+                }
+            }
+            else if (Peek() == '[')
+            {
+                ParseBracket(false);
+            }
+            else if (Peek() == ' ' || Peek() == '\t')
+            {
+                SkipSpace();
+            }
+            else
+            {
+                Fail();
+            }
+        }
+
+        if (steps_.size() > MAX_PATH_STEPS)
+        {
+            Fail();
+        }
+        return std::move(steps_);
+    }
+
+  private:
+    std::string_view path_;
+    size_t pos_ = 0;
+    std::vector<PathStep> steps_;
+
+    [[noreturn]] void Fail() const
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_JSON_PATH + std::string(path_)));
+    }
+
+    [[nodiscard]] char Peek() const noexcept
+    {
+        return pos_ < path_.size() ? path_[pos_] : '\0';
+    }
+
+    bool Eat(const char ch) noexcept
+    {
+        if (Peek() == ch)
+        {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void Expect(const char ch)
+    {
+        if (!Eat(ch))
+        {
+            Fail();
+        }
+    }
+
+    void SkipSpace() noexcept
+    {
+        while (Peek() == ' ' || Peek() == '\t')
+        {
+            ++pos_;
+        }
+    }
+
+    // .name形式的键，遇到下一个 . 或 [ 为止
+    std::string ReadName()
+    {
+        const size_t begin = pos_;
+        while (pos_ < path_.size() && path_[pos_] != '.' && path_[pos_] != '[' && path_[pos_] != ' ' &&
+               path_[pos_] != ')' && path_[pos_] != '=' && path_[pos_] != '!' && path_[pos_] != '<' &&
+               path_[pos_] != '>' && path_[pos_] != ']')
+        {
+            ++pos_;
+        }
+        if (pos_ == begin)
+        {
+            Fail();
+        }
+        return std::string(path_.substr(begin, pos_ - begin));
+    }
+
+    // 单引号或双引号包围的字符串，反斜杠转义下一个字符
+    std::string ReadQuoted()
+    {
+        const char quote = Peek();
+        ++pos_;
+        std::string str;
+        while (pos_ < path_.size() && path_[pos_] != quote)
+        {
+            if (path_[pos_] == '\\' && pos_ + 1 < path_.size())
+            {
+                ++pos_;
+            }
+            str += path_[pos_++];
+        }
+        Expect(quote);
+        return str;
+    }
+
+    size_t ReadIndex()
+    {
+        if (Peek() == '-')
+        {
+            Fail(); // 流式处理时不知道数组长度，不支持负数下标
+        }
+        size_t index = 0;
+        const auto [end, ec] = std::from_chars(path_.data() + pos_, path_.data() + path_.size(), index);
+        if (ec != std::errc())
+        {
+            Fail();
+        }
+        pos_ = static_cast<size_t>(end - path_.data());
+        return index;
+    }
+
+    void ParseBracket(const bool recursive)
+    {
+        Expect('[');
+        SkipSpace();
+
+        PathStep step;
+        step.recursive_ = recursive;
+        if (Eat('*'))
+        {
+            step.kind_ = PathStep::Kind::Wildcard;
+        }
+        else if (Eat('?'))
+        {
+            step.kind_ = PathStep::Kind::Filter;
+            step.filter_ = ParseFilter();
+        }
+        else if (Peek() == '\'' || Peek() == '"')
+        {
+            step.kind_ = PathStep::Kind::Name;
+            do
+            {
+                SkipSpace();
+                if (Peek() != '\'' && Peek() != '"')
+                {
+                    Fail();
+                }
+                step.names_.push_back(ReadQuoted());
+                SkipSpace();
+            } while (Eat(','));
+        }
+        else
+        {
+            step.kind_ = PathStep::Kind::Index;
+            if (Peek() != ':')
+            {
+                step.indices_.push_back(ReadIndex());
+                SkipSpace();
+            }
+            if (Eat(':'))
+            {
+                step.kind_ = PathStep::Kind::Slice;
+                step.slice_begin_ = step.indices_.empty() ? 0 : step.indices_.front();
+                step.indices_.clear();
+                SkipSpace();
+                if (Peek() != ']')
+                {
+                    step.slice_end_ = ReadIndex();
+                    SkipSpace();
+                }
+            }
+            else
+            {
+                while (Eat(','))
+                {
+                    SkipSpace();
+                    step.indices_.push_back(ReadIndex());
+                    SkipSpace();
+                }
+            }
+        }
+
+        SkipSpace();
+        Expect(']');
+        steps_.push_back(std::move(step));
+    }
+
+    PathFilter ParseFilter()
+    {
+        PathFilter filter;
+        SkipSpace();
+        const bool paren = Eat('(');
+        SkipSpace();
+        Expect('@');
+        if (Eat('.'))
+        {
+            filter.has_key_ = true;
+            filter.key_ = ReadName();
+        }
+        else if (Eat('['))
+        {
+            SkipSpace();
+            if (Peek() != '\'' && Peek() != '"')
+            {
+                Fail();
+            }
+            filter.has_key_ = true;
+            filter.key_ = ReadQuoted();
+            SkipSpace();
+            Expect(']');
+        }
+        SkipSpace();
+
+        if (Eat('='))
+        {
+            Expect('=');
+            filter.op_ = PathFilter::Op::Eq;
+        }
+        else if (Eat('!'))
+        {
+            Expect('=');
+            filter.op_ = PathFilter::Op::Ne;
+        }
+        else if (Eat('<'))
+        {
+            filter.op_ = Eat('=') ? PathFilter::Op::Le : PathFilter::Op::Lt;
+        }
+        else if (Eat('>'))
+        {
+            filter.op_ = Eat('=') ? PathFilter::Op::Ge : PathFilter::Op::Gt;
+        }
+
+        if (filter.op_ != PathFilter::Op::Exists)
+        {
+            SkipSpace();
+            filter.literal_ = ReadLiteral();
+            SkipSpace();
+        }
+        if (paren)
+        {
+            Expect(')');
+        }
+        return filter;
+    }
+
+    JsonValue ReadLiteral()
+    {
+        if (Peek() == '\'' || Peek() == '"')
+        {
+            return {ReadQuoted()};
+        }
+        for (const auto &[word, value] :
+             {std::make_pair(std::string_view("true"), JsonValue(true)),
+              std::make_pair(std::string_view("false"), JsonValue(false)),
+              std::make_pair(std::string_view("null"), JsonValue(nullptr))})
+        {
+            if (path_.substr(pos_, word.size()) == word)
+            {
+                pos_ += word.size();
+                return value;
+            }
+        }
+
+        const size_t begin = pos_;
+        while (pos_ < path_.size() && std::string_view("+-.eE0123456789").find(path_[pos_]) != std::string_view::npos)
+        {
+            ++pos_;
+        }
+        const std::string number(path_.substr(begin, pos_ - begin));
+        if (number.empty())
+        {
+            Fail();
+        }
+
+        long long int_value = 0;
+        if (number.find_first_of(".eE") == std::string::npos &&
+            std::from_chars(number.data(), number.data() + number.size(), int_value).ec == std::errc())
+        {
+            return {static_cast<long long>(int_value)};
+        }
+        char *end = nullptr;
+        const long double float_value = std::strtold(number.c_str(), &end);
+        if (end != number.c_str() + number.size())
+        {
+            Fail();
+        }
+        return {static_cast<long double>(float_value)};
+    }
+};
+
+// 在token流上运行自动机，只有到达接受状态的值才会被构建成JsonValue
+class PathWalker
+{
+  public:
+    PathWalker(const JsonData &json_data, const std::vector<PathStep> &steps) noexcept
+        : sax_(json_data), reader_(sax_.Reader()), steps_(steps), accept_(1ULL << steps.size())
+    {
+    }
+
+    std::vector<JsonValue> Run()
+    {
+        if (const Token *top = reader_.Current();
+            top->type_ != TokenType::LBRACE && top->type_ != TokenType::LBRACKET)
+        {
+            Fail(ERR_MISMATCH_TOP_LEVEL, top);
+        }
+        if (!Walk(1ULL))
+        {
+            ThrowError();
+        }
+        return std::move(results_);
+    }
+
+  private:
+    SaxReader sax_; // 用于构建匹配到的值
+    TokenReader &reader_;
+    const std::vector<PathStep> &steps_;
+    const uint64_t accept_;
+    std::vector<JsonValue> results_;
+    ErrReporter err_reporter_;
+
+    bool Fail(std::string err_desc, const Token *token, const size_t highlight_pos = 0, const size_t highlight_len = 0)
+    {
+        err_reporter_.AddError(reader_.MakeErrInfo(std::move(err_desc), token, highlight_pos, highlight_len));
+        ThrowError();
+        return false;
+    }
+
+    void ThrowError() const
+    {
+        if (sax_.HasError())
+        {
+            sax_.ThrowError();
+        }
+        err_reporter_.ThrowError();
+    }
+
+    // 游标位于值的第一个token上，返回时位于值的最后一个token上
+    bool Walk(uint64_t states)
+    {
+        if ((states & accept_) != 0)
+        {
+            const size_t begin = reader_.Position();
+            JsonBuilder builder;
+            if (!sax_.ParseValue(builder))
+            {
+                return false;
+            }
+            results_.push_back(builder.TakeValue());
+
+            // 形如 $..a 的路径，匹配到的值内部可能还有匹配
+            states &= ~accept_;
+            if (states == 0)
+            {
+                return true;
+            }
+            reader_.Seek(begin);
+        }
+
+        const Token *token = reader_.Current();
+        if (states == 0)
+        {
+            // 不可能再匹配的子树只检查语法，不构造任何值
+            if (const char *err_desc = nullptr; !reader_.SkipValue(err_desc))
+            {
+                return Fail(err_desc, reader_.Current());
+            }
+            return true;
+        }
+
+        switch (token->type_)
+        {
+        case TokenType::LBRACE:
+            return WalkContainer(states, true);
+        case TokenType::LBRACKET:
+            return WalkContainer(states, false);
+        case TokenType::STR:
+        case TokenType::NUM:
+        case TokenType::TRUE:
+        case TokenType::FALSE:
+        case TokenType::NULL_:
+            return true;
+        default:
+            return Fail(ERR_EXPECTED_JSON_VALUE_TYPE, token);
+        }
+    }
+
+    bool WalkContainer(const uint64_t states, const bool is_object)
+    {
+        const TokenType close = is_object ? TokenType::RBRACE : TokenType::RBRACKET;
+        if (reader_.Advance()->type_ == close)
+        {
+            return true;
+        }
+
+        for (size_t index = 0;; ++index)
+        {
+            const std::string *key = nullptr;
+            if (is_object)
+            {
+                const Token *key_token = reader_.Current();
+                if (key_token->type_ != TokenType::STR)
+                {
+                    return Fail(ERR_OBJECT_KEY_MUST_BE_STRING, key_token);
+                }
+                if (reader_.Peek()->type_ != TokenType::COLON)
+                {
+                    return Fail(ERR_COLON_EXPECTED, key_token, key_token->col_ + key_token->len_, 1);
+                }
+                key = &key_token->raw_value_;
+                reader_.Advance();
+                reader_.Advance();
+            }
+
+            if (!Walk(Transition(states, key, index)))
+            {
+                return false;
+            }
+
+            const Token *last = reader_.Current();
+            const Token *next = reader_.Advance();
+            if (next->type_ == close)
+            {
+                return true;
+            }
+            if (next->type_ != TokenType::COMMA)
+            {
+                return Fail(is_object ? ERR_COMMA_OR_BRACE_EXPECTED : ERR_COMMA_OR_BRACKET_EXPECTED, last,
+                            last->col_ + last->len_, 1);
+            }
+            if (reader_.Advance()->type_ == close)
+            {
+                return ALLOW_TRAILING_COMMA || Fail(ERR_TRAILING_COMMA, next);
+            }
+        }
+    }
+
+    // 计算子节点的状态集合，游标位于子节点的第一个token上，key为空表示数组元素
+    uint64_t Transition(const uint64_t states, const std::string *key, const size_t index)
+    {
+        uint64_t next = 0;
+        for (size_t i = 0; i < steps_.size(); ++i)
+        {
+            if ((states & (1ULL << i)) == 0)
+            {
+                continue;
+            }
+
+            const PathStep &step = steps_[i];
+            if (step.recursive_)
+            {
+                next |= 1ULL << i;
+            }
+
+            bool matched = false;
+            switch (step.kind_)
+            {
+            case PathStep::Kind::Name:
+                matched = key != nullptr && std::find(step.names_.begin(), step.names_.end(), *key) != step.names_.end();
+                break;
+            case PathStep::Kind::Wildcard:
+                matched = true;
+                break;
+            case PathStep::Kind::Index:
+                matched = key == nullptr && std::find(step.indices_.begin(), step.indices_.end(), index) !=
+                                                step.indices_.end();
+                break;
+            case PathStep::Kind::Slice:
+                matched = key == nullptr && index >= step.slice_begin_ && index < step.slice_end_;
+                break;
+            case PathStep::Kind::Filter:
+                matched = EvalFilter(step.filter_);
+                break;
+            }
+            if (matched)
+            {
+                next |= 1ULL << (i + 1);
+            }
+        }
+        return next;
+    }
+
+    // 向前查看当前值来计算过滤条件，之后游标回到原来的位置
+    bool EvalFilter(const PathFilter &filter)
+    {
+        const size_t begin = reader_.Position();
+        bool found = false;
+        const Token *target = nullptr; // 找到的值为容器时为空
+
+        const Token *token = reader_.Current();
+        if (!filter.has_key_)
+        {
+            found = true;
+            target = token->type_ == TokenType::LBRACE || token->type_ == TokenType::LBRACKET ? nullptr : token;
+        }
+        else if (token->type_ == TokenType::LBRACE)
+        {
+            reader_.Advance();
+            while (reader_.Current()->type_ == TokenType::STR && reader_.Peek()->type_ == TokenType::COLON)
+            {
+                const bool is_key = reader_.Current()->raw_value_ == filter.key_;
+                reader_.Advance();
+                const Token *value = reader_.Advance();
+                if (is_key)
+                {
+                    // 与Parser一致，重复的键以最后一个为准
+                    found = true;
+                    target = value->type_ == TokenType::LBRACE || value->type_ == TokenType::LBRACKET ? nullptr : value;
+                }
+                if (const char *err_desc = nullptr;
+                    !reader_.SkipValue(err_desc) || reader_.Advance()->type_ != TokenType::COMMA)
+                {
+                    break;
+                }
+                reader_.Advance();
+            }
+        }
+        reader_.Seek(begin);
+
+        if (filter.op_ == PathFilter::Op::Exists)
+        {
+            return found;
+        }
+        const int order = target == nullptr ? 2 : Compare(*target, filter.literal_);
+        switch (filter.op_)
+        {
+        case PathFilter::Op::Eq:
+            return order == 0;
+        case PathFilter::Op::Ne:
+            return order != 0;
+        case PathFilter::Op::Lt:
+            return order == -1;
+        case PathFilter::Op::Le:
+            return order == -1 || order == 0;
+        case PathFilter::Op::Gt:
+            return order == 1;
+        case PathFilter::Op::Ge:
+            return order == 1 || order == 0;
+        default:
+            return false;
+        }
+    }
+
+    // 返回-1、0、1表示大小关系，2表示两者不可比较
+    static int Compare(const Token &token, const JsonValue &literal)
+    {
+        switch (token.type_)
+        {
+        case TokenType::NUM: {
+            if (literal.GetType() != JsonType::Int && literal.GetType() != JsonType::Float)
+            {
+                return 2;
+            }
+            const long double lhs = std::strtold(token.raw_value_.c_str(), nullptr);
+            const long double rhs = literal.GetType() == JsonType::Int
+                                        ? static_cast<long double>(literal.GetVal<JsonType::Int>())
+                                        : literal.GetVal<JsonType::Float>();
+            return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+        }
+        case TokenType::STR: {
+            if (literal.GetType() != JsonType::String)
+            {
+                return 2;
+            }
+            const int order = token.raw_value_.compare(literal.GetVal<JsonType::String>());
+            return order < 0 ? -1 : (order > 0 ? 1 : 0);
+        }
+        case TokenType::TRUE:
+        case TokenType::FALSE:
+            // 布尔值只能判断相等
+            return literal.GetType() == JsonType::Bool &&
+                           literal.GetVal<JsonType::Bool>() == (token.type_ == TokenType::TRUE)
+                       ? 0
+                       : 2;
+        case TokenType::NULL_:
+            return literal.GetType() == JsonType::Null ? 0 : 2;
+        default:
+            return 2;
+        }
+    }
+};
+
+} // namespace
+
+JsonPath::JsonPath(const std::string_view path) : steps_(PathCompiler(path).Compile())
+{
+}
+
+std::vector<JsonValue> JsonPath::Query(const JsonData &json_data) const
+{
+    PathWalker walker(json_data, steps_);
+    return walker.Run();
+}
+} // namespace simple_json
@@ -0,0 +1,225 @@
+#include "json_pointer.h"
+#include "config.h"
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+// RFC 6901中的数组下标，不允许前导0，"-"表示数组末尾之后的位置，永远无法解析到值
+size_t ParseIndex(const std::string &key) noexcept
+{
+    if (key.empty() || (key.size() > 1 && key[0] == '0'))
+    {
+        return PointerSegment::NOT_INDEX;
+    }
+
+    size_t index = 0;
+    for (const char ch : key)
+    {
+        if (ch < '0' || ch > '9' || index > (PointerSegment::NOT_INDEX - 10) / 10)
+        {
+            return PointerSegment::NOT_INDEX;
+        }
+        index = index * 10 + static_cast<size_t>(ch - '0');
+    }
+    return index;
+}
+
+PointerSegment MakeSegment(std::string key)
+{
+    PointerSegment segment{std::move(key), 0};
+    segment.index_ = ParseIndex(segment.key_);
+    return segment;
+}
+
+} // namespace
+
+JsonPointer::JsonPointer(const std::string_view pointer)
+{
+    if (pointer.empty())
+    {
+        return;
+    }
+    if (pointer[0] != '/')
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_POINTER + std::string(pointer)));
+    }
+
+    std::string key;
+    for (size_t i = 1; i <= pointer.size(); ++i)
+    {
+        if (i == pointer.size() || pointer[i] == '/')
+        {
+            segments_.push_back(MakeSegment(std::move(key)));
+            key.clear();
+            continue;
+        }
+
+        if (pointer[i] != '~')
+        {
+            key += pointer[i];
+            continue;
+        }
+
+        // 只有~0和~1两种转义
+        if (i + 1 == pointer.size() || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_POINTER + std::string(pointer)));
+        }
+        key += pointer[++i] == '0' ? '~' : '/';
+    }
+}
+
+const JsonValue *JsonPointer::Resolve(const JsonValue &root) const noexcept
+{
+    const JsonValue *cur = &root;
+    for (const PointerSegment &segment : segments_)
+    {
+        cur = Step(*cur, segment);
+        if (cur == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    return cur;
+}
+
+JsonValue *JsonPointer::Resolve(JsonValue &root) const noexcept
+{
+    // 经过非const接口访问，沿途容器缓存的哈希值随之失效
+    JsonValue *cur = &root;
+    for (const PointerSegment &segment : segments_)
+    {
+        cur = Step(*cur, segment);
+        if (cur == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    return cur;
+}
+
+std::string JsonPointer::ToString() const
+{
+    std::string pointer;
+    for (const PointerSegment &segment : segments_)
+    {
+        pointer += '/';
+        for (const char ch : segment.key_)
+        {
+            if (ch == '~')
+            {
+                pointer += "~0";
+            }
+            else if (ch == '/')
+            {
+                pointer += "~1";
+            }
+            else
+            {
+                pointer += ch;
+            }
+        }
+    }
+    return pointer;
+}
+
+const JsonValue *JsonPointer::Step(const JsonValue &value, const PointerSegment &segment) noexcept
+{
+    // 类型已经检查过，GetVal不会抛异常；find使用段中保存的键，不产生临时字符串
+    if (value.GetType() == JsonType::Object)
+    {
+        const auto &object = value.GetVal<JsonType::Object>();
+        const auto iter = object.find(segment.key_);
+        return iter == object.end() ? nullptr : &iter->second;
+    }
+    if (value.GetType() == JsonType::Array)
+    {
+        const auto &array = value.GetVal<JsonType::Array>();
+        return segment.index_ < array.size() ? &array[segment.index_] : nullptr;
+    }
+    return nullptr;
+}
+
+JsonValue *JsonPointer::Step(JsonValue &value, const PointerSegment &segment) noexcept
+{
+    if (value.GetType() == JsonType::Object)
+    {
+        auto &object = value.GetVal<JsonType::Object>();
+        const auto iter = object.find(segment.key_);
+        return iter == object.end() ? nullptr : &iter->second;
+    }
+    if (value.GetType() == JsonType::Array)
+    {
+        auto &array = value.GetVal<JsonType::Array>();
+        return segment.index_ < array.size() ? &array[segment.index_] : nullptr;
+    }
+    return nullptr;
+}
+
+JsonPointerBatch::JsonPointerBatch()
+{
+    nodes_.emplace_back();
+}
+
+size_t JsonPointerBatch::Add(const JsonPointer &pointer)
+{
+    size_t cur = 0;
+    for (const PointerSegment &segment : pointer.Segments())
+    {
+        // 相同前缀合并到同一个节点
+        size_t next = 0;
+        for (const size_t child : nodes_[cur].children_)
+        {
+            const PointerSegment &existing = nodes_[child].segment_;
+            if (existing.key_ == segment.key_)
+            {
+                next = child;
+                break;
+            }
+        }
+
+        if (next == 0)
+        {
+            next = nodes_.size();
+            nodes_.push_back(TrieNode{segment, {}, {}});
+            nodes_[cur].children_.push_back(next);
+        }
+        cur = next;
+    }
+
+    nodes_[cur].targets_.push_back(pointer_count_);
+    return pointer_count_++;
+}
+
+void JsonPointerBatch::Resolve(const JsonValue &root, std::vector<const JsonValue *> &results) const
+{
+    results.assign(pointer_count_, nullptr);
+    Visit(0, root, results);
+}
+
+void JsonPointerBatch::Visit(const size_t node_index, const JsonValue &value,
+                             std::vector<const JsonValue *> &results) const
+{
+    const TrieNode &node = nodes_[node_index];
+    for (const size_t target : node.targets_)
+    {
+        results[target] = &value;
+    }
+
+    for (const size_t child : node.children_)
+    {
+        if (const JsonValue *next = JsonPointer::Step(value, nodes_[child].segment_); next != nullptr)
+        {
+            Visit(child, *next, results);
+        }
+    }
+}
+} // namespace simple_json
@@ -0,0 +1,613 @@
+#include "json_schema.h"
+#include "config.h"
+#include "lexer_parser.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+constexpr uint8_t TypeBit(const JsonType type) noexcept
+{
+    return static_cast<uint8_t>(1U << static_cast<uint8_t>(type));
+}
+
+[[noreturn]] void ThrowInvalidSchema(const std::string &detail)
+{
+    SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_SCHEMA + detail));
+}
+
+bool IsNumber(const JsonValue &value) noexcept
+{
+    return value.GetType() == JsonType::Int || value.GetType() == JsonType::Float;
+}
+
+long double ToNumber(const JsonValue &value)
+{
+    return value.GetType() == JsonType::Int ? static_cast<long double>(value.GetVal<JsonType::Int>())
+                                            : value.GetVal<JsonType::Float>();
+}
+
+size_t ToCount(const JsonValue &value, const std::string &keyword)
+{
+    if (value.GetType() == JsonType::Int && value.GetVal<JsonType::Int>() >= 0)
+    {
+        return static_cast<size_t>(value.GetVal<JsonType::Int>());
+    }
+    ThrowInvalidSchema(keyword + " must be a non-negative integer");
+}
+
+uint8_t ParseTypeName(const JsonValue &name, bool &has_integer, bool &has_number)
+{
+    if (name.GetType() != JsonType::String)
+    {
+        ThrowInvalidSchema("type must be a string or an array of strings");
+    }
+
+    const std::string &type = name.GetVal<JsonType::String>();
+    if (type == "object")
+    {
+        return TypeBit(JsonType::Object);
+    }
+    if (type == "array")
+    {
+        return TypeBit(JsonType::Array);
+    }
+    if (type == "string")
+    {
+        return TypeBit(JsonType::String);
+    }
+    if (type == "boolean")
+    {
+        return TypeBit(JsonType::Bool);
+    }
+    if (type == "null")
+    {
+        return TypeBit(JsonType::Null);
+    }
+    if (type == "number" || type == "integer")
+    {
+        (type == "number" ? has_number : has_integer) = true;
+        return TypeBit(JsonType::Int) | TypeBit(JsonType::Float);
+    }
+    ThrowInvalidSchema("unknown type \"" + type + "\"");
+}
+
+// 按UTF-8码点计算字符串长度，跳过所有后续字节10xxxxxx
+size_t CodePointCount(const std::string_view str) noexcept
+{
+    size_t count = 0;
+    for (const char ch : str)
+    {
+        count += (static_cast<unsigned char>(ch) & 0xC0U) != 0x80U ? 1 : 0;
+    }
+    return count;
+}
+
+// 编译minimum/exclusiveMinimum或maximum/exclusiveMaximum，支持draft-04的布尔形式与之后的数值形式，同时出现时取更严格的一个
+void CompileBound(SchemaNode &node, const std::unordered_map<std::string, JsonValue> &keywords, const bool is_min)
+{
+    const std::string inclusive_key = is_min ? "minimum" : "maximum";
+    const std::string exclusive_key = is_min ? "exclusiveMinimum" : "exclusiveMaximum";
+    const auto inclusive = keywords.find(inclusive_key);
+    const auto exclusive = keywords.find(exclusive_key);
+
+    bool has_bound = false;
+    bool is_exclusive = false;
+    long double bound = 0;
+    if (inclusive != keywords.end())
+    {
+        if (!IsNumber(inclusive->second))
+        {
+            ThrowInvalidSchema(inclusive_key + " must be a number");
+        }
+        has_bound = true;
+        bound = ToNumber(inclusive->second);
+    }
+    if (exclusive != keywords.end())
+    {
+        if (exclusive->second.GetType() == JsonType::Bool)
+        {
+            is_exclusive = has_bound && exclusive->second.GetVal<JsonType::Bool>();
+        }
+        else if (IsNumber(exclusive->second))
+        {
+            const long double exclusive_bound = ToNumber(exclusive->second);
+            if (!has_bound || (is_min ? exclusive_bound >= bound : exclusive_bound <= bound))
+            {
+                has_bound = true;
+                is_exclusive = true;
+                bound = exclusive_bound;
+            }
+        }
+        else
+        {
+            ThrowInvalidSchema(exclusive_key + " must be a number or a boolean");
+        }
+    }
+
+    (is_min ? node.has_minimum_ : node.has_maximum_) = has_bound;
+    (is_min ? node.exclusive_minimum_ : node.exclusive_maximum_) = is_exclusive;
+    (is_min ? node.minimum_ : node.maximum_) = bound;
+}
+
+// 只影响文档而不参与校验的关键字
+const std::unordered_set<std::string> &AnnotationKeywords()
+{
+    static const std::unordered_set<std::string> keywords{
+        "$schema", "$id", "$comment", "title", "description", "default", "examples", "format", "readOnly", "writeOnly"};
+    return keywords;
+}
+
+} // namespace
+
+JsonSchema JsonSchema::Compile(const JsonValue &schema)
+{
+    JsonSchema compiled;
+    compiled.CompileNode(schema);
+    return compiled;
+}
+
+size_t JsonSchema::CompileNode(const JsonValue &schema)
+{
+    // 子schema编译过程中nodes_会扩容，只能通过下标访问当前节点
+    const size_t index = nodes_.size();
+    nodes_.emplace_back();
+
+    if (schema.GetType() == JsonType::Bool)
+    {
+        nodes_[index].reject_all_ = !schema.GetVal<JsonType::Bool>();
+        return index;
+    }
+    if (schema.GetType() != JsonType::Object)
+    {
+        ThrowInvalidSchema("a schema must be an object or a boolean");
+    }
+
+    const auto &keywords = schema.GetVal<JsonType::Object>();
+    for (const auto &[keyword, value] : keywords)
+    {
+        if (keyword == "type")
+        {
+            bool has_integer = false;
+            bool has_number = false;
+            uint8_t types = 0;
+            if (value.GetType() == JsonType::Array)
+            {
+                for (const JsonValue &name : value.GetVal<JsonType::Array>())
+                {
+                    types |= ParseTypeName(name, has_integer, has_number);
+                }
+            }
+            else
+            {
+                types = ParseTypeName(value, has_integer, has_number);
+            }
+            nodes_[index].types_ = types;
+            nodes_[index].integer_ = has_integer && !has_number;
+        }
+        else if (keyword == "properties")
+        {
+            if (value.GetType() != JsonType::Object)
+            {
+                ThrowInvalidSchema("properties must be an object");
+            }
+            for (const auto &[key, sub_schema] : value.GetVal<JsonType::Object>())
+            {
+                const size_t sub_index = CompileNode(sub_schema);
+                nodes_[index].properties_[key] = sub_index;
+            }
+        }
+        else if (keyword == "required")
+        {
+            if (value.GetType() != JsonType::Array)
+            {
+                ThrowInvalidSchema("required must be an array of strings");
+            }
+            for (const JsonValue &key : value.GetVal<JsonType::Array>())
+            {
+                if (key.GetType() != JsonType::String)
+                {
+                    ThrowInvalidSchema("required must be an array of strings");
+                }
+                auto &required = nodes_[index].required_;
+                required.emplace(key.GetVal<JsonType::String>(), required.size());
+            }
+        }
+        else if (keyword == "additionalProperties")
+        {
+            const size_t sub_index = CompileNode(value);
+            nodes_[index].additional_ = sub_index;
+        }
+        else if (keyword == "items")
+        {
+            if (value.GetType() == JsonType::Array)
+            {
+                ThrowInvalidSchema("tuple form of items is not supported");
+            }
+            const size_t sub_index = CompileNode(value);
+            nodes_[index].items_ = sub_index;
+        }
+        else if (keyword == "enum" || keyword == "const")
+        {
+            std::vector<JsonValue> values;
+            if (keyword == "enum")
+            {
+                if (value.GetType() != JsonType::Array)
+                {
+                    ThrowInvalidSchema("enum must be an array");
+                }
+                values = value.GetVal<JsonType::Array>();
+            }
+            else
+            {
+                values.push_back(value);
+            }
+
+            for (const JsonValue &item : values)
+            {
+                if (item.GetType() == JsonType::Object || item.GetType() == JsonType::Array)
+                {
+                    ThrowInvalidSchema(keyword + " only supports scalar values");
+                }
+            }
+            // enum与const同时出现时取交集，空的enum不接受任何值
+            SchemaNode &node = nodes_[index];
+            if (!node.enum_.empty())
+            {
+                std::vector<JsonValue> both;
+                for (const JsonValue &item : values)
+                {
+                    for (const JsonValue &allowed : node.enum_)
+                    {
+                        if (item == allowed)
+                        {
+                            both.push_back(item);
+                            break;
+                        }
+                    }
+                }
+                values = std::move(both);
+            }
+            node.reject_all_ = node.reject_all_ || values.empty();
+            node.enum_ = std::move(values);
+        }
+        else if (keyword == "minimum" || keyword == "maximum" || keyword == "exclusiveMinimum" ||
+                 keyword == "exclusiveMaximum")
+        {
+            // 数值范围需要同时看两个关键字，在循环结束后统一处理
+            continue;
+        }
+        else if (keyword == "minLength")
+        {
+            nodes_[index].min_length_ = ToCount(value, keyword);
+        }
+        else if (keyword == "maxLength")
+        {
+            nodes_[index].max_length_ = ToCount(value, keyword);
+        }
+        else if (keyword == "minItems")
+        {
+            nodes_[index].min_items_ = ToCount(value, keyword);
+        }
+        else if (keyword == "maxItems")
+        {
+            nodes_[index].max_items_ = ToCount(value, keyword);
+        }
+        else if (AnnotationKeywords().count(keyword) == 0)
+        {
+            ThrowInvalidSchema("unsupported keyword \"" + keyword + "\"");
+        }
+    }
+
+    CompileBound(nodes_[index], keywords, true);
+    CompileBound(nodes_[index], keywords, false);
+    return index;
+}
+
+void JsonSchema::Validate(std::string json_str) const
+{
+    Lexer lexer(std::move(json_str));
+    const JsonData json_data = lexer.TakeToken();
+
+    SchemaValidator validator(*this);
+    SaxReader reader(json_data);
+    if (!reader.Parse(validator))
+    {
+        reader.ThrowError();
+    }
+}
+
+bool SchemaValidator::StartObject()
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema != SchemaNode::ANY && !CheckType(schema_.Node(schema), JsonType::Object))
+    {
+        return false;
+    }
+    return PushFrame(schema, true);
+}
+
+bool SchemaValidator::Key(const std::string_view key)
+{
+    Frame &frame = frames_[depth_ - 1];
+    if (frame.schema_ == SchemaNode::ANY)
+    {
+        pending_ = SchemaNode::ANY;
+        return true;
+    }
+
+    const SchemaNode &node = schema_.Node(frame.schema_);
+    const std::string key_str(key);
+    if (const auto required = node.required_.find(key_str); required != node.required_.end())
+    {
+        frame.seen_[required->second] = true;
+    }
+
+    if (const auto property = node.properties_.find(key_str); property != node.properties_.end())
+    {
+        pending_ = property->second;
+        return true;
+    }
+
+    // 不允许的键在读到键时就报错，不必等到它的值
+    if (node.additional_ != SchemaNode::ANY && schema_.Node(node.additional_).reject_all_)
+    {
+        return Fail(ERR_SCHEMA_ADDITIONAL + key_str);
+    }
+    pending_ = node.additional_;
+    return true;
+}
+
+bool SchemaValidator::EndObject(size_t /*member_count*/)
+{
+    const Frame &frame = frames_[--depth_];
+    if (frame.schema_ == SchemaNode::ANY)
+    {
+        return true;
+    }
+
+    for (const auto &[key, position] : schema_.Node(frame.schema_).required_)
+    {
+        if (!frame.seen_[position])
+        {
+            return Fail(ERR_SCHEMA_REQUIRED + key);
+        }
+    }
+    return true;
+}
+
+bool SchemaValidator::StartArray()
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema != SchemaNode::ANY && !CheckType(schema_.Node(schema), JsonType::Array))
+    {
+        return false;
+    }
+    return PushFrame(schema, false);
+}
+
+bool SchemaValidator::EndArray(const size_t element_count)
+{
+    const Frame &frame = frames_[--depth_];
+    if (frame.schema_ != SchemaNode::ANY && element_count < schema_.Node(frame.schema_).min_items_)
+    {
+        return Fail(ERR_SCHEMA_ITEMS);
+    }
+    return true;
+}
+
+bool SchemaValidator::String(const std::string_view value)
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema == SchemaNode::ANY)
+    {
+        return true;
+    }
+
+    const SchemaNode &node = schema_.Node(schema);
+    if (!CheckType(node, JsonType::String))
+    {
+        return false;
+    }
+    if (node.min_length_ != 0 || node.max_length_ != static_cast<size_t>(-1))
+    {
+        const size_t length = CodePointCount(value);
+        if (length < node.min_length_ || length > node.max_length_)
+        {
+            return Fail(ERR_SCHEMA_LENGTH);
+        }
+    }
+    return node.enum_.empty() || CheckEnum(node, JsonValue(std::string(value)));
+}
+
+bool SchemaValidator::Int(const long long value)
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema == SchemaNode::ANY)
+    {
+        return true;
+    }
+    if (!CheckNumber(schema, JsonType::Int, static_cast<long double>(value), true))
+    {
+        return false;
+    }
+
+    const SchemaNode &node = schema_.Node(schema);
+    return node.enum_.empty() || CheckEnum(node, JsonValue(static_cast<long long>(value)));
+}
+
+bool SchemaValidator::Float(const long double value)
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema == SchemaNode::ANY)
+    {
+        return true;
+    }
+    if (!CheckNumber(schema, JsonType::Float, value, std::isfinite(value) && std::floor(value) == value))
+    {
+        return false;
+    }
+
+    const SchemaNode &node = schema_.Node(schema);
+    return node.enum_.empty() || CheckEnum(node, JsonValue(static_cast<long double>(value)));
+}
+
+bool SchemaValidator::Bool(const bool value)
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema == SchemaNode::ANY)
+    {
+        return true;
+    }
+
+    const SchemaNode &node = schema_.Node(schema);
+    return CheckType(node, JsonType::Bool) && (node.enum_.empty() || CheckEnum(node, JsonValue(value)));
+}
+
+bool SchemaValidator::Null()
+{
+    size_t schema = 0;
+    if (!NextSchema(schema))
+    {
+        return false;
+    }
+    if (schema == SchemaNode::ANY)
+    {
+        return true;
+    }
+
+    const SchemaNode &node = schema_.Node(schema);
+    return CheckType(node, JsonType::Null) && (node.enum_.empty() || CheckEnum(node, JsonValue(nullptr)));
+}
+
+std::string SchemaValidator::GetError() const
+{
+    return err_desc_;
+}
+
+bool SchemaValidator::NextSchema(size_t &schema)
+{
+    if (depth_ == 0)
+    {
+        schema = 0;
+        return true;
+    }
+
+    Frame &frame = frames_[depth_ - 1];
+    if (frame.is_object_)
+    {
+        schema = pending_;
+        return true;
+    }
+
+    // 数组元素个数超出上限时立即报错，不必读完整个数组
+    ++frame.count_;
+    if (frame.schema_ == SchemaNode::ANY)
+    {
+        schema = SchemaNode::ANY;
+        return true;
+    }
+    const SchemaNode &node = schema_.Node(frame.schema_);
+    if (frame.count_ > node.max_items_)
+    {
+        return Fail(ERR_SCHEMA_ITEMS);
+    }
+    schema = node.items_;
+    return true;
+}
+
+bool SchemaValidator::Fail(std::string err_desc)
+{
+    err_desc_ = std::move(err_desc);
+    return false;
+}
+
+bool SchemaValidator::CheckType(const SchemaNode &node, const JsonType type, const bool integral)
+{
+    if (node.reject_all_ || (node.types_ & TypeBit(type)) == 0 ||
+        (type == JsonType::Float && node.integer_ && !integral))
+    {
+        return Fail(ERR_SCHEMA_TYPE);
+    }
+    return true;
+}
+
+bool SchemaValidator::CheckEnum(const SchemaNode &node, const JsonValue &value)
+{
+    for (const JsonValue &allowed : node.enum_)
+    {
+        if (allowed == value)
+        {
+            return true;
+        }
+    }
+    return Fail(ERR_SCHEMA_ENUM);
+}
+
+bool SchemaValidator::CheckNumber(const size_t schema, const JsonType type, const long double value,
+                                  const bool integral)
+{
+    const SchemaNode &node = schema_.Node(schema);
+    if (!CheckType(node, type, integral))
+    {
+        return false;
+    }
+
+    if (node.has_minimum_ && (value < node.minimum_ || (node.exclusive_minimum_ && value == node.minimum_)))
+    {
+        return Fail(ERR_SCHEMA_RANGE);
+    }
+    if (node.has_maximum_ && (value > node.maximum_ || (node.exclusive_maximum_ && value == node.maximum_)))
+    {
+        return Fail(ERR_SCHEMA_RANGE);
+    }
+    return true;
+}
+
+bool SchemaValidator::PushFrame(const size_t schema, const bool is_object)
+{
+    if (depth_ == frames_.size())
+    {
+        frames_.emplace_back();
+    }
+
+    Frame &frame = frames_[depth_++];
+    frame.schema_ = schema;
+    frame.is_object_ = is_object;
+    frame.count_ = 0;
+    frame.seen_.assign(schema == SchemaNode::ANY ? 0 : schema_.Node(schema).required_.size(), false);
+    return true;
+}
+} // namespace simple_json
@@ -1,8 +1,26 @@
 #include "json_type.h"
+#include "utilities.h"
+
+#include <cmath>
 #include <iostream>
 
 namespace simple_json
 {
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+// 超出短字符串缓冲区的字符串在堆上分配capacity + 1个字节
+void AddStringUsage(const std::string &str, MemoryFootprint &usage) noexcept
+{
+    static const size_t INLINE_CAPACITY = std::string().capacity();
+    if (str.capacity() > INLINE_CAPACITY)
+    {
+        usage.strings_ += str.size() + 1;
+        usage.capacity_slack_ += str.capacity() - str.size();
+    }
+}
+} // namespace
+
 std::ostream &operator<<(std::ostream &os, const JsonType &type)
 {
     switch (type)
@@ -64,4 +82,192 @@ std::ostream &operator<<(std::ostream &os, const JsonValue &val)
     }
     return os;
 }
+
+size_t JsonValue::Hash() const
+{
+#if CACHE_HASH
+    if (const size_t cached = hash_.Load(); cached != 0)
+    {
+        return cached;
+    }
+#endif
+
+    // 整数和浮点数使用相同的类型标记，整数值的浮点数与对应的整数哈希值相同
+    // std::hash对整数是恒等映射，标量的哈希值和对象的每一项都先经过MixHash，否则小整数组成的对象很容易碰撞
+    size_t hash = 0;
+    switch (cur_type_)
+    {
+    case JsonType::Object: {
+        // 成员的哈希值相加，与成员的顺序无关
+        const auto &object = std::get<std::unordered_map<std::string, JsonValue>>(cur_val_);
+        size_t sum = 0;
+        for (const auto &[key, member] : object)
+        {
+            sum += static_cast<size_t>(MixHash(HashCombine(std::hash<std::string>{}(key), member.Hash())));
+        }
+        hash = HashCombine(HashCombine(static_cast<size_t>(JsonType::Object), object.size()), sum);
+        break;
+    }
+    case JsonType::Array: {
+        const auto &array = std::get<std::vector<JsonValue>>(cur_val_);
+        hash = HashCombine(static_cast<size_t>(JsonType::Array), array.size());
+        for (const JsonValue &element : array)
+        {
+            hash = HashCombine(hash, element.Hash());
+        }
+        break;
+    }
+    case JsonType::String:
+        hash = HashCombine(static_cast<size_t>(JsonType::String),
+                           static_cast<size_t>(MixHash(std::hash<std::string>{}(std::get<std::string>(cur_val_)))));
+        break;
+    case JsonType::Int:
+        hash = HashCombine(static_cast<size_t>(JsonType::Int),
+                           static_cast<size_t>(MixHash(std::hash<long long>{}(std::get<long long>(cur_val_)))));
+        break;
+    case JsonType::Float: {
+        // long long的范围正好是[-2^63, 2^63)，无穷大和NaN都不在范围内
+        const long double number = std::get<long double>(cur_val_);
+        const bool integral = std::trunc(number) == number && number >= -0x1p63L && number < 0x1p63L;
+        hash = HashCombine(static_cast<size_t>(JsonType::Int),
+                           static_cast<size_t>(MixHash(integral ? std::hash<long long>{}(static_cast<long long>(number))
+                                                                : std::hash<long double>{}(number))));
+        break;
+    }
+    case JsonType::Bool:
+        hash = HashCombine(static_cast<size_t>(JsonType::Bool), static_cast<size_t>(MixHash(std::get<bool>(cur_val_))));
+        break;
+    case JsonType::Null:
+        hash = HashCombine(static_cast<size_t>(JsonType::Null), static_cast<size_t>(MixHash(0)));
+        break;
+    }
+
+    // 0用来表示未缓存
+    hash = hash == 0 ? 1 : hash;
+#if CACHE_HASH
+    if (cur_type_ == JsonType::Object || cur_type_ == JsonType::Array)
+    {
+        hash_.Store(hash);
+    }
+#endif
+    return hash;
+}
+
+MemoryFootprint JsonValue::MemoryUsage() const
+{
+    MemoryFootprint usage;
+    switch (cur_type_)
+    {
+    case JsonType::Object: {
+        // 每个成员一个单链表节点：next指针、键值对和缓存的哈希值，按键值对的对齐要求填充
+        using Object = std::unordered_map<std::string, JsonValue>;
+        struct Node
+        {
+            void *next_;
+            Object::value_type member_;
+            size_t hash_;
+        };
+        const auto &object = std::get<Object>(cur_val_);
+        usage.nodes_ += object.size() * sizeof(Node);
+        // 只有一个桶时使用容器内的单个桶，不另外分配
+        if (object.bucket_count() > 1)
+        {
+            usage.hash_buckets_ += object.bucket_count() * sizeof(void *);
+        }
+        for (const auto &[key, member] : object)
+        {
+            AddStringUsage(key, usage);
+            usage += member.MemoryUsage();
+        }
+        break;
+    }
+    case JsonType::Array: {
+        const auto &array = std::get<std::vector<JsonValue>>(cur_val_);
+        usage.nodes_ += array.size() * sizeof(JsonValue);
+        usage.capacity_slack_ += (array.capacity() - array.size()) * sizeof(JsonValue);
+        for (const JsonValue &element : array)
+        {
+            usage += element.MemoryUsage();
+        }
+        break;
+    }
+    case JsonType::String:
+        AddStringUsage(std::get<std::string>(cur_val_), usage);
+        break;
+    case JsonType::Int:
+    case JsonType::Float:
+    case JsonType::Bool:
+    case JsonType::Null:
+        // 标量存放在variant内，不占用堆内存
+        break;
+    }
+    return usage;
+}
+
+bool operator==(const JsonValue &lhs, const JsonValue &rhs)
+{
+    if (&lhs == &rhs)
+    {
+        return true;
+    }
+
+    // 数字按数值比较，1和1.0相等
+    const bool lhs_number = lhs.cur_type_ == JsonType::Int || lhs.cur_type_ == JsonType::Float;
+    const bool rhs_number = rhs.cur_type_ == JsonType::Int || rhs.cur_type_ == JsonType::Float;
+    if (lhs_number && rhs_number)
+    {
+        if (lhs.cur_type_ == JsonType::Int && rhs.cur_type_ == JsonType::Int)
+        {
+            return std::get<long long>(lhs.cur_val_) == std::get<long long>(rhs.cur_val_);
+        }
+        const long double lhs_val = lhs.cur_type_ == JsonType::Int
+                                        ? static_cast<long double>(std::get<long long>(lhs.cur_val_))
+                                        : std::get<long double>(lhs.cur_val_);
+        const long double rhs_val = rhs.cur_type_ == JsonType::Int
+                                        ? static_cast<long double>(std::get<long long>(rhs.cur_val_))
+                                        : std::get<long double>(rhs.cur_val_);
+        return lhs_val == rhs_val;
+    }
+    if (lhs.cur_type_ != rhs.cur_type_)
+    {
+        return false;
+    }
+#if CACHE_HASH
+    // 两边都已缓存哈希值时，哈希值不同的容器一定不相等
+    if (const size_t lhs_hash = lhs.hash_.Load(), rhs_hash = rhs.hash_.Load();
+        lhs_hash != 0 && rhs_hash != 0 && lhs_hash != rhs_hash)
+    {
+        return false;
+    }
+#endif
+
+    switch (lhs.cur_type_)
+    {
+    case JsonType::Object: {
+        const auto &lhs_obj = std::get<std::unordered_map<std::string, JsonValue>>(lhs.cur_val_);
+        const auto &rhs_obj = std::get<std::unordered_map<std::string, JsonValue>>(rhs.cur_val_);
+        if (lhs_obj.size() != rhs_obj.size())
+        {
+            return false;
+        }
+        for (const auto &[key, value] : lhs_obj)
+        {
+            const auto iter = rhs_obj.find(key);
+            if (iter == rhs_obj.end() || value != iter->second)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    case JsonType::Array:
+        return std::get<std::vector<JsonValue>>(lhs.cur_val_) == std::get<std::vector<JsonValue>>(rhs.cur_val_);
+    case JsonType::String:
+        return std::get<std::string>(lhs.cur_val_) == std::get<std::string>(rhs.cur_val_);
+    case JsonType::Bool:
+        return std::get<bool>(lhs.cur_val_) == std::get<bool>(rhs.cur_val_);
+    default:
+        return true;
+    }
+}
 } // namespace simple_json
@@ -1,12 +1,20 @@
 #include "lexer_parser.h"
 #include "config.h"
 #include "json_type.h"
+#include "parse_stats.h"
+#include "probes.h"
 #include "utilities.h"
 
+#include <algorithm>
+#include <bitset>
 #include <cctype>
+#include <charconv>
 #include <cstddef>
+#include <cstdlib>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace simple_json
 {
@@ -15,15 +23,10 @@ bool ErrReporter::HasError() const noexcept
     return !errors_.empty();
 }
 
-void ErrReporter::ThrowError(const bool throw_all) const
+std::string ErrReporter::FormatErrors(const bool format_all) const
 {
-    if (!HasError())
-    {
-        return;
-    }
-
     std::string error_print_info;
-    const size_t error_count = throw_all ? errors_.size() : 1;
+    const size_t error_count = format_all ? errors_.size() : std::min<size_t>(errors_.size(), 1);
     for (size_t i = 0; i < error_count; i++)
     {
         const POS_T err_row = errors_[i].row_ + 1; // 错误所在行的行号，面对用户，索引从1开始，所以加1
@@ -52,8 +55,47 @@ void ErrReporter::ThrowError(const bool throw_all) const
         // 构建分隔符
         error_print_info.append("\n- - - - - - - - - - -\n");
     }
+    return error_print_info;
+}
+
+void ErrReporter::ThrowError(const bool throw_all) const
+{
+    if (!HasError())
+    {
+        return;
+    }
 
-    throw std::runtime_error(error_print_info);
+#if USDT_PROBES
+    if (SIMPLE_JSON_PROBE_ENABLED(error))
+    {
+        const ErrInfo &first = errors_.front();
+        SIMPLE_JSON_PROBE(error, first.err_desc_.c_str(), first.row_, first.col_, errors_.size());
+    }
+#endif
+    SIMPLE_JSON_THROW(std::runtime_error(FormatErrors(throw_all)));
+}
+
+void ErrReporter::RefreshLines(const JsonData &json_data)
+{
+    for (ErrInfo &err_info : errors_)
+    {
+        err_info.current_line_ = json_data.Line(err_info.row_);
+    }
+}
+
+void ErrReporter::Clear() noexcept
+{
+    errors_.clear();
+}
+
+std::string_view JsonData::Line(const POS_T row) const noexcept
+{
+    if (row >= lines_index_.size())
+    {
+        return {};
+    }
+    const auto [line_begin, line_end] = lines_index_[row];
+    return std::string_view(source_).substr(line_begin, line_end - line_begin);
 }
 
 JsonData Lexer::GetToken() const noexcept
@@ -61,68 +103,176 @@ JsonData Lexer::GetToken() const noexcept
     return data_;
 }
 
+JsonData Lexer::TakeToken() noexcept
+{
+    return std::move(data_);
+}
+
+JsonData &Lexer::BorrowToken() noexcept
+{
+    return data_;
+}
+
+void Lexer::Reset(const std::string_view source)
+{
+    // 缓冲区只清空不释放；token中在堆上分配过的字符串放入备用池，扫描新token时取出复用
+    static const size_t INLINE_CAPACITY = std::string().capacity();
+    for (Token &token : data_.tokens_)
+    {
+        if (token.raw_value_.capacity() > INLINE_CAPACITY)
+        {
+            spare_values_.push_back(std::move(token.raw_value_));
+        }
+    }
+    data_.tokens_.clear();
+    data_.lines_index_.clear();
+    data_.source_.assign(source);
+    err_reporter_.Clear();
+
+    cur_index_ = 0;
+    cur_row_ = 0;
+    cur_col_ = 0;
+    split_index_ = 0;
+    split_begin_ = 0;
+    truncated_ = false;
+
+    SplitLines();
+    Scan(true);
+
+    if (err_reporter_.HasError())
+    {
+        err_reporter_.ThrowError(true);
+    }
+}
+
+void Lexer::Feed(const std::string_view chunk)
+{
+    data_.source_.append(chunk);
+    SplitLines();
+    if (truncated_ && !TruncatedCanEnd())
+    {
+        return;
+    }
+    Scan(false);
+}
+
+void Lexer::Finish()
+{
+    Scan(true);
+
+    if (err_reporter_.HasError())
+    {
+        // 分块输入时，错误可能在所在行还没有读完时就被记录
+        err_reporter_.RefreshLines(data_);
+        err_reporter_.ThrowError(true);
+    }
+}
+
 void Lexer::SplitLines() noexcept
 {
-    POS_T begin = 0;
-    POS_T cur_line_index = 0;
-    for (POS_T end = 0; end < data_.source_.length(); ++end)
+#if USDT_PROBES
+    if (split_index_ == 0)
+    {
+        ProbeDocumentStart(data_.source_.length());
+    }
+#endif
+#if PARSE_STATS
+    if (split_index_ == 0)
+    {
+        // 构造、Reset和分块输入的第一块都从这里开始处理新文档
+        BeginParseStats();
+    }
+    CurrentParseStats().bytes_ += data_.source_.length() - split_index_;
+    const size_t lines_capacity = data_.lines_index_.capacity();
+#endif
+
+    // 上一次调用记录的最后一行没有换行符，分块输入时这一行可能还有后续数据，去掉后重新划分
+    if (!data_.lines_index_.empty() && data_.lines_index_.back().first == split_begin_)
     {
-        if (data_.source_[end] == '\n' || end == data_.source_.length() - 1)
+        data_.lines_index_.pop_back();
+    }
+
+    const POS_T length = data_.source_.length();
+    for (POS_T end = split_index_; end < length; ++end)
+    {
+        if (data_.source_[end] == '\n')
         {
-            data_.lines_index_[cur_line_index] = std::make_pair(begin, end + 1);
-            begin = end + 1;
-            ++cur_line_index;
+            data_.lines_index_.emplace_back(split_begin_, end + 1);
+            split_begin_ = end + 1;
         }
     }
+    split_index_ = length;
+
+    if (split_begin_ < length)
+    {
+        data_.lines_index_.emplace_back(split_begin_, length);
+    }
+
+#if PARSE_STATS
+    NoteGrowth(lines_capacity, data_.lines_index_.capacity(), sizeof(data_.lines_index_[0]));
+#endif
+}
+
+void Lexer::Scan(const bool at_eof)
+{
+#if PARSE_STATS
+    const StatsTimer timer(&ParseStats::lex_ns_);
+#endif
+#if USDT_PROBES
+    const POS_T begin_index = cur_index_;
+    const size_t begin_tokens = data_.tokens_.size();
+    SIMPLE_JSON_PROBE(lex_start, data_.source_.length() - begin_index);
+    const uint64_t begin_ns = SIMPLE_JSON_PROBE_CLOCK(lex_done);
+#endif
+
+    truncated_ = false;
+    ScanTokens(at_eof);
+
+#if USDT_PROBES
+    if (begin_ns != 0)
+    {
+        SIMPLE_JSON_PROBE(lex_done, cur_index_ - begin_index, data_.tokens_.size() - begin_tokens,
+                          ProbeNow() - begin_ns);
+    }
+#endif
 }
 
-void Lexer::Scan()
+void Lexer::ScanTokens(const bool at_eof)
 {
-    for (cur_index_ = 0; cur_index_ < data_.source_.length();)
+    while (cur_index_ < data_.source_.length())
     {
         switch (data_.source_[cur_index_])
         {
         case '{':
-            data_.tokens_.push_back(MakeToken("{", TokenType::LBRACE));
+            AddToken(MakeToken("{", TokenType::LBRACE));
             Advance();
             break;
         case '}':
-            data_.tokens_.push_back(MakeToken("}", TokenType::RBRACE));
+            AddToken(MakeToken("}", TokenType::RBRACE));
             Advance();
             break;
         case '[':
-            data_.tokens_.push_back(MakeToken("[", TokenType::LBRACKET));
+            AddToken(MakeToken("[", TokenType::LBRACKET));
             Advance();
             break;
         case ']':
-            data_.tokens_.push_back(MakeToken("]", TokenType::RBRACKET));
+            AddToken(MakeToken("]", TokenType::RBRACKET));
             Advance();
             break;
         case ',':
-            data_.tokens_.push_back(MakeToken(",", TokenType::COMMA));
+            AddToken(MakeToken(",", TokenType::COMMA));
             Advance();
             break;
         case ':':
-            data_.tokens_.push_back(MakeToken(":", TokenType::COLON));
+            AddToken(MakeToken(":", TokenType::COLON));
             Advance();
             break;
-        case '\"': {
-            Token return_token;
-            ErrInfo err_info;
-            if (ParseString(return_token, err_info))
+        case '\"':
+            if (!ScanToken(&Lexer::ParseString, at_eof))
             {
-                data_.tokens_.push_back(std::move(return_token));
-            }
-            else
-            {
-                err_reporter_.AddError(std::move(err_info));
-                while (!TokenIsOver())
-                {
-                    Advance();
-                }
+                return;
             }
-        }
-        break;
+            break;
         case '-':
         case '0':
         case '1':
@@ -133,42 +283,20 @@ void Lexer::Scan()
         case '6':
         case '7':
         case '8':
-        case '9': {
-            Token return_token;
-            ErrInfo err_info;
-            if (ParseNumber(return_token, err_info))
-            {
-                data_.tokens_.push_back(std::move(return_token));
-            }
-            else
+        case '9':
+            if (!ScanToken(&Lexer::ParseNumber, at_eof))
             {
-                err_reporter_.AddError(std::move(err_info));
-                while (!TokenIsOver())
-                {
-                    Advance();
-                }
+                return;
             }
             break;
-        }
         case 't':
         case 'f':
-        case 'n': {
-            Token return_token;
-            ErrInfo err_info;
-            if (ParseLiteral(return_token, err_info))
+        case 'n':
+            if (!ScanToken(&Lexer::ParseLiteral, at_eof))
             {
-                data_.tokens_.push_back(std::move(return_token));
-            }
-            else
-            {
-                err_reporter_.AddError(std::move(err_info));
-                while (!TokenIsOver())
-                {
-                    Advance();
-                }
+                return;
             }
             break;
-        }
         case '\n':
             // 额外添加分支处理换行符记录，这样不用在一开始将原始json字符串拆分，性能更好
             Advance();
@@ -184,12 +312,10 @@ void Lexer::Scan()
             else
             {
                 // 初始化返回参数
-                const POS_T line_begin = data_.lines_index_[cur_row_].first;
-                const POS_T line_end = data_.lines_index_[cur_row_].second;
-                ErrInfo err_info = {ERR_UNKNOWN_VALUE, data_.source_.substr(line_begin, line_end - line_begin),
-                                    cur_row_, cur_col_, 0};
+                ErrInfo err_info = {ERR_UNKNOWN_VALUE, std::string(data_.Line(cur_row_)), cur_row_, cur_col_, 0};
 
                 // 找到token结束位置
+                const POS_T begin_index = cur_index_;
                 LENGTH_T count = 0;
                 while (!IsAscii(data_.source_[cur_index_]) || !TokenIsOver())
                 {
@@ -197,14 +323,137 @@ void Lexer::Scan()
                     ++count;
                 }
 
+                if (!at_eof && IsAtEnd())
+                {
+                    // 无法识别的内容到达了已有数据的末尾，等后续数据到达后重新扫描
+                    RewindTruncated(begin_index, err_info.col_);
+                    return;
+                }
+
                 err_info.len_ = count;
                 err_reporter_.AddError(std::move(err_info));
             }
         }
     }
 
-    // 最后读完字符串添加一个EOF
-    data_.tokens_.push_back(MakeToken("", TokenType::EOF_));
+    if (at_eof)
+    {
+        // 最后读完字符串添加一个EOF
+        AddToken(MakeToken("", TokenType::EOF_));
+    }
+}
+
+bool Lexer::ScanToken(bool (Lexer::*parse)(Token &, ErrInfo &), const bool at_eof)
+{
+    const POS_T begin_index = cur_index_;
+    const POS_T begin_col = cur_col_;
+
+    Token return_token;
+    if (!spare_values_.empty())
+    {
+        return_token.raw_value_ = std::move(spare_values_.back());
+        spare_values_.pop_back();
+    }
+#if PARSE_STATS
+    const size_t value_capacity = return_token.raw_value_.capacity();
+#endif
+    ErrInfo err_info;
+    const bool parsed = (this->*parse)(return_token, err_info);
+    if (!parsed)
+    {
+        // 所在行的内容只在出错时复制
+        err_info.current_line_ = data_.Line(err_info.row_);
+        while (!TokenIsOver())
+        {
+            Advance();
+        }
+    }
+
+    if (!at_eof && IsAtEnd())
+    {
+        // token到达了已有数据的末尾，可能被数据块截断，回退到token起点，等后续数据到达后重新扫描
+        RewindTruncated(begin_index, begin_col);
+        return false;
+    }
+
+    if (parsed)
+    {
+#if PARSE_STATS
+        // 被截断后重新扫描的token只在最终被接受时计入
+        NoteGrowth(value_capacity, return_token.raw_value_.capacity(), 1);
+        if (return_token.type_ == TokenType::STR)
+        {
+            ++CurrentParseStats().strings_;
+            CurrentParseStats().escapes_ += token_escapes_;
+        }
+#endif
+        AddToken(std::move(return_token));
+    }
+    else
+    {
+        err_reporter_.AddError(std::move(err_info));
+    }
+    return true;
+}
+
+void Lexer::RewindTruncated(const POS_T begin_index, const POS_T begin_col) noexcept
+{
+    cur_index_ = begin_index;
+    cur_col_ = begin_col;
+
+    // 字符串从引号之后开始检查，其他token从起点开始检查
+    truncated_ = true;
+    truncated_string_ = data_.source_[begin_index] == '\"';
+    truncated_escaped_ = false;
+    truncated_checked_ = truncated_string_ ? begin_index + 1 : begin_index;
+}
+
+bool Lexer::TruncatedCanEnd() noexcept
+{
+    // 重新扫描的结果只取决于数据本身，推迟扫描不会改变结果，这里只需要保证每个字节只检查一次
+    const std::string &source = data_.source_;
+    for (; truncated_checked_ < source.length(); ++truncated_checked_)
+    {
+        const char cur_char = source[truncated_checked_];
+        if (truncated_string_)
+        {
+            if (truncated_escaped_)
+            {
+                truncated_escaped_ = false;
+            }
+            else if (cur_char == '\\')
+            {
+                truncated_escaped_ = true;
+            }
+            else if (cur_char == '\"')
+            {
+                return true;
+            }
+        }
+        else if (IsAscii(cur_char) && (std::isspace(cur_char) != 0 || cur_char == ']' || cur_char == '}' ||
+                                       cur_char == ',' || cur_char == ':' || cur_char == '\0'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Lexer::AddToken(Token &&token)
+{
+#if PARSE_STATS
+    ++CurrentParseStats().tokens_[static_cast<size_t>(token.type_)];
+    const size_t tokens_capacity = data_.tokens_.capacity();
+#endif
+
+    data_.tokens_.push_back(std::move(token));
+
+#if PARSE_STATS
+    if (data_.tokens_.capacity() != tokens_capacity)
+    {
+        NoteAllocation(data_.tokens_.capacity() * sizeof(Token));
+    }
+#endif
 }
 
 bool Lexer::TokenIsOver() const noexcept
@@ -239,6 +488,16 @@ char Lexer::Advance() noexcept
     return '\0';
 }
 
+void Lexer::InitToken(Token &token, const TokenType type) const noexcept
+{
+    // 保留raw_value_的容量，它可能来自备用池
+    token.raw_value_.clear();
+    token.type_ = type;
+    token.row_ = cur_row_;
+    token.col_ = cur_col_;
+    token.len_ = 0;
+}
+
 Token Lexer::MakeToken(std::string &&str, TokenType type) const noexcept
 {
     const LENGTH_T token_len = str.length();
@@ -248,10 +507,12 @@ Token Lexer::MakeToken(std::string &&str, TokenType type) const noexcept
 bool Lexer::ParseString(Token &return_token, ErrInfo &err_info)
 {
     // 初始化返回参数
-    return_token = {"", TokenType::STR, cur_row_, cur_col_, 0};
-    const POS_T line_begin = data_.lines_index_[cur_row_].first;
-    const POS_T line_end = data_.lines_index_[cur_row_].second;
-    err_info = {"", data_.source_.substr(line_begin, line_end - line_begin), cur_row_, cur_col_, 0};
+    InitToken(return_token, TokenType::STR);
+    err_info.row_ = cur_row_;
+    err_info.col_ = cur_col_;
+#if PARSE_STATS
+    token_escapes_ = 0;
+#endif
 
     StringDfaStat cur_stat = StringDfaStat::STRING_START;
     std::string unicode_buffer; // 暂时存储unicode转移序列
@@ -261,7 +522,7 @@ bool Lexer::ParseString(Token &return_token, ErrInfo &err_info)
 
     while (cur_stat != StringDfaStat::STRING_END && cur_stat != StringDfaStat::ERROR)
     {
-        if (IsEndOfLine())
+        if (IsEndOfLine() || IsAtEnd())
         {
             // 在非StringDfaStat::STRING_END情况下结束一行，意味着json字符串没有被引号括起来
             cur_stat = StringDfaStat::ERROR;
@@ -274,540 +535,199 @@ bool Lexer::ParseString(Token &return_token, ErrInfo &err_info)
         switch (cur_stat)
         {
         case StringDfaStat::STRING_START:
-            if (cur_char == '"')
-            {
-                cur_stat = StringDfaStat::IN_STRING;
-            }
-            else
-            {
-                cur_stat = StringDfaStat::ERROR;
-                err_info.err_desc_ = ERR_MISSING_QUOTATION_MARK;
-            }
-
-            Advance();
-            break;
-
-        case StringDfaStat::IN_STRING:
-            if (cur_char == '"')
-            {
-                cur_stat = StringDfaStat::STRING_END;
-            }
-            else if (cur_char == '\\')
-            {
-                cur_stat = StringDfaStat::STRING_ESCAPE;
-            }
-            else
-            {
-                return_token.raw_value_ += cur_char;
-            }
-
-            ++err_highlight_len;
-            Advance();
-            break;
-
-        case StringDfaStat::STRING_ESCAPE:
-            switch (cur_char)
-            {
-            case '\\':
-                return_token.raw_value_ += '\\';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case '"':
-                return_token.raw_value_ += '"';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case '/':
-                return_token.raw_value_ += '/';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case 'b':
-                return_token.raw_value_ += '\b';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case 'f':
-                return_token.raw_value_ += '\f';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case 'r':
-                return_token.raw_value_ += '\r';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case 'n':
-                return_token.raw_value_ += '\n';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case 't':
-                return_token.raw_value_ += '\t';
-                cur_stat = StringDfaStat::IN_STRING;
-                break;
-            case 'u':
-                cur_stat = StringDfaStat::STRING_UNICODE_START;
-                unicode_buffer = "\\u";
-                break;
-            default:
-                cur_stat = StringDfaStat::ERROR;
-                err_info.err_desc_ = ERR_INVALID_ESCAPE;
-                break;
-            }
-
-            err_highlight_len += 2; // 一个"\"转义序列长度，例如"\n"
-            Advance();
-            break;
-
-        case StringDfaStat::STRING_UNICODE_START:
-            for (int i = 0; i < 4; ++i)
-            {
-                if (IsEndOfLine())
-                {
-                    cur_stat = StringDfaStat::ERROR;
-                    err_info.err_desc_ = ERR_INCOMPLETE_UNICODE_ESCAPE;
-                    break;
-                }
-
-                if (const char cur = Current();
-                    std::isdigit(cur) != 0 || (cur >= 'a' && cur <= 'f') || (cur >= 'A' && cur <= 'F'))
-                {
-                    unicode_buffer += cur;
-                    Advance();
-                }
-                else
-                {
-                    cur_stat = StringDfaStat::ERROR;
-                    err_info.err_desc_ = ERR_INVALID_UNICODE_ESCAPE;
-                    break;
-                }
-            }
-            if (cur_stat != StringDfaStat::ERROR)
-            {
-                return_token.raw_value_ += ConvertUnicodeEscape(unicode_buffer);
-                cur_stat = StringDfaStat::IN_STRING;
-            }
-
-            err_highlight_len += 4; // 一个unicode序列长度，例如"4e00"
-            break;
-        }
-    }
-
-    return_token.len_ = return_token.raw_value_.length() + 2; // 这里的数字2为引号""本身长度
-    err_info.len_ = err_highlight_len;
-
-    return cur_stat == StringDfaStat::STRING_END;
-}
-
-bool Lexer::ParseNumber(Token &return_token, ErrInfo &err_info)
-{
-    // 初始化返回参数
-    return_token = {"", TokenType::NUM, cur_row_, cur_col_, 0};
-    const POS_T line_begin = data_.lines_index_[cur_row_].first;
-    const POS_T line_end = data_.lines_index_[cur_row_].second;
-    err_info = {"", data_.source_.substr(line_begin, line_end - line_begin), cur_row_, cur_col_, 0};
-
-    NumberDfaStat cur_stat = NumberDfaStat::NUMBER_START;
-
-    while (cur_stat != NumberDfaStat::NUMBER_END && cur_stat != NumberDfaStat::ERROR)
-    {
-        const char cur_char = Current();
-        if (TokenIsOver())
-        {
-            if (cur_stat == NumberDfaStat::NUMBER_ZERO || cur_stat == NumberDfaStat::NUMBER_INTEGRAL ||
-                cur_stat == NumberDfaStat::NUMBER_EXPONENT || cur_stat == NumberDfaStat::NUMBER_FRACTION)
-            {
-                cur_stat = NumberDfaStat::NUMBER_END;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INCOMPLETE_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-        }
-
-        switch (cur_stat)
-        {
-        case NumberDfaStat::NUMBER_START:
-            if (cur_char == '0')
-            {
-                cur_stat = NumberDfaStat::NUMBER_ZERO;
-            }
-            else if (cur_char == '-')
-            {
-                cur_stat = NumberDfaStat::NUMBER_SIGN;
-            }
-            else if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_INTEGRAL;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_ZERO:
-            if (cur_char == '.')
-            {
-                cur_stat = NumberDfaStat::NUMBER_FRACTION_BEGIN;
-            }
-            else if (cur_char == 'e' || cur_char == 'E')
-            {
-                cur_stat = NumberDfaStat::NUMBER_EXPONENT_BEGIN;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_SIGN:
-            if (cur_char == '0')
-            {
-                cur_stat = NumberDfaStat::NUMBER_ZERO;
-            }
-            else if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_INTEGRAL;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_INTEGRAL:
-            if (cur_char == '.')
-            {
-                cur_stat = NumberDfaStat::NUMBER_FRACTION_BEGIN;
-            }
-            else if (cur_char == 'e' || cur_char == 'E')
-            {
-                cur_stat = NumberDfaStat::NUMBER_EXPONENT_BEGIN;
-            }
-            else if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_INTEGRAL;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_FRACTION_BEGIN:
-            if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_FRACTION;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_FRACTION:
-            if (cur_char == 'e' || cur_char == 'E')
-            {
-                cur_stat = NumberDfaStat::NUMBER_EXPONENT_BEGIN;
-            }
-            else if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_FRACTION;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_EXPONENT_BEGIN:
-            if (cur_char == '-')
-            {
-                cur_stat = NumberDfaStat::NUMBER_EXPONENT_SIGN;
-            }
-            else if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_EXPONENT;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_EXPONENT_SIGN:
-            if (std::isdigit(cur_char) != 0)
-            {
-                cur_stat = NumberDfaStat::NUMBER_EXPONENT;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-
-        case NumberDfaStat::NUMBER_EXPONENT:
-            if (std::isdigit(cur_char) == 0)
-            {
-                err_info.err_desc_ = ERR_INVALID_NUMBER;
-                cur_stat = NumberDfaStat::ERROR;
-            }
-            break;
-        }
-        return_token.raw_value_ += cur_char;
-        Advance();
-    }
-
-    const POS_T token_len = return_token.raw_value_.length();
-    return_token.len_ = token_len;
-    err_info.len_ = token_len;
-
-    return cur_stat == NumberDfaStat::NUMBER_END;
-}
-
-bool Lexer::ParseLiteral(Token &return_token, ErrInfo &err_info)
-{
-    // 初始化返回参数
-    return_token = {"", TokenType::TRUE, cur_row_, cur_col_, 0};
-    const POS_T line_begin = data_.lines_index_[cur_row_].first;
-    const POS_T line_end = data_.lines_index_[cur_row_].second;
-    err_info = {"", data_.source_.substr(line_begin, line_end - line_begin), cur_row_, cur_col_, 0};
-
-    LiteralDfaStat cur_stat = LiteralDfaStat::LITERAL_START;
-
-    while (cur_stat != LiteralDfaStat::LITERAL_END && cur_stat != LiteralDfaStat::ERROR)
-    {
-        // 已经到达行结尾，但是字面量没有到最后一个字符，则认为字面量不完整
-        if (IsEndOfLine() && cur_stat != LiteralDfaStat::TRUE_E && cur_stat != LiteralDfaStat::FALSE_E &&
-            cur_stat != LiteralDfaStat::NULL_L2)
-        {
-            cur_stat = LiteralDfaStat::ERROR;
-            err_info.err_desc_ = ERR_INVALID_LITERAL;
-            break;
-        }
-
-        const char cur_char = Current();
-
-        switch (cur_stat)
-        {
-        case LiteralDfaStat::LITERAL_START:
-            if (cur_char == 't')
-            {
-                return_token.type_ = TokenType::TRUE;
-                cur_stat = LiteralDfaStat::TRUE_T;
-            }
-            else if (cur_char == 'f')
-            {
-                return_token.type_ = TokenType::FALSE;
-                cur_stat = LiteralDfaStat::FALSE_F;
-            }
-            else if (cur_char == 'n')
-            {
-                return_token.type_ = TokenType::NULL_;
-                cur_stat = LiteralDfaStat::NULL_N;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_LITERAL;
-                cur_stat = LiteralDfaStat::ERROR;
-            }
-
-            return_token.raw_value_ += cur_char;
-            Advance();
-            break;
-
-        case LiteralDfaStat::TRUE_T:
-            if (cur_char == 'r')
-            {
-                cur_stat = LiteralDfaStat::TRUE_R;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_TRUE);
-                cur_stat = LiteralDfaStat::ERROR;
-            }
-
-            return_token.raw_value_ += cur_char;
-            Advance();
-            break;
-
-        case LiteralDfaStat::TRUE_R:
-            if (cur_char == 'u')
-            {
-                cur_stat = LiteralDfaStat::TRUE_U;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_TRUE);
-                cur_stat = LiteralDfaStat::ERROR;
-            }
-
-            return_token.raw_value_ += cur_char;
-            Advance();
-            break;
-
-        case LiteralDfaStat::TRUE_U:
-            if (cur_char == 'e')
+            if (cur_char == '"')
             {
-                cur_stat = LiteralDfaStat::TRUE_E;
+                cur_stat = StringDfaStat::IN_STRING;
             }
             else
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_TRUE);
-                cur_stat = LiteralDfaStat::ERROR;
+                cur_stat = StringDfaStat::ERROR;
+                err_info.err_desc_ = ERR_MISSING_QUOTATION_MARK;
             }
 
-            return_token.raw_value_ += cur_char;
             Advance();
             break;
 
-        case LiteralDfaStat::TRUE_E:
-            if (TokenIsOver())
-            {
-                cur_stat = LiteralDfaStat::LITERAL_END;
-            }
-            else
+        case StringDfaStat::IN_STRING:
+            if (cur_char == '"')
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_TRUE);
-                cur_stat = LiteralDfaStat::ERROR;
+                cur_stat = StringDfaStat::STRING_END;
             }
-            break;
-
-        case LiteralDfaStat::FALSE_F:
-            if (cur_char == 'a')
+            else if (cur_char == '\\')
             {
-                cur_stat = LiteralDfaStat::FALSE_A;
+                cur_stat = StringDfaStat::STRING_ESCAPE;
             }
             else
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_FALSE);
-                cur_stat = LiteralDfaStat::ERROR;
+                return_token.raw_value_ += cur_char;
             }
 
-            return_token.raw_value_ += cur_char;
+            ++err_highlight_len;
             Advance();
             break;
 
-        case LiteralDfaStat::FALSE_A:
-            if (cur_char == 'l')
-            {
-                cur_stat = LiteralDfaStat::FALSE_L;
-            }
-            else
+        case StringDfaStat::STRING_ESCAPE:
+#if PARSE_STATS
+            ++token_escapes_;
+#endif
+            if (const char unescaped = UnescapeChar(cur_char); unescaped != '\0')
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_FALSE);
-                cur_stat = LiteralDfaStat::ERROR;
+                return_token.raw_value_ += unescaped;
+                cur_stat = StringDfaStat::IN_STRING;
             }
-
-            return_token.raw_value_ += cur_char;
-            Advance();
-            break;
-
-        case LiteralDfaStat::FALSE_L:
-            if (cur_char == 's')
+            else if (cur_char == 'u')
             {
-                cur_stat = LiteralDfaStat::FALSE_S;
+                cur_stat = StringDfaStat::STRING_UNICODE_START;
+                unicode_buffer = "\\u";
             }
             else
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_FALSE);
-                cur_stat = LiteralDfaStat::ERROR;
+                cur_stat = StringDfaStat::ERROR;
+                err_info.err_desc_ = ERR_INVALID_ESCAPE;
             }
 
-            return_token.raw_value_ += cur_char;
+            err_highlight_len += 2; // 一个"\"转义序列长度，例如"\n"
             Advance();
             break;
 
-        case LiteralDfaStat::FALSE_S:
-            if (cur_char == 'e')
+        case StringDfaStat::STRING_UNICODE_START:
+            for (int i = 0; i < 4; ++i)
             {
-                cur_stat = LiteralDfaStat::FALSE_E;
+                if (IsEndOfLine() || IsAtEnd())
+                {
+                    cur_stat = StringDfaStat::ERROR;
+                    err_info.err_desc_ = ERR_INCOMPLETE_UNICODE_ESCAPE;
+                    break;
+                }
+
+                if (const char cur = Current(); IsHexDigit(cur))
+                {
+                    unicode_buffer += cur;
+                    Advance();
+                }
+                else
+                {
+                    cur_stat = StringDfaStat::ERROR;
+                    err_info.err_desc_ = ERR_INVALID_UNICODE_ESCAPE;
+                    break;
+                }
             }
-            else
+            if (cur_stat != StringDfaStat::ERROR)
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_FALSE);
-                cur_stat = LiteralDfaStat::ERROR;
+                return_token.raw_value_ += ConvertUnicodeEscape(unicode_buffer);
+                cur_stat = StringDfaStat::IN_STRING;
             }
 
-            return_token.raw_value_ += cur_char;
-            Advance();
+            err_highlight_len += 4; // 一个unicode序列长度，例如"4e00"
             break;
+        }
+    }
 
-        case LiteralDfaStat::FALSE_E:
-            if (TokenIsOver())
+    // token长度按原始文本计算，包括引号和转义序列，这样row_、col_、len_可以准确还原出token在源字符串中的位置
+    return_token.len_ = cur_col_ - return_token.col_;
+    err_info.len_ = err_highlight_len;
+
+    return cur_stat == StringDfaStat::STRING_END;
+}
+
+bool Lexer::ParseNumber(Token &return_token, ErrInfo &err_info)
+{
+    // 初始化返回参数
+    InitToken(return_token, TokenType::NUM);
+    err_info.row_ = cur_row_;
+    err_info.col_ = cur_col_;
+
+    NumberDfaStat cur_stat = NumberDfaStat::NUMBER_START;
+
+    while (cur_stat != NumberDfaStat::NUMBER_END && cur_stat != NumberDfaStat::ERROR)
+    {
+        const char cur_char = Current();
+        if (TokenIsOver())
+        {
+            if (IsNumberAccepting(cur_stat))
             {
-                cur_stat = LiteralDfaStat::LITERAL_END;
+                cur_stat = NumberDfaStat::NUMBER_END;
             }
             else
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_FALSE);
-                cur_stat = LiteralDfaStat::ERROR;
+                err_info.err_desc_ = ERR_INCOMPLETE_NUMBER;
+                cur_stat = NumberDfaStat::ERROR;
             }
             break;
+        }
 
-        case LiteralDfaStat::NULL_N:
-            if (cur_char == 'u')
-            {
-                cur_stat = LiteralDfaStat::NULL_U;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_NULL);
-                cur_stat = LiteralDfaStat::ERROR;
-            }
+        cur_stat = NextNumberStat(cur_stat, cur_char);
+        if (cur_stat == NumberDfaStat::ERROR)
+        {
+            err_info.err_desc_ = ERR_INVALID_NUMBER;
+        }
+        return_token.raw_value_ += cur_char;
+        Advance();
+    }
 
-            return_token.raw_value_ += cur_char;
-            Advance();
-            break;
+    const POS_T token_len = return_token.raw_value_.length();
+    return_token.len_ = token_len;
+    err_info.len_ = token_len;
 
-        case LiteralDfaStat::NULL_U:
-            if (cur_char == 'l')
-            {
-                cur_stat = LiteralDfaStat::NULL_L1;
-            }
-            else
-            {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_NULL);
-                cur_stat = LiteralDfaStat::ERROR;
-            }
+    return cur_stat == NumberDfaStat::NUMBER_END;
+}
 
-            return_token.raw_value_ += cur_char;
-            Advance();
+bool Lexer::ParseLiteral(Token &return_token, ErrInfo &err_info)
+{
+    // 初始化返回参数
+    InitToken(return_token, TokenType::TRUE);
+    err_info.row_ = cur_row_;
+    err_info.col_ = cur_col_;
+
+    LiteralDfaStat cur_stat = LiteralDfaStat::LITERAL_START;
+
+    while (cur_stat != LiteralDfaStat::LITERAL_END && cur_stat != LiteralDfaStat::ERROR)
+    {
+        // 已经到达行结尾，但是字面量没有到最后一个字符，则认为字面量不完整
+        if (IsEndOfLine() && !IsLiteralAccepting(cur_stat))
+        {
+            cur_stat = LiteralDfaStat::ERROR;
+            err_info.err_desc_ = ERR_INVALID_LITERAL;
             break;
+        }
 
-        case LiteralDfaStat::NULL_L1:
-            if (cur_char == 'l')
+        // 字面量的所有字符都已读完，后面必须紧跟token结束符
+        if (IsLiteralAccepting(cur_stat))
+        {
+            if (TokenIsOver())
             {
-                cur_stat = LiteralDfaStat::NULL_L2;
+                cur_stat = LiteralDfaStat::LITERAL_END;
             }
             else
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_NULL);
+                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LiteralGuess(cur_stat));
                 cur_stat = LiteralDfaStat::ERROR;
             }
-
-            return_token.raw_value_ += cur_char;
-            Advance();
             break;
+        }
 
-        case LiteralDfaStat::NULL_L2:
-            if (TokenIsOver())
+        const char cur_char = Current();
+        const LiteralDfaStat next_stat = NextLiteralStat(cur_stat, cur_char);
+        if (next_stat == LiteralDfaStat::ERROR)
+        {
+            err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LiteralGuess(cur_stat));
+        }
+        else if (cur_stat == LiteralDfaStat::LITERAL_START)
+        {
+            // 根据首字母确定字面量的类型
+            if (next_stat == LiteralDfaStat::FALSE_F)
             {
-                cur_stat = LiteralDfaStat::LITERAL_END;
+                return_token.type_ = TokenType::FALSE;
             }
-            else
+            else if (next_stat == LiteralDfaStat::NULL_N)
             {
-                err_info.err_desc_ = ERR_INVALID_LITERAL + std::string(LITERAL_GUESS_NULL);
-                cur_stat = LiteralDfaStat::ERROR;
+                return_token.type_ = TokenType::NULL_;
             }
-            break;
         }
+        cur_stat = next_stat;
+
+        return_token.raw_value_ += cur_char;
+        Advance();
     }
 
     const POS_T token_len = return_token.raw_value_.length();
@@ -822,7 +742,57 @@ JsonValue Parser::GetJsonAst() const noexcept
     return json_;
 }
 
+JsonValue Parser::TakeJsonAst() noexcept
+{
+    return std::move(json_);
+}
+
+JsonValue Parser::Parse(JsonData &json_data)
+{
+    // 借用调用者的缓冲区，解析结束后交还，两次交换都不会分配内存
+    std::swap(json_data_, json_data);
+    json_ = JsonValue();
+    cur_token_index_ = 0;
+    depth_ = 0;
+    err_reporter_.Clear();
+
+    Parse();
+    std::swap(json_data_, json_data);
+
+    if (err_reporter_.HasError())
+    {
+        err_reporter_.ThrowError(true);
+    }
+    return std::move(json_);
+}
+
 void Parser::Parse() noexcept
+{
+#if USDT_PROBES
+    SIMPLE_JSON_PROBE(parse_start, json_data_.tokens_.size());
+    const uint64_t begin_ns = SIMPLE_JSON_PROBE_CLOCK(parse_done);
+#endif
+
+#if PARSE_STATS
+    {
+        const StatsTimer timer(&ParseStats::parse_ns_);
+        ParseTopLevel();
+    }
+    FinishParseStats();
+#else
+    ParseTopLevel();
+#endif
+
+#if USDT_PROBES
+    if (begin_ns != 0)
+    {
+        SIMPLE_JSON_PROBE(parse_done, json_data_.tokens_.size(), ProbeNow() - begin_ns);
+    }
+    ProbeDocumentDone(json_data_.source_.length(), json_data_.tokens_.size(), err_reporter_.HasError());
+#endif
+}
+
+void Parser::ParseTopLevel() noexcept
 {
     // 因为json顶层必须是对象或者数据，所以第一个json token肯定是"{"或者"]"
     if (const Token *cur_token = Current(); cur_token->type_ == TokenType::LBRACE)
@@ -841,6 +811,12 @@ void Parser::Parse() noexcept
 
 } // namespace simple_json
 
+JsonValue JsonParser::Parse(const std::string_view json_str)
+{
+    lexer_.Reset(json_str);
+    return parser_.Parse(lexer_.BorrowToken());
+}
+
 bool Parser::ParseValue(JsonValue &return_value) noexcept
 {
     switch (const Token *cur_token = Current(); cur_token->type_)
@@ -852,6 +828,9 @@ bool Parser::ParseValue(JsonValue &return_value) noexcept
         return_value = ParseArray();
         return true;
     case TokenType::STR:
+#if PARSE_STATS
+        NoteStringCopy(cur_token->raw_value_.size());
+#endif
         return_value = {cur_token->raw_value_};
         return true;
     case TokenType::NUM:
@@ -877,7 +856,11 @@ JsonValue Parser::ParseObject() noexcept
     if (!Consume(Current(), TokenType::LBRACE)) // need fix
     {
         MakeErrInfo(ERR_TYPE_NOT_OBJECT, Current());
-        return {ret_object};
+        return {std::move(ret_object)};
+    }
+    if (!EnterContainer())
+    {
+        return {std::move(ret_object)};
     }
     Advance();
 
@@ -902,6 +885,9 @@ JsonValue Parser::ParseObject() noexcept
             continue;
         }
         key = Current()->raw_value_;
+#if PARSE_STATS
+        NoteStringCopy(key.size());
+#endif
 
         // 字符串键后必须跟冒号
         if (!Consume(Peek(), TokenType::COLON))
@@ -943,7 +929,22 @@ JsonValue Parser::ParseObject() noexcept
             }
             continue;
         }
-        ret_object[key] = std::move(value);
+#if PARSE_STATS
+        const size_t object_size = ret_object.size();
+        const size_t bucket_count = ret_object.bucket_count();
+#endif
+        ret_object.insert_or_assign(std::move(key), std::move(value));
+#if PARSE_STATS
+        if (ret_object.size() != object_size)
+        {
+            // 每个成员一个节点，节点中还有next指针和缓存的哈希值
+            NoteAllocation(sizeof(std::pair<const std::string, JsonValue>) + 2 * sizeof(void *));
+        }
+        if (ret_object.bucket_count() != bucket_count)
+        {
+            NoteAllocation(ret_object.bucket_count() * sizeof(void *));
+        }
+#endif
         // 解析value的时候可能会遇到嵌套的数据结构走到EOF_的情况，我们必须处理这种情况
         if (Current()->type_ == TokenType::EOF_)
         {
@@ -995,7 +996,8 @@ JsonValue Parser::ParseObject() noexcept
     //     MakeErrInfo(ERR_OBJECT_NOT_CLOSED, prev_token);
     // }
 
-    return {ret_object};
+    --depth_;
+    return {std::move(ret_object)};
 }
 
 JsonValue Parser::ParseArray() noexcept
@@ -1004,7 +1006,11 @@ JsonValue Parser::ParseArray() noexcept
     if (!Consume(Current(), TokenType::LBRACKET))
     {
         MakeErrInfo(ERR_TYPE_NOT_ARRAY, Current());
-        return {ret_array};
+        return {std::move(ret_array)};
+    }
+    if (!EnterContainer())
+    {
+        return {std::move(ret_array)};
     }
     Advance();
 
@@ -1084,18 +1090,29 @@ JsonValue Parser::ParseArray() noexcept
     //     MakeErrInfo(ERR_ARRAY_NOT_CLOSED, last_token, last_token->col_ + last_token->len_, 1);
     // }
 
-    return {ret_array};
+#if PARSE_STATS
+    NoteGrowth(0, ret_array.capacity(), sizeof(JsonValue));
+#endif
+    --depth_;
+    return {std::move(ret_array)};
 }
 
 JsonValue Parser::ParseNumber() noexcept
 {
-    const Token *cur_token = Current();
-    if (cur_token->raw_value_.find('e') != std::string::npos || cur_token->raw_value_.find('.') != std::string::npos)
+#if PARSE_STATS
+    ++CurrentParseStats().numbers_;
+#endif
+
+    // 没有小数点和指数的数字为整数，超出long long范围时退化为浮点数
+    const std::string &raw = Current()->raw_value_;
+    long long int_value = 0;
+    if (raw.find_first_of(".eE") == std::string::npos &&
+        std::from_chars(raw.data(), raw.data() + raw.size(), int_value).ec == std::errc())
     {
-        return {std::stold(cur_token->raw_value_)};
+        return {std::move(int_value)};
     }
 
-    return {std::stoll(cur_token->raw_value_)};
+    return {std::strtold(raw.c_str(), nullptr)};
 }
 
 const Token *Parser::Current() const noexcept
@@ -1146,13 +1163,28 @@ void Parser::MakeErrInfo(std::string err_desc, const Token *cur_token, size_t hi
     highlight_len = highlight_len == 0 ? cur_token->len_ : highlight_len;
     highlight_pos = highlight_pos == 0 ? cur_token->col_ : highlight_pos;
 
-    const POS_T line_begin = json_data_.lines_index_[cur_token->row_].first;
-    const POS_T line_end = json_data_.lines_index_[cur_token->row_].second;
-    ErrInfo err_info{std::move(err_desc), json_data_.source_.substr(line_begin, line_end - line_begin), cur_token->row_,
+    ErrInfo err_info{std::move(err_desc), std::string(json_data_.Line(cur_token->row_)), cur_token->row_,
                      highlight_pos, highlight_len};
     err_reporter_.AddError(std::move(err_info));
 }
 
+bool Parser::EnterContainer() noexcept
+{
+    if (++depth_ <= MAX_PARSE_DEPTH)
+    {
+#if PARSE_STATS
+        CurrentParseStats().max_depth_ = std::max<uint64_t>(CurrentParseStats().max_depth_, depth_);
+#endif
+        return true;
+    }
+
+    // 嵌套过深时直接跳到EOF_，外层的每个容器看到EOF_后都会立即返回，不再继续递归
+    MakeErrInfo(ERR_NESTING_TOO_DEEP, Current());
+    cur_token_index_ = json_data_.tokens_.size() - 1;
+    --depth_;
+    return false;
+}
+
 void Parser::SynchronizeArr() noexcept
 {
     Advance();
@@ -1200,4 +1232,153 @@ void Parser::SynchronizeObj() noexcept
     }
 }
 
+const Token *TokenReader::Current() const noexcept
+{
+    if (cur_token_index_ < json_data_.tokens_.size())
+    {
+        return &json_data_.tokens_[cur_token_index_];
+    }
+    return &json_data_.tokens_.back(); // token流总是以EOF_结尾
+}
+
+const Token *TokenReader::Peek() const noexcept
+{
+    if (cur_token_index_ + 1 < json_data_.tokens_.size())
+    {
+        return &json_data_.tokens_[cur_token_index_ + 1];
+    }
+    return &json_data_.tokens_.back();
+}
+
+const Token *TokenReader::Advance() noexcept
+{
+    if (cur_token_index_ + 1 < json_data_.tokens_.size())
+    {
+        ++cur_token_index_;
+    }
+    return Current();
+}
+
+bool TokenReader::SkipValue(const char *&err_desc) noexcept
+{
+    // 跳过时仍按语法检查每个token，括号的种类记录在定长的栈中，不分配内存
+    enum class Expect : uint8_t
+    {
+        Value,
+        ValueOrClose, // 左中括号或数组中的逗号之后
+        Key,
+        KeyOrClose, // 左大括号或对象中的逗号之后
+        Colon,
+        CommaOrClose
+    };
+
+    std::bitset<MAX_PARSE_DEPTH> is_object;
+    size_t depth = 0;
+    Expect expect = Expect::Value;
+    while (true)
+    {
+        const TokenType type = Current()->type_;
+        bool closed = false;
+        switch (expect)
+        {
+        case Expect::Value:
+        case Expect::ValueOrClose:
+            if (type == TokenType::LBRACE || type == TokenType::LBRACKET)
+            {
+                if (depth == MAX_PARSE_DEPTH)
+                {
+                    err_desc = ERR_NESTING_TOO_DEEP;
+                    return false;
+                }
+                is_object[depth++] = type == TokenType::LBRACE;
+                expect = type == TokenType::LBRACE ? Expect::KeyOrClose : Expect::ValueOrClose;
+            }
+            else if (type == TokenType::STR || type == TokenType::NUM || type == TokenType::TRUE ||
+                     type == TokenType::FALSE || type == TokenType::NULL_)
+            {
+                closed = true;
+            }
+            else if (expect == Expect::ValueOrClose && type == TokenType::RBRACKET)
+            {
+                --depth;
+                closed = true;
+            }
+            else
+            {
+                err_desc = ERR_EXPECTED_JSON_VALUE_TYPE;
+                return false;
+            }
+            break;
+        case Expect::Key:
+        case Expect::KeyOrClose:
+            if (type == TokenType::STR)
+            {
+                expect = Expect::Colon;
+            }
+            else if (expect == Expect::KeyOrClose && type == TokenType::RBRACE)
+            {
+                --depth;
+                closed = true;
+            }
+            else
+            {
+                err_desc = ERR_OBJECT_KEY_MUST_BE_STRING;
+                return false;
+            }
+            break;
+        case Expect::Colon:
+            if (type != TokenType::COLON)
+            {
+                err_desc = ERR_COLON_EXPECTED;
+                return false;
+            }
+            expect = Expect::Value;
+            break;
+        case Expect::CommaOrClose:
+            if (type == TokenType::COMMA)
+            {
+                const TokenType next = Peek()->type_;
+                if (!ALLOW_TRAILING_COMMA && (next == TokenType::RBRACE || next == TokenType::RBRACKET))
+                {
+                    err_desc = ERR_TRAILING_COMMA;
+                    return false;
+                }
+                expect = is_object[depth - 1] ? Expect::KeyOrClose : Expect::ValueOrClose;
+            }
+            else if (type == (is_object[depth - 1] ? TokenType::RBRACE : TokenType::RBRACKET))
+            {
+                --depth;
+                closed = true;
+            }
+            else
+            {
+                err_desc = is_object[depth - 1] ? ERR_COMMA_OR_BRACE_EXPECTED : ERR_COMMA_OR_BRACKET_EXPECTED;
+                return false;
+            }
+            break;
+        }
+
+        // 一个值结束时，外层没有容器则跳过完成，否则等待逗号或右括号
+        if (closed)
+        {
+            if (depth == 0)
+            {
+                return true;
+            }
+            expect = Expect::CommaOrClose;
+        }
+        Advance();
+    }
+}
+
+ErrInfo TokenReader::MakeErrInfo(std::string err_desc, const Token *cur_token, size_t highlight_pos,
+                                 size_t highlight_len) const
+{
+    highlight_len = highlight_len == 0 ? cur_token->len_ : highlight_len;
+    highlight_pos = highlight_pos == 0 ? cur_token->col_ : highlight_pos;
+
+    return {std::move(err_desc), std::string(json_data_.Line(cur_token->row_)), cur_token->row_, highlight_pos,
+            highlight_len};
+}
+
 } // namespace simple_json
@@ -1,12 +1,31 @@
+#include "batch_parser.h"
+#include "cbor.h"
 #include "json.h"
+#include "json_bind.h"
+#include "json_diff.h"
+#include "json_editor.h"
+#include "json_patch.h"
+#include "json_path.h"
+#include "json_pointer.h"
 #include "json_type.h"
 #include "lexer_parser.h"
+#include "msgpack.h"
+#include "parse_cache.h"
+#include "parse_stats.h"
+#include "persistent_json.h"
+#include "record_table.h"
+#include "snapshot.h"
+#include "try_parse.h"
 #include "utilities.h"
 
+#include <chrono>
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace
 {
@@ -230,26 +249,26 @@ void JsonTest()
         std::cout << json << '\n';
 
         // std::string key("c++");
-        // std::cout << json[key].GetVal<simple_json::JsonType::String>() << '\n';
+        // std::cout << json[key].GetVal<jType::String>() << '\n';
         // // simple_json::JsonValue val = json[key];
-        // // std::cout << val.GetVal<simple_json::JsonType::String>() << '\n';
+        // // std::cout << val.GetVal<jType::String>() << '\n';
 
         // json[key] = simple_json::JsonValue::MakeArr({"hello", "world", "c++"});
-        // for (const auto &item : json[key].GetVal<simple_json::JsonType::Array>())
+        // for (const auto &item : json[key].GetVal<jType::Array>())
         // {
         //     std::cout << item << ' ';
         // }
         // std::cout << '\n';
 
         std::unordered_map<std::string, simple_json::JsonValue> hash =
-            json["word"]["c"]["q"][2].GetVal<simple_json::JsonType::Object>();
+            json["word"]["c"]["q"][2].GetVal<jType::Object>();
         for (const auto &pair : hash)
         {
             std::cout << pair.first << ": " << pair.second << '\n';
         }
         std::cout << '\n';
 
-        json["word"]["c"]["q"][2].GetVal<simple_json::JsonType::Object>().insert(
+        json["word"]["c"]["q"][2].GetVal<jType::Object>().insert(
             std::make_pair("1000", "I like doro!!"));
 
         std::cout << json << '\n';
@@ -260,6 +279,587 @@ void JsonTest()
     }
 }
 
+// 结构体绑定测试
+struct BindPoint
+{
+    long long x_;
+    long long y_;
+    std::string label_;
+};
+
+} // namespace
+
+JSON_BINDING(BindPoint, simple_json::MakeField("x", &BindPoint::x_), simple_json::MakeField("y", &BindPoint::y_),
+             simple_json::MakeField("label", &BindPoint::label_))
+
+namespace
+{
+
+void StructBindTest()
+{
+    try
+    {
+        const auto point = simple_json::DecodeStruct<BindPoint>(R"({"x": 1, "unknown": [1, {"a": 2}], "y": 2})");
+        std::cout << simple_json::EncodeStruct(point) << '\n';
+
+        const auto bad_point = simple_json::DecodeStruct<BindPoint>(R"({"x": "1"})");
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << e.what() << '\n';
+    }
+}
+
+void SchemaTest()
+{
+    try
+    {
+        const auto schema_json = simple_json::Json::FromString(std::string(R"({
+            "type": "object",
+            "required": ["id"],
+            "properties": {"id": {"type": "integer", "minimum": 1}, "tags": {"type": "array", "maxItems": 2}}
+        })"));
+        const auto schema = simple_json::JsonSchema::Compile(schema_json.GetValue());
+
+        std::cout << simple_json::Json::FromString(std::string(R"({"id": 3, "tags": ["a"]})"), schema) << '\n';
+        schema.Validate(R"({"id": 3, "tags": ["a", "b", "c"]})");
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << e.what() << '\n';
+    }
+}
+
+void JsonPointerTest()
+{
+    auto json = simple_json::Json::FromString(std::string(R"({"a": {"b": [10, {"c": "x"}], "m~n": 1}})"));
+
+    const simple_json::JsonPointer pointer("/a/b/1/c");
+    if (const auto *value = pointer.Resolve(json.GetValue()); value != nullptr)
+    {
+        std::cout << pointer.ToString() << " = " << *value << '\n';
+    }
+
+    simple_json::JsonPointerBatch batch;
+    batch.Add(simple_json::JsonPointer("/a/b/0"));
+    batch.Add(simple_json::JsonPointer("/a/m~0n"));
+    batch.Add(simple_json::JsonPointer("/a/missing"));
+
+    std::vector<const simple_json::JsonValue *> results;
+    batch.Resolve(json.GetValue(), results);
+    for (const auto *value : results)
+    {
+        if (value != nullptr)
+        {
+            std::cout << *value << '\n';
+        }
+        else
+        {
+            std::cout << "miss" << '\n';
+        }
+    }
+}
+
+void JsonPathTest()
+{
+    const std::string json_str =
+        R"({"items": [{"name": "a", "price": 5}, {"name": "b", "price": 15}, {"name": "c", "price": 8}], "total": 28})";
+
+    for (const auto &value : simple_json::JsonPath("$.items[*].price").Query(json_str))
+    {
+        std::cout << value << '\n';
+    }
+    for (const auto &value : simple_json::JsonPath("$.items[?(@.price < 10)].name").Query(json_str))
+    {
+        std::cout << value << '\n';
+    }
+}
+
+void ProjectionTest()
+{
+    const simple_json::FieldSet fields{"user.id", "user.name", "event.ts"};
+    std::cout << simple_json::Json::FromString(
+                     std::string(R"({"user": {"id": 1, "name": "n", "token": "x"}, "event": {"ts": 9}, "rest": [1, 2]})"),
+                     fields)
+              << '\n';
+
+    // 重复的键与完整解析一样以最后一个为准
+    const std::string duplicated(R"({"user": {"id": 1}, "event": {"ts": 9}, "user": {"id": 2, "name": "m"}})");
+    std::string projected;
+    simple_json::AppendJson(projected, simple_json::Json::FromString(duplicated, fields).GetValue());
+    std::cout << projected << '\n';
+}
+
+void JsonEditorTest()
+{
+    simple_json::JsonEditor editor(std::string("{\n    \"name\": \"server\",\n    \"port\" : 80,  \"tags\": [ \"a\" ]\n}\n"));
+    editor.Set(simple_json::JsonPointer("/port"), simple_json::JsonValue(8080LL));
+    editor.Set(simple_json::JsonPointer("/tags/-"), simple_json::JsonValue(std::string("b")));
+    std::cout << editor.ToString();
+}
+
+void PatchBenchmark()
+{
+    // 构造一个包含十万个元素的大文档
+    constexpr long long ITEM_COUNT = 100000;
+    std::vector<jValue> items;
+    items.reserve(ITEM_COUNT);
+    for (long long i = 0; i < ITEM_COUNT; ++i)
+    {
+        items.push_back(jValue::MakeObj({{"id", jValue(static_cast<long long>(i))},
+                                         {"name", jValue("item" + std::to_string(i))},
+                                         {"price", jValue(static_cast<long double>(i) * 1.5L)},
+                                         {"tags", jValue::MakeArr({jValue("a"), jValue("b")})}}));
+    }
+    jValue document = jValue::MakeObj({{"items", jValue(std::move(items))}});
+
+    const auto patch = simple_json::JsonPatch::Compile(simple_json::Json::FromString(std::string(R"([
+        {"op": "test", "path": "/items/500/id", "value": 500},
+        {"op": "replace", "path": "/items/500/price", "value": 1.25},
+        {"op": "add", "path": "/items/500/tags/-", "value": "c"},
+        {"op": "move", "from": "/items/500/tags/0", "path": "/items/500/first_tag"},
+        {"op": "remove", "path": "/items/500/first_tag"}
+    ])")).GetValue());
+
+    constexpr int ROUNDS = 200000;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        patch.Apply(document);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    std::cout << "json patch: " << ROUNDS << " patches (5 ops each) in " << seconds << "s, " << ROUNDS / seconds
+              << " patches/s\n";
+
+    const auto merge_patch =
+        simple_json::Json::FromString(std::string(R"({"items": null, "meta": {"version": 2, "owner": "ops"}})"))
+            .GetValue();
+    jValue small = jValue::MakeObj({{"meta", jValue::MakeObj({{"version", jValue(1LL)}})}, {"flag", jValue(true)}});
+    const auto merge_begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        simple_json::ApplyMergePatch(small, merge_patch);
+    }
+    const double merge_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - merge_begin).count();
+    std::cout << "merge patch: " << ROUNDS << " patches in " << merge_seconds << "s, " << ROUNDS / merge_seconds
+              << " patches/s\n";
+
+    // move之后失败的patch回滚时，被移动的值要回到原处
+    const std::pair<const char *, const char *> rollbacks[] = {
+        {R"({"a":1})", R"([{"op": "move", "from": "/a", "path": "/x/y"}])"},
+        {R"({"a":1,"b":2})",
+         R"([{"op": "move", "from": "/a", "path": "/b"}, {"op": "test", "path": "/b", "value": 99}])"},
+        {R"({"a":[1,2],"b":{}})",
+         R"([{"op": "move", "from": "/a/0", "path": "/b/c"}, {"op": "remove", "path": "/z"}])"},
+        {R"({"a":[1,2]})",
+         R"([{"op": "move", "from": "/a/1", "path": "/a/0"}, {"op": "test", "path": "", "value": 0}])"},
+        {R"({"a":{"b":1}})", R"([{"op": "move", "from": "/a", "path": ""}, {"op": "remove", "path": "/a"}])"},
+    };
+    for (const auto &[doc_str, patch_str] : rollbacks)
+    {
+        const jValue original = simple_json::Json::FromString(std::string(doc_str)).GetValue();
+        jValue rolled_back = original;
+        try
+        {
+            simple_json::JsonPatch::Compile(simple_json::Json::FromString(std::string(patch_str)).GetValue())
+                .Apply(rolled_back);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cout << e.what() << '\n';
+        }
+        std::string serialized;
+        simple_json::AppendJson(serialized, rolled_back);
+        std::cout << doc_str << " -> " << serialized << (rolled_back == original ? " ok\n" : " BROKEN\n");
+    }
+}
+
+void DiffTest()
+{
+    const auto source = simple_json::Json::FromString(std::string(
+        R"({"name": "service", "replicas": 2, "ports": [80, 443], "labels": {"tier": "web", "env": "dev"}})"));
+    const auto target = simple_json::Json::FromString(std::string(
+        R"({"name": "service", "replicas": 3, "ports": [80, 8080, 443], "labels": {"tier": "web", "env": "prod"}})"));
+
+    // 生成的patch应用到source上得到target
+    const jValue patch = simple_json::Diff(source.GetValue(), target.GetValue());
+    std::string patch_str;
+    simple_json::AppendJson(patch_str, patch);
+    std::cout << patch_str << '\n';
+
+    jValue patched = source.GetValue();
+    simple_json::JsonPatch::Compile(patch).Apply(patched);
+    std::string patched_str;
+    simple_json::AppendJson(patched_str, patched);
+    std::cout << patched_str << '\n';
+
+    // 这两个子树在成员哈希未经混合时哈希值相同，哈希值相等之后仍要比较内容
+    const auto collide_source = simple_json::Json::FromString(std::string(R"({"doc": {"a": 0, "b": 2}})"));
+    const auto collide_target = simple_json::Json::FromString(std::string(R"({"doc": {"a": 1, "b": 1}})"));
+    std::string collide_str;
+    simple_json::AppendJson(collide_str, simple_json::Diff(collide_source.GetValue(), collide_target.GetValue()));
+    std::cout << collide_str << '\n';
+}
+
+void EqualityTest()
+{
+    // 对象成员的顺序不影响相等性和哈希值，整数与数值相同的浮点数相等
+    const auto lhs = simple_json::Json::FromString(std::string(R"({"id": 1, "tags": ["a", "b"], "ratio": 0.5})"));
+    const auto rhs = simple_json::Json::FromString(std::string(R"({"ratio": 0.5, "tags": ["a", "b"], "id": 1.0})"));
+    std::cout << std::boolalpha << (lhs.GetValue() == rhs.GetValue()) << ' '
+              << (std::hash<jValue>{}(lhs.GetValue()) == std::hash<jValue>{}(rhs.GetValue())) << '\n';
+
+    // 作为哈希表的键对文档去重
+    std::unordered_map<jValue, int> counts;
+    ++counts[lhs.GetValue()];
+    ++counts[rhs.GetValue()];
+    std::cout << counts.size() << '\n';
+}
+
+void CborBenchmark()
+{
+    // 同一份文档分别以文本json和cbor往返编解码
+    constexpr long long ITEM_COUNT = 2000;
+    std::vector<jValue> items;
+    items.reserve(ITEM_COUNT);
+    for (long long i = 0; i < ITEM_COUNT; ++i)
+    {
+        items.push_back(jValue::MakeObj({{"id", jValue(static_cast<long long>(i))},
+                                         {"name", jValue("item" + std::to_string(i))},
+                                         {"price", jValue(static_cast<long double>(i) * 0.25L)},
+                                         {"active", jValue(i % 2 == 0)},
+                                         {"tags", jValue::MakeArr({jValue("a"), jValue("b"), jValue(nullptr)})}}));
+    }
+    const jValue document = jValue::MakeObj({{"items", jValue(std::move(items))}});
+
+    constexpr int ROUNDS = 20;
+    std::string text;
+    const auto text_begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        text.clear();
+        simple_json::AppendJson(text, document);
+        const auto parsed = simple_json::Json::FromString(text);
+    }
+    const double text_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - text_begin).count();
+
+    std::string binary;
+    const auto cbor_begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        binary.clear();
+        simple_json::AppendCbor(binary, document);
+        const jValue decoded = simple_json::FromCbor(binary);
+    }
+    const double cbor_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - cbor_begin).count();
+
+    std::cout << "text json: " << text.size() << " bytes, " << text_seconds / ROUNDS * 1000 << " ms per round trip\n";
+    std::cout << "cbor: " << binary.size() << " bytes, " << cbor_seconds / ROUNDS * 1000 << " ms per round trip\n";
+}
+
+void MsgPackTest()
+{
+    const auto json = simple_json::Json::FromString(
+        std::string(R"({"id": 300, "offset": -40000, "ratio": 0.5, "name": "sensor", "values": [1, 2, 3]})"));
+    const std::string packed = simple_json::ToMsgPack(json.GetValue());
+    std::cout << "msgpack: " << packed.size() << " bytes\n";
+
+    // 解码时字符串以视图的形式交给handler，JsonBuilder只在构建值时复制一次
+    simple_json::MsgPackReader reader(packed);
+    simple_json::JsonBuilder builder;
+    if (!reader.Parse(builder))
+    {
+        reader.ThrowError();
+    }
+    std::string round_trip;
+    simple_json::AppendJson(round_trip, builder.TakeValue());
+    std::cout << round_trip << '\n';
+}
+
+void SnapshotTest()
+{
+    // 解析一次后写出快照，之后的进程直接映射快照文件，不需要重新解析
+    const auto json = simple_json::Json::FromString(
+        std::string(R"({"countries": {"cn": {"name": "China", "code": 86}, "fr": {"name": "France", "code": 33}}})"));
+    simple_json::SaveSnapshot(json.GetValue(), "reference.snapshot");
+
+    const auto snapshot = simple_json::JsonSnapshot::Open("reference.snapshot");
+    const simple_json::SnapshotView root = snapshot.Root();
+    std::cout << root["countries"]["fr"]["name"].GetString() << '\n';
+    if (const auto code = root.Resolve(simple_json::JsonPointer("/countries/cn/code")))
+    {
+        std::cout << code->GetInt() << '\n';
+    }
+}
+
+void CompressedFileTest()
+{
+    // .json.gz和.json.zst在后台线程中分块解压，词法分析与解压同时进行
+    try
+    {
+        const simple_json::Json json = simple_json::Json::FromFile("./tmp.json.gz");
+        std::cout << json << '\n';
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << e.what() << '\n';
+    }
+
+    // 也可以手动把数据分块交给词法分析器，数据块可以在任意位置截断
+    const std::string json_str(R"({"name": "doro", "tags": ["a", "b"], "size": 12.5, "ok": true})");
+    simple_json::Lexer lexer;
+    for (size_t pos = 0; pos < json_str.length(); pos += 7)
+    {
+        lexer.Feed(std::string_view(json_str).substr(pos, 7));
+    }
+    lexer.Finish();
+
+    const simple_json::Parser parser(lexer.TakeToken());
+    std::cout << std::boolalpha << (parser.GetJsonAst() == simple_json::Json::FromString(json_str).GetValue())
+              << '\n';
+}
+
+void PersistentJsonTest()
+{
+    // 共享配置的每个版本只复制被修改的路径，拷贝快照的开销与文档大小无关
+    std::unordered_map<std::string, jValue> services;
+    for (int i = 0; i < 10000; ++i)
+    {
+        jValue service =
+            jValue::MakeObj({{"port", jValue(static_cast<long long>(8000 + i))}, {"enabled", jValue(true)}});
+        services.emplace("service" + std::to_string(i), std::move(service));
+    }
+    const jValue config(std::move(services));
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i)
+    {
+        jValue copy = config;
+        copy["service42"]["port"] = static_cast<long long>(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "deep copy + update: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 100 << " us\n";
+
+    const simple_json::PersistentJson v1(config);
+    const simple_json::JsonPointer port("/service42/port");
+    simple_json::PersistentJson latest = v1;
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i)
+    {
+        latest = latest.SetIn(port, i);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "persistent update: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 100 << " us\n";
+
+    // 旧版本保持不变，未修改的子树与新版本共享
+    std::cout << v1["service42"]["port"].GetInt() << ' ' << latest["service42"]["port"].GetInt() << ' '
+              << std::boolalpha << v1["service7"].SharesWith(latest["service7"]) << '\n';
+}
+
+void ReusableParserTest()
+{
+    // 长期存在的解析器在多次解析之间保留缓冲区容量，稳定后只为返回的json数据结构分配内存
+    const std::string request(R"({"user": "doro", "action": "login", "items": [1, 2, 3], )"
+                              R"("meta": {"ip": "127.0.0.1"}})");
+    simple_json::JsonParser parser;
+
+    constexpr int ROUNDS = 100000;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        const jValue value = parser.Parse(request);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "reused parser: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+              << " ms\n";
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        const auto json = simple_json::Json::FromString(request);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "one-shot parser: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+              << " ms\n";
+}
+
+void BatchParseTest()
+{
+    // 一个大文档和许多小文档混在一起，大文档占住一个线程时其他线程继续解析小文档
+    std::vector<std::string> storage;
+    std::string big("[");
+    for (int i = 0; i < 200000; ++i)
+    {
+        big += R"({"id": )" + std::to_string(i) + R"(, "tags": ["a", "b"]},)";
+    }
+    big.back() = ']';
+    storage.push_back(std::move(big));
+    for (int i = 0; i < 20000; ++i)
+    {
+        storage.push_back(R"({"user": "doro", "seq": )" + std::to_string(i) + "}");
+    }
+    storage.emplace_back(R"({"broken": [1, 2)");
+
+    const std::vector<std::string_view> documents(storage.begin(), storage.end());
+    simple_json::BatchParser batch_parser;
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<simple_json::BatchResult> results = batch_parser.ParseBatch(documents);
+    const auto end = std::chrono::steady_clock::now();
+
+    std::cout << batch_parser.ThreadCount() << " threads: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms\n";
+    std::cout << "first size: " << results.front().value_.GetVal<jType::Array>().size() << '\n';
+    std::cout << "seq of #100: " << results[100].value_["seq"].GetVal<jType::Int>() << '\n';
+    std::cout << "last ok: " << results.back().Ok() << ", error: " << results.back().error_ << '\n';
+}
+
+void TryParseTest()
+{
+    // 客户端发来的非法输入：TryParse遇到第一个错误就返回错误码和字节偏移，不抛异常也不构建错误信息
+    const std::string garbage(R"({"user": "doro", "items": [1, 2, 3,, 4], "meta": {"ip": "127.0.0.1"}})");
+    constexpr int ROUNDS = 100000;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        try
+        {
+            const auto json = simple_json::Json::FromString(garbage);
+        }
+        catch (const std::exception &e)
+        {
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "FromString + catch: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+              << " ms\n";
+
+    jValue value;
+    simple_json::ParseError error;
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        error = simple_json::TryParse(garbage, value);
+    }
+    end = std::chrono::steady_clock::now();
+    std::cout << "TryParse: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+              << " ms\n";
+
+    // 需要展示给人看时再生成带高亮的错误信息
+    std::cout << "offset " << error.offset_ << ": " << simple_json::ErrorDescription(error.code_) << '\n';
+    std::cout << simple_json::DescribeError(garbage, error);
+}
+
+void ParseLimitsTest()
+{
+    // 十万层嵌套的恶意输入，解析器不会耗尽调用栈，而是报告嵌套过深
+    const std::string deep(100000, '[');
+    jValue value;
+    simple_json::ParseError error = simple_json::TryParse(deep, value);
+    std::cout << "offset " << error.offset_ << ": " << simple_json::ErrorDescription(error.code_) << '\n';
+    try
+    {
+        const auto json = simple_json::Json::FromString(deep);
+    }
+    catch (const std::exception &e)
+    {
+        // 只打印第一行，出错的那一行有十万个字符
+        const std::string what(e.what());
+        std::cout << what.substr(0, what.find('\n')) << '\n';
+    }
+
+    // 处理不可信输入时按需收紧其余限制
+    simple_json::ParseLimits limits;
+    limits.max_depth_ = 8;
+    limits.max_input_size_ = 1 << 20;
+    limits.max_string_length_ = 16;
+    limits.max_elements_ = 1000;
+    const std::string request(R"({"user": "doro", "token": "0123456789abcdef0123456789abcdef"})");
+    error = simple_json::TryParse(request, value, limits);
+    std::cout << simple_json::DescribeError(request, error);
+}
+
+void ParseStatsTest()
+{
+    // 需要以PARSE_STATS=true构建，否则所有计数都是0
+    const auto json = simple_json::Json::FromString(
+        R"({"name": "doro\n", "tags": ["a", "b"], "size": {"w": 1.5, "h": 2}, "note": "\u4f60\u597d"})");
+    const simple_json::ParseStats &stats = simple_json::LastParseStats();
+    std::cout << "bytes: " << stats.bytes_ << ", strings: " << stats.Tokens(simple_json::TokenType::STR)
+              << ", escapes: " << stats.escapes_ << ", numbers: " << stats.numbers_ << ", depth: " << stats.max_depth_
+              << ", allocations: " << stats.allocations_ << " (" << stats.allocated_bytes_ << " bytes)"
+              << ", lex: " << stats.lex_ns_ << " ns, parse: " << stats.parse_ns_ << " ns\n";
+
+    // 多个线程的统计在解析完成时合并到全局累计值中
+    simple_json::BatchParser batch_parser(4);
+    const std::vector<std::string_view> documents(100, R"({"id": 1, "values": [1, 2, 3]})");
+    simple_json::ResetTotalParseStats();
+    const auto results = batch_parser.ParseBatch(documents);
+    const simple_json::ParseStats total = simple_json::TotalParseStats();
+    std::cout << "documents: " << total.documents_ << ", numbers: " << total.numbers_
+              << ", lex: " << total.lex_ns_ / 1000 << " us, parse: " << total.parse_ns_ / 1000 << " us\n";
+}
+
+void MemoryUsageTest()
+{
+    const auto json = simple_json::Json::FromString(
+        R"({"name": "a name longer than the short string buffer", "tags": ["a", "b", "c"], "size": {"w": 1.5}})");
+    const simple_json::MemoryFootprint usage = json.GetValue().MemoryUsage();
+    std::cout << "nodes: " << usage.nodes_ << ", slack: " << usage.capacity_slack_ << ", strings: " << usage.strings_
+              << ", buckets: " << usage.hash_buckets_ << ", total: " << usage.Total() << " bytes\n";
+}
+
+void ParseCacheTest()
+{
+    // 重复出现的输入只解析一次，之后返回同一份共享的文档
+    simple_json::ParseCache cache(1 << 20);
+    const std::string flags(R"({"feature": "dark_mode", "enabled": true, "rollout": [10, 50, 100]})");
+    const auto first = cache.Parse(flags);
+    const auto second = cache.Parse(flags);
+    std::cout << std::boolalpha << "same document: " << (first == second) << '\n';
+    std::cout << first->GetValue().GetVal<simple_json::JsonType::Object>().at("feature") << '\n';
+
+    const simple_json::ParseCacheStats stats = cache.Stats();
+    std::cout << "hits: " << stats.hits_ << ", misses: " << stats.misses_ << ", entries: " << stats.entries_
+              << ", bytes: " << stats.bytes_ << '\n';
+}
+
+void RecordTableTest()
+{
+    // 键相同的记录按列存放，键只存一份，数值列是连续的数组
+    const std::string records(
+        R"([{"id": 1, "ts": 1700000000, "v": 0.5, "tag": "a"}, {"id": 2, "ts": 1700000060, "v": 1.5, "tag": "b"},
+            {"tag": "c", "v": 2.5, "ts": 1700000120, "id": 3}])");
+    const std::optional<simple_json::RecordTable> table = simple_json::RecordTable::FromString(records);
+    if (!table)
+    {
+        std::cout << "not an array of records\n";
+        return;
+    }
+
+    long double sum = 0;
+    for (const long double v : table->Find("v")->GetFloats())
+    {
+        sum += v;
+    }
+    std::cout << "rows: " << table->RowCount() << ", columns: " << table->ColumnCount() << ", sum of v: " << sum
+              << '\n';
+    std::cout << "tag of row 2: " << table->Find("tag")->GetString(2) << '\n';
+
+    // 需要时按行取出一条记录
+    std::string row;
+    simple_json::AppendJson(row, table->Row(1));
+    std::cout << row << '\n';
+
+    const auto json = simple_json::Json::FromString(records);
+    std::cout << "objects: " << json.GetValue().MemoryUsage().Total()
+              << " bytes, columns: " << table->MemoryUsage().Total() << " bytes\n";
+}
+
 } // namespace
 
 int main()
@@ -274,6 +874,28 @@ int main()
     // LineSplitTest();
     // TokenStreamTest();
     // ParserTest();
+    // StructBindTest();
+    // SchemaTest();
+    // JsonPointerTest();
+    // JsonPathTest();
+    // ProjectionTest();
+    // JsonEditorTest();
+    // PatchBenchmark();
+    // DiffTest();
+    // EqualityTest();
+    // CborBenchmark();
+    // MsgPackTest();
+    // SnapshotTest();
+    // CompressedFileTest();
+    // PersistentJsonTest();
+    // ReusableParserTest();
+    // BatchParseTest();
+    // TryParseTest();
+    // ParseLimitsTest();
+    // ParseStatsTest();
+    // MemoryUsageTest();
+    // ParseCacheTest();
+    // RecordTableTest();
     JsonTest();
     return 0;
 }
@@ -0,0 +1,476 @@
+#include "msgpack.h"
+#include "config.h"
+#include "utilities.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+constexpr uint8_t NIL = 0xc0;
+constexpr uint8_t FALSE_TAG = 0xc2;
+constexpr uint8_t TRUE_TAG = 0xc3;
+constexpr uint8_t BIN8 = 0xc4;
+constexpr uint8_t BIN16 = 0xc5;
+constexpr uint8_t BIN32 = 0xc6;
+constexpr uint8_t FLOAT32 = 0xca;
+constexpr uint8_t FLOAT64 = 0xcb;
+constexpr uint8_t UINT8 = 0xcc;
+constexpr uint8_t UINT16 = 0xcd;
+constexpr uint8_t UINT32 = 0xce;
+constexpr uint8_t UINT64 = 0xcf;
+constexpr uint8_t INT8 = 0xd0;
+constexpr uint8_t INT16 = 0xd1;
+constexpr uint8_t INT32 = 0xd2;
+constexpr uint8_t INT64 = 0xd3;
+constexpr uint8_t STR8 = 0xd9;
+constexpr uint8_t STR16 = 0xda;
+constexpr uint8_t STR32 = 0xdb;
+constexpr uint8_t ARRAY16 = 0xdc;
+constexpr uint8_t ARRAY32 = 0xdd;
+constexpr uint8_t MAP16 = 0xde;
+constexpr uint8_t MAP32 = 0xdf;
+
+constexpr uint8_t FIXMAP = 0x80;
+constexpr uint8_t FIXARRAY = 0x90;
+constexpr uint8_t FIXSTR = 0xa0;
+
+// 类型字节之后按大端序写入size个字节
+void AppendTagged(std::string &out, const uint8_t tag, const uint64_t value, const size_t size)
+{
+    out.push_back(static_cast<char>(tag));
+    for (size_t shift = size * 8; shift > 0; shift -= 8)
+    {
+        out.push_back(static_cast<char>((value >> (shift - 8)) & 0xff));
+    }
+}
+
+// 长度小于fix_limit时使用fix格式，否则使用能容纳长度的最短格式；tag16为8位长度格式不存在时的16位格式
+void AppendLength(std::string &out, const uint8_t fix_tag, const size_t fix_limit, const uint8_t tag8,
+                  const uint8_t tag16, const uint8_t tag32, const uint64_t length)
+{
+    if (length < fix_limit)
+    {
+        out.push_back(static_cast<char>(fix_tag | length));
+    }
+    else if (tag8 != 0 && length <= 0xff)
+    {
+        AppendTagged(out, tag8, length, 1);
+    }
+    else if (length <= 0xffff)
+    {
+        AppendTagged(out, tag16, length, 2);
+    }
+    else
+    {
+        AppendTagged(out, tag32, length, 4);
+    }
+}
+
+void AppendString(std::string &out, const std::string &str)
+{
+    AppendLength(out, FIXSTR, 32, STR8, STR16, STR32, str.size());
+    out.append(str);
+}
+
+void AppendInt(std::string &out, const long long number)
+{
+    if (number >= 0)
+    {
+        const auto value = static_cast<uint64_t>(number);
+        if (value < 0x80)
+        {
+            out.push_back(static_cast<char>(value)); // positive fixint
+        }
+        else if (value <= 0xff)
+        {
+            AppendTagged(out, UINT8, value, 1);
+        }
+        else if (value <= 0xffff)
+        {
+            AppendTagged(out, UINT16, value, 2);
+        }
+        else if (value <= 0xffffffff)
+        {
+            AppendTagged(out, UINT32, value, 4);
+        }
+        else
+        {
+            AppendTagged(out, UINT64, value, 8);
+        }
+        return;
+    }
+
+    // 负数按补码写入，截断到目标宽度
+    const auto bits = static_cast<uint64_t>(number);
+    if (number >= -32)
+    {
+        out.push_back(static_cast<char>(bits & 0xff)); // negative fixint
+    }
+    else if (number >= INT8_MIN)
+    {
+        AppendTagged(out, INT8, bits, 1);
+    }
+    else if (number >= INT16_MIN)
+    {
+        AppendTagged(out, INT16, bits, 2);
+    }
+    else if (number >= INT32_MIN)
+    {
+        AppendTagged(out, INT32, bits, 4);
+    }
+    else
+    {
+        AppendTagged(out, INT64, bits, 8);
+    }
+}
+
+void AppendFloat(std::string &out, const long double value)
+{
+    const auto as_double = static_cast<double>(value);
+    const auto as_float = static_cast<float>(as_double);
+    if (std::isnan(as_double) || static_cast<double>(as_float) == as_double)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &as_float, sizeof(bits));
+        AppendTagged(out, FLOAT32, bits, 4);
+        return;
+    }
+    uint64_t bits = 0;
+    std::memcpy(&bits, &as_double, sizeof(bits));
+    AppendTagged(out, FLOAT64, bits, 8);
+}
+
+// 按补码把宽度为size字节的无符号数解释为有符号数
+long long SignExtend(const uint64_t value, const size_t size) noexcept
+{
+    if (size == 8)
+    {
+        return static_cast<long long>(value);
+    }
+    const uint64_t sign = uint64_t{1} << (size * 8 - 1);
+    return static_cast<long long>(value ^ sign) - static_cast<long long>(sign);
+}
+
+} // namespace
+
+void AppendMsgPack(std::string &out, const JsonValue &value)
+{
+    switch (value.GetType())
+    {
+    case JsonType::Object: {
+        const auto &object = value.GetVal<JsonType::Object>();
+        AppendLength(out, FIXMAP, 16, 0, MAP16, MAP32, object.size());
+        for (const auto &[key, member] : object)
+        {
+            AppendString(out, key);
+            AppendMsgPack(out, member);
+        }
+        break;
+    }
+    case JsonType::Array: {
+        const auto &array = value.GetVal<JsonType::Array>();
+        AppendLength(out, FIXARRAY, 16, 0, ARRAY16, ARRAY32, array.size());
+        for (const JsonValue &element : array)
+        {
+            AppendMsgPack(out, element);
+        }
+        break;
+    }
+    case JsonType::String:
+        AppendString(out, value.GetVal<JsonType::String>());
+        break;
+    case JsonType::Int:
+        AppendInt(out, value.GetVal<JsonType::Int>());
+        break;
+    case JsonType::Float:
+        AppendFloat(out, value.GetVal<JsonType::Float>());
+        break;
+    case JsonType::Bool:
+        out.push_back(static_cast<char>(value.GetVal<JsonType::Bool>() ? TRUE_TAG : FALSE_TAG));
+        break;
+    case JsonType::Null:
+        out.push_back(static_cast<char>(NIL));
+        break;
+    }
+}
+
+std::string ToMsgPack(const JsonValue &value)
+{
+    std::string out;
+    AppendMsgPack(out, value);
+    return out;
+}
+
+JsonValue FromMsgPack(const std::string_view data)
+{
+    MsgPackReader reader(data);
+    JsonBuilder builder;
+    if (!reader.Parse(builder))
+    {
+        reader.ThrowError();
+    }
+    return builder.TakeValue();
+}
+
+bool MsgPackReader::Parse(SaxHandler &handler)
+{
+    pos_ = 0;
+    error_.clear();
+    frames_.clear();
+
+    do
+    {
+        if (!frames_.empty() && frames_.back().is_map_ && !ReadKey(handler))
+        {
+            return false;
+        }
+
+        bool container = false;
+        if (!ReadItem(handler, container))
+        {
+            return false;
+        }
+        if (!container)
+        {
+            CompleteMember();
+        }
+
+        // 关闭所有已经读完的容器
+        while (!frames_.empty() && frames_.back().remaining_ == 0)
+        {
+            const bool is_map = frames_.back().is_map_;
+            const size_t count = frames_.back().count_;
+            frames_.pop_back();
+            if (!(is_map ? handler.EndObject(count) : handler.EndArray(count)))
+            {
+                return Abort(handler);
+            }
+            CompleteMember();
+        }
+    } while (!frames_.empty());
+
+    if (pos_ != data_.size())
+    {
+        return Fail("unexpected data after the top level object");
+    }
+    return true;
+}
+
+void MsgPackReader::ThrowError() const
+{
+    SIMPLE_JSON_THROW(std::runtime_error(error_));
+}
+
+bool MsgPackReader::Fail(const std::string &err_desc)
+{
+    error_ = ERR_INVALID_MSGPACK + err_desc + " at byte " + std::to_string(pos_);
+    return false;
+}
+
+bool MsgPackReader::Abort(const SaxHandler &handler)
+{
+    error_ = handler.GetError();
+    if (error_.empty())
+    {
+        error_ = ERR_SAX_HANDLER_STOPPED;
+    }
+    return false;
+}
+
+bool MsgPackReader::ReadUint(const size_t size, uint64_t &value)
+{
+    if (data_.size() - pos_ < size)
+    {
+        return Fail("unexpected end of data");
+    }
+    value = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        value = (value << 8) | static_cast<uint8_t>(data_[pos_++]);
+    }
+    return true;
+}
+
+bool MsgPackReader::ReadPayload(const uint64_t length, std::string_view &value)
+{
+    if (data_.size() - pos_ < length)
+    {
+        return Fail("unexpected end of data");
+    }
+    value = data_.substr(pos_, length);
+    pos_ += length;
+    return true;
+}
+
+bool MsgPackReader::ReadKey(SaxHandler &handler)
+{
+    // json只允许字符串作为键
+    if (pos_ >= data_.size())
+    {
+        return Fail("unexpected end of data");
+    }
+    const auto tag = static_cast<uint8_t>(data_[pos_++]);
+    uint64_t length = 0;
+    if ((tag & 0xe0) == FIXSTR)
+    {
+        length = tag & 0x1f;
+    }
+    else if (tag < STR8 || tag > STR32)
+    {
+        return Fail("map key must be a string");
+    }
+    else if (!ReadUint(size_t{1} << (tag - STR8), length))
+    {
+        return false;
+    }
+
+    std::string_view key;
+    if (!ReadPayload(length, key))
+    {
+        return false;
+    }
+    return handler.Key(key) || Abort(handler);
+}
+
+bool MsgPackReader::ReadItem(SaxHandler &handler, bool &container)
+{
+    if (pos_ >= data_.size())
+    {
+        return Fail("unexpected end of data");
+    }
+    const auto tag = static_cast<uint8_t>(data_[pos_++]);
+
+    // fix格式，值或长度直接保存在类型字节中
+    if (tag < 0x80)
+    {
+        return handler.Int(tag) || Abort(handler);
+    }
+    if (tag >= 0xe0)
+    {
+        return handler.Int(static_cast<int>(tag) - 0x100) || Abort(handler);
+    }
+    if (tag < 0xa0)
+    {
+        // 与文本解析器相同的嵌套上限，生成的树过深时析构和遍历会耗尽栈
+        if (frames_.size() >= MAX_PARSE_DEPTH)
+        {
+            return Fail("nesting is too deep");
+        }
+        const bool is_map = tag < FIXARRAY;
+        frames_.push_back(Frame{is_map, static_cast<uint32_t>(tag & 0x0f), 0});
+        container = true;
+        return (is_map ? handler.StartObject() : handler.StartArray()) || Abort(handler);
+    }
+    if (tag < 0xc0)
+    {
+        std::string_view value;
+        return ReadPayload(tag & 0x1f, value) && (handler.String(value) || Abort(handler));
+    }
+
+    uint64_t argument = 0;
+    switch (tag)
+    {
+    case NIL:
+        return handler.Null() || Abort(handler);
+    case FALSE_TAG:
+    case TRUE_TAG:
+        return handler.Bool(tag == TRUE_TAG) || Abort(handler);
+    case BIN8:
+    case BIN16:
+    case BIN32:
+    case STR8:
+    case STR16:
+    case STR32: {
+        const bool binary = tag <= BIN32;
+        std::string_view value;
+        if (!ReadUint(size_t{1} << (tag - (binary ? BIN8 : STR8)), argument) || !ReadPayload(argument, value))
+        {
+            return false;
+        }
+        if (binary && !raw_binary_)
+        {
+            scratch_.clear();
+            AppendBase64Url(scratch_, value);
+            value = scratch_;
+        }
+        return handler.String(value) || Abort(handler);
+    }
+    case FLOAT32: {
+        if (!ReadUint(4, argument))
+        {
+            return false;
+        }
+        const auto bits = static_cast<uint32_t>(argument);
+        float number = 0;
+        std::memcpy(&number, &bits, sizeof(number));
+        return handler.Float(number) || Abort(handler);
+    }
+    case FLOAT64: {
+        if (!ReadUint(8, argument))
+        {
+            return false;
+        }
+        double number = 0;
+        std::memcpy(&number, &argument, sizeof(number));
+        return handler.Float(number) || Abort(handler);
+    }
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case UINT64:
+        if (!ReadUint(size_t{1} << (tag - UINT8), argument))
+        {
+            return false;
+        }
+        if (argument > static_cast<uint64_t>(LLONG_MAX))
+        {
+            return Fail("integer out of range");
+        }
+        return handler.Int(static_cast<long long>(argument)) || Abort(handler);
+    case INT8:
+    case INT16:
+    case INT32:
+    case INT64: {
+        const size_t size = size_t{1} << (tag - INT8);
+        return ReadUint(size, argument) && (handler.Int(SignExtend(argument, size)) || Abort(handler));
+    }
+    case ARRAY16:
+    case ARRAY32:
+    case MAP16:
+    case MAP32: {
+        const bool is_map = tag >= MAP16;
+        if (!ReadUint(tag == ARRAY16 || tag == MAP16 ? 2 : 4, argument))
+        {
+            return false;
+        }
+        if (frames_.size() >= MAX_PARSE_DEPTH)
+        {
+            return Fail("nesting is too deep");
+        }
+        frames_.push_back(Frame{is_map, static_cast<uint32_t>(argument), 0});
+        container = true;
+        return (is_map ? handler.StartObject() : handler.StartArray()) || Abort(handler);
+    }
+    default:
+        // 0xc1从未使用，扩展类型在json中没有对应的值
+        return Fail("unsupported type " + std::to_string(tag));
+    }
+}
+
+void MsgPackReader::CompleteMember() noexcept
+{
+    if (!frames_.empty())
+    {
+        ++frames_.back().count_;
+        --frames_.back().remaining_;
+    }
+}
+} // namespace simple_json
@@ -0,0 +1,186 @@
+#include "parse_cache.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+uint64_t RotateLeft(const uint64_t value, const int shift) noexcept
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+// MurmurHash3_x64_128，按小端序读取分组，大端机器上的结果与参考实现不同，但在进程内同样稳定
+std::pair<uint64_t, uint64_t> MurmurHash3(const std::string_view data, const uint64_t seed) noexcept
+{
+    constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    const size_t block_count = data.size() / 16;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        uint64_t k1 = 0;
+        uint64_t k2 = 0;
+        std::memcpy(&k1, bytes + i * 16, sizeof(k1));
+        std::memcpy(&k2, bytes + i * 16 + 8, sizeof(k2));
+
+        k1 *= C1;
+        k1 = RotateLeft(k1, 31);
+        k1 *= C2;
+        h1 ^= k1;
+        h1 = RotateLeft(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= C2;
+        k2 = RotateLeft(k2, 33);
+        k2 *= C1;
+        h2 ^= k2;
+        h2 = RotateLeft(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    // 不足16字节的尾部，前8个字节进入k1，其余进入k2
+    const unsigned char *tail = bytes + block_count * 16;
+    const size_t tail_size = data.size() % 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    for (size_t i = 0; i < tail_size; ++i)
+    {
+        (i < 8 ? k1 : k2) |= static_cast<uint64_t>(tail[i]) << (8 * (i % 8));
+    }
+    if (tail_size > 8)
+    {
+        k2 *= C2;
+        k2 = RotateLeft(k2, 33);
+        k2 *= C1;
+        h2 ^= k2;
+    }
+    if (tail_size > 0)
+    {
+        k1 *= C1;
+        k1 = RotateLeft(k1, 31);
+        k1 *= C2;
+        h1 ^= k1;
+    }
+
+    h1 ^= data.size();
+    h2 ^= data.size();
+    h1 += h2;
+    h2 += h1;
+    h1 = MixHash(h1);
+    h2 = MixHash(h2);
+    h1 += h2;
+    h2 += h1;
+    return {h1, h2};
+}
+} // namespace
+
+ParseCache::ParseCache(const size_t capacity_bytes, size_t shard_count)
+{
+    shard_count = std::max<size_t>(shard_count, 1);
+    shard_capacity_ = capacity_bytes / shard_count;
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+std::shared_ptr<const Json> ParseCache::Parse(const std::string_view json_str)
+{
+    const auto [low, high] = MurmurHash3(json_str, 0);
+    const Key key{low, high};
+    Shard &shard = *shards_[high % shards_.size()];
+    {
+        const std::lock_guard lock(shard.mutex_);
+        if (const auto iter = shard.index_.find(key); iter != shard.index_.end() && iter->second->source_ == json_str)
+        {
+            // 移到LRU链表的前端，不移动元素本身，索引中的迭代器保持有效
+            shard.lru_.splice(shard.lru_.begin(), shard.lru_, iter->second);
+            ++shard.hits_;
+            return iter->second->json_;
+        }
+        ++shard.misses_;
+    }
+
+    // 解析失败时异常直接抛给调用者，缓存不变
+    auto json = std::make_shared<const Json>(Json::FromString(json_str));
+
+    // 文档和输入以外的开销：make_shared的控制块和Json对象、LRU链表节点、索引节点
+    constexpr size_t ENTRY_OVERHEAD = (2 * sizeof(void *) + sizeof(Json)) + (2 * sizeof(void *) + sizeof(Entry)) +
+                                      (sizeof(void *) + sizeof(Key) + sizeof(std::list<Entry>::iterator));
+    const size_t bytes = json->GetValue().MemoryUsage().Total() + json_str.size() + ENTRY_OVERHEAD;
+    if (bytes > shard_capacity_)
+    {
+        // 比整个分片还大的文档不缓存，也不为它淘汰其他文档
+        return json;
+    }
+    return Insert(shard, Entry{key, std::string(json_str), std::move(json), bytes});
+}
+
+std::shared_ptr<const Json> ParseCache::Insert(Shard &shard, Entry &&entry)
+{
+    // 被淘汰的文档在解锁之后才析构，释放大文档不会阻塞其他查找
+    std::list<Entry> evicted;
+    const std::lock_guard lock(shard.mutex_);
+
+    if (const auto iter = shard.index_.find(entry.key_); iter != shard.index_.end())
+    {
+        // 其他线程同时解析了相同的输入时返回先放入的文档，所有调用者共享同一份；哈希碰撞时保留已有的文档
+        return iter->second->source_ == entry.source_ ? iter->second->json_ : std::move(entry.json_);
+    }
+
+    while (shard.bytes_ + entry.bytes_ > shard_capacity_)
+    {
+        const auto oldest = std::prev(shard.lru_.end());
+        shard.bytes_ -= oldest->bytes_;
+        shard.index_.erase(oldest->key_);
+        evicted.splice(evicted.end(), shard.lru_, oldest);
+        ++shard.evictions_;
+    }
+
+    shard.bytes_ += entry.bytes_;
+    shard.lru_.push_front(std::move(entry));
+    shard.index_.emplace(shard.lru_.front().key_, shard.lru_.begin());
+    return shard.lru_.front().json_;
+}
+
+ParseCacheStats ParseCache::Stats() const
+{
+    ParseCacheStats stats;
+    for (const auto &shard : shards_)
+    {
+        const std::lock_guard lock(shard->mutex_);
+        stats.hits_ += shard->hits_;
+        stats.misses_ += shard->misses_;
+        stats.evictions_ += shard->evictions_;
+        stats.entries_ += shard->lru_.size();
+        stats.bytes_ += shard->bytes_;
+    }
+    return stats;
+}
+
+void ParseCache::Clear()
+{
+    for (const auto &shard : shards_)
+    {
+        std::list<Entry> dropped;
+        const std::lock_guard lock(shard->mutex_);
+        dropped.swap(shard->lru_);
+        shard->index_.clear();
+        shard->bytes_ = 0;
+    }
+}
+} // namespace simple_json
@@ -0,0 +1,111 @@
+#include "parse_stats.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+#if PARSE_STATS
+thread_local ParseStats current_stats; // 当前线程最近一个文档的统计
+
+std::mutex total_mutex;
+ParseStats total_stats; // 所有线程已完成的文档的累计值，由total_mutex保护
+#endif
+} // namespace
+
+ParseStats &ParseStats::operator+=(const ParseStats &other) noexcept
+{
+    documents_ += other.documents_;
+    bytes_ += other.bytes_;
+    for (size_t i = 0; i < TOKEN_TYPE_COUNT; ++i)
+    {
+        tokens_[i] += other.tokens_[i];
+    }
+    max_depth_ = std::max(max_depth_, other.max_depth_);
+    strings_ += other.strings_;
+    escapes_ += other.escapes_;
+    numbers_ += other.numbers_;
+    allocations_ += other.allocations_;
+    allocated_bytes_ += other.allocated_bytes_;
+    lex_ns_ += other.lex_ns_;
+    parse_ns_ += other.parse_ns_;
+    return *this;
+}
+
+const ParseStats &LastParseStats() noexcept
+{
+#if PARSE_STATS
+    return current_stats;
+#else
+    static const ParseStats EMPTY_STATS;
+    return EMPTY_STATS;
+#endif
+}
+
+ParseStats TotalParseStats()
+{
+#if PARSE_STATS
+    const std::lock_guard lock(total_mutex);
+    return total_stats;
+#else
+    return {};
+#endif
+}
+
+void ResetTotalParseStats()
+{
+#if PARSE_STATS
+    const std::lock_guard lock(total_mutex);
+    total_stats = ParseStats();
+#endif
+}
+
+#if PARSE_STATS
+ParseStats &CurrentParseStats() noexcept
+{
+    return current_stats;
+}
+
+void BeginParseStats() noexcept
+{
+    current_stats = ParseStats();
+}
+
+void FinishParseStats() noexcept
+{
+    current_stats.documents_ = 1;
+    const std::lock_guard lock(total_mutex);
+    total_stats += current_stats;
+}
+
+void NoteAllocation(const size_t bytes) noexcept
+{
+    ++current_stats.allocations_;
+    current_stats.allocated_bytes_ += bytes;
+}
+
+void NoteGrowth(const size_t old_capacity, const size_t new_capacity, const size_t element_size) noexcept
+{
+    // vector和string扩容时容量至少翻倍，逐次翻倍直到覆盖新容量
+    size_t capacity = old_capacity;
+    while (capacity < new_capacity)
+    {
+        capacity = std::min(std::max<size_t>(capacity * 2, 1), new_capacity);
+        NoteAllocation(capacity * element_size);
+    }
+}
+
+void NoteStringCopy(const size_t length) noexcept
+{
+    static const size_t INLINE_CAPACITY = std::string().capacity();
+    if (length > INLINE_CAPACITY)
+    {
+        NoteAllocation(length + 1);
+    }
+}
+#endif
+} // namespace simple_json
@@ -0,0 +1,847 @@
+#include "persistent_json.h"
+#include "config.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+constexpr unsigned BITS = 5;                              // 每层消耗的哈希位数或下标位数
+constexpr size_t WIDTH = size_t{1} << BITS;               // 每个节点的最大分支数
+constexpr size_t MASK = WIDTH - 1;                        // 取出一层的槽位
+constexpr unsigned HASH_BITS = sizeof(size_t) * CHAR_BIT; // 哈希值用完后进入冲突节点
+
+// HAMT中的一个键值对
+struct HamtEntry
+{
+    size_t hash_;
+    std::string key_;
+    PersistentJson value_;
+};
+
+// HAMT节点，data_map_和node_map_的每一位对应一个槽位，槽位中要么是键值对，要么是子节点。哈希值全部用完之后的节点
+// 是冲突节点，entries_中是哈希值完全相同的键值对，两个位图都不使用
+struct HamtNode
+{
+    uint32_t data_map_ = 0;
+    uint32_t node_map_ = 0;
+    std::vector<HamtEntry> entries_;                        // 按槽位顺序排列
+    std::vector<std::shared_ptr<const HamtNode>> children_; // 按槽位顺序排列
+};
+
+// 32叉前缀树节点，叶子节点保存元素，其他节点保存子节点。除最后一条路径外所有节点都是满的，下标逐层取5位即可定位
+struct VectorNode
+{
+    std::vector<PersistentJson> values_;
+    std::vector<std::shared_ptr<const VectorNode>> children_;
+};
+
+unsigned Popcount(uint32_t bits) noexcept
+{
+    bits = bits - ((bits >> 1) & 0x55555555U);
+    bits = (bits & 0x33333333U) + ((bits >> 2) & 0x33333333U);
+    return (((bits + (bits >> 4)) & 0x0F0F0F0FU) * 0x01010101U) >> 24;
+}
+
+uint32_t SlotBit(const size_t hash, const unsigned shift) noexcept
+{
+    return uint32_t{1} << ((hash >> shift) & MASK);
+}
+
+// 槽位在紧凑数组中的位置，即位图中排在它前面的位数
+size_t SlotIndex(const uint32_t map, const uint32_t bit) noexcept
+{
+    return Popcount(map & (bit - 1));
+}
+
+size_t HashKey(const std::string_view key) noexcept
+{
+    return std::hash<std::string_view>{}(key);
+}
+
+// 把哈希值按HAMT逐层使用的顺序重新排列，按它排序后每一层同一槽位的键值对都是连续的
+size_t SlotOrder(const size_t hash) noexcept
+{
+    size_t order = 0;
+    for (unsigned shift = 0; shift < HASH_BITS; shift += BITS)
+    {
+        const unsigned width = std::min(BITS, HASH_BITS - shift);
+        order = (order << width) | ((hash >> shift) & ((size_t{1} << width) - 1));
+    }
+    return order;
+}
+
+const PersistentJson *FindEntry(const HamtNode *node, const size_t hash, const std::string_view key) noexcept
+{
+    for (unsigned shift = 0; node != nullptr; shift += BITS)
+    {
+        if (shift >= HASH_BITS)
+        {
+            for (const HamtEntry &entry : node->entries_)
+            {
+                if (entry.key_ == key)
+                {
+                    return &entry.value_;
+                }
+            }
+            return nullptr;
+        }
+
+        const uint32_t bit = SlotBit(hash, shift);
+        if ((node->data_map_ & bit) != 0)
+        {
+            const HamtEntry &entry = node->entries_[SlotIndex(node->data_map_, bit)];
+            return entry.hash_ == hash && entry.key_ == key ? &entry.value_ : nullptr;
+        }
+        if ((node->node_map_ & bit) == 0)
+        {
+            return nullptr;
+        }
+        node = node->children_[SlotIndex(node->node_map_, bit)].get();
+    }
+    return nullptr;
+}
+
+// 两个键值对落在同一槽位，为它们建立子节点，直到哈希值在某一层分开
+std::shared_ptr<const HamtNode> MergeEntries(HamtEntry &&first, HamtEntry &&second, const unsigned shift)
+{
+    auto node = std::make_shared<HamtNode>();
+    if (shift >= HASH_BITS)
+    {
+        node->entries_.push_back(std::move(first));
+        node->entries_.push_back(std::move(second));
+        return node;
+    }
+
+    const uint32_t first_bit = SlotBit(first.hash_, shift);
+    const uint32_t second_bit = SlotBit(second.hash_, shift);
+    if (first_bit == second_bit)
+    {
+        node->node_map_ = first_bit;
+        node->children_.push_back(MergeEntries(std::move(first), std::move(second), shift + BITS));
+        return node;
+    }
+
+    node->data_map_ = first_bit | second_bit;
+    if (first_bit > second_bit)
+    {
+        std::swap(first, second);
+    }
+    node->entries_.push_back(std::move(first));
+    node->entries_.push_back(std::move(second));
+    return node;
+}
+
+// 路径复制：只复制从根到目标槽位经过的节点，其余子树与旧版本共享
+std::shared_ptr<const HamtNode> InsertEntry(const HamtNode &node, HamtEntry &&entry, const unsigned shift, bool &added)
+{
+    auto copy = std::make_shared<HamtNode>(node);
+    if (shift >= HASH_BITS)
+    {
+        for (HamtEntry &existing : copy->entries_)
+        {
+            if (existing.key_ == entry.key_)
+            {
+                existing.value_ = std::move(entry.value_);
+                return copy;
+            }
+        }
+        copy->entries_.push_back(std::move(entry));
+        added = true;
+        return copy;
+    }
+
+    const uint32_t bit = SlotBit(entry.hash_, shift);
+    if ((node.data_map_ & bit) != 0)
+    {
+        const size_t index = SlotIndex(node.data_map_, bit);
+        HamtEntry &existing = copy->entries_[index];
+        if (existing.hash_ == entry.hash_ && existing.key_ == entry.key_)
+        {
+            existing.value_ = std::move(entry.value_);
+            return copy;
+        }
+
+        // 槽位被另一个键占用，两个键值对一起下沉到新的子节点
+        std::shared_ptr<const HamtNode> child = MergeEntries(std::move(existing), std::move(entry), shift + BITS);
+        copy->entries_.erase(copy->entries_.begin() + static_cast<std::ptrdiff_t>(index));
+        copy->data_map_ ^= bit;
+        copy->node_map_ |= bit;
+        copy->children_.insert(copy->children_.begin() + static_cast<std::ptrdiff_t>(SlotIndex(copy->node_map_, bit)),
+                               std::move(child));
+        added = true;
+    }
+    else if ((node.node_map_ & bit) != 0)
+    {
+        const size_t index = SlotIndex(node.node_map_, bit);
+        copy->children_[index] = InsertEntry(*node.children_[index], std::move(entry), shift + BITS, added);
+    }
+    else
+    {
+        copy->data_map_ |= bit;
+        copy->entries_.insert(copy->entries_.begin() + static_cast<std::ptrdiff_t>(SlotIndex(copy->data_map_, bit)),
+                              std::move(entry));
+        added = true;
+    }
+    return copy;
+}
+
+// 返回删除后的节点，没有找到键时返回nullptr，调用者继续使用原节点
+std::shared_ptr<const HamtNode> EraseEntry(const HamtNode &node, const size_t hash, const std::string_view key,
+                                           const unsigned shift)
+{
+    if (shift >= HASH_BITS)
+    {
+        const auto found = std::find_if(node.entries_.begin(), node.entries_.end(),
+                                        [key](const HamtEntry &entry) { return entry.key_ == key; });
+        if (found == node.entries_.end())
+        {
+            return nullptr;
+        }
+        auto copy = std::make_shared<HamtNode>(node);
+        copy->entries_.erase(copy->entries_.begin() + (found - node.entries_.begin()));
+        return copy;
+    }
+
+    const uint32_t bit = SlotBit(hash, shift);
+    if ((node.data_map_ & bit) != 0)
+    {
+        const size_t index = SlotIndex(node.data_map_, bit);
+        if (const HamtEntry &entry = node.entries_[index]; entry.hash_ != hash || entry.key_ != key)
+        {
+            return nullptr;
+        }
+        auto copy = std::make_shared<HamtNode>(node);
+        copy->entries_.erase(copy->entries_.begin() + static_cast<std::ptrdiff_t>(index));
+        copy->data_map_ ^= bit;
+        return copy;
+    }
+    if ((node.node_map_ & bit) == 0)
+    {
+        return nullptr;
+    }
+
+    const size_t index = SlotIndex(node.node_map_, bit);
+    std::shared_ptr<const HamtNode> child = EraseEntry(*node.children_[index], hash, key, shift + BITS);
+    if (!child)
+    {
+        return nullptr;
+    }
+
+    auto copy = std::make_shared<HamtNode>(node);
+    if (child->children_.empty() && child->entries_.size() == 1)
+    {
+        // 子节点只剩一个键值对，把它提升到当前节点，这样树的形状只取决于其中的键
+        copy->node_map_ ^= bit;
+        copy->children_.erase(copy->children_.begin() + static_cast<std::ptrdiff_t>(index));
+        copy->data_map_ |= bit;
+        copy->entries_.insert(copy->entries_.begin() + static_cast<std::ptrdiff_t>(SlotIndex(copy->data_map_, bit)),
+                              child->entries_.front());
+    }
+    else
+    {
+        copy->children_[index] = std::move(child);
+    }
+    return copy;
+}
+
+// 从按SlotOrder排好序的键值对一次性建树，不需要逐个插入时的路径复制
+std::shared_ptr<const HamtNode> BuildHamt(std::vector<HamtEntry>::iterator first, std::vector<HamtEntry>::iterator last,
+                                          const unsigned shift)
+{
+    auto node = std::make_shared<HamtNode>();
+    if (shift >= HASH_BITS)
+    {
+        node->entries_.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+        return node;
+    }
+
+    while (first != last)
+    {
+        const size_t slot = (first->hash_ >> shift) & MASK;
+        const auto run_end = std::find_if(
+            first, last, [shift, slot](const HamtEntry &entry) { return ((entry.hash_ >> shift) & MASK) != slot; });
+        const uint32_t bit = uint32_t{1} << slot;
+        if (run_end - first == 1)
+        {
+            node->data_map_ |= bit;
+            node->entries_.push_back(std::move(*first));
+        }
+        else
+        {
+            node->node_map_ |= bit;
+            node->children_.push_back(BuildHamt(first, run_end, shift + BITS));
+        }
+        first = run_end;
+    }
+    return node;
+}
+
+void VisitEntries(const HamtNode &node,
+                  const std::function<void(const std::string &, const PersistentJson &)> &visit)
+{
+    for (const HamtEntry &entry : node.entries_)
+    {
+        visit(entry.key_, entry.value_);
+    }
+    for (const auto &child : node.children_)
+    {
+        VisitEntries(*child, visit);
+    }
+}
+
+std::shared_ptr<const VectorNode> NewPath(const unsigned level, PersistentJson &&value)
+{
+    auto node = std::make_shared<VectorNode>();
+    if (level == 0)
+    {
+        node->values_.push_back(std::move(value));
+    }
+    else
+    {
+        node->children_.push_back(NewPath(level - BITS, std::move(value)));
+    }
+    return node;
+}
+
+std::shared_ptr<const VectorNode> SetElement(const VectorNode &node, const unsigned level, const size_t index,
+                                             PersistentJson &&value)
+{
+    auto copy = std::make_shared<VectorNode>(node);
+    if (level == 0)
+    {
+        copy->values_[index & MASK] = std::move(value);
+    }
+    else
+    {
+        const size_t slot = (index >> level) & MASK;
+        copy->children_[slot] = SetElement(*node.children_[slot], level - BITS, index, std::move(value));
+    }
+    return copy;
+}
+
+// index为新元素的下标，即原数组的长度
+std::shared_ptr<const VectorNode> PushElement(const VectorNode &node, const unsigned level, const size_t index,
+                                              PersistentJson &&value)
+{
+    auto copy = std::make_shared<VectorNode>(node);
+    if (level == 0)
+    {
+        copy->values_.push_back(std::move(value));
+        return copy;
+    }
+
+    const size_t slot = (index >> level) & MASK;
+    if (slot < node.children_.size())
+    {
+        copy->children_[slot] = PushElement(*node.children_[slot], level - BITS, index, std::move(value));
+    }
+    else
+    {
+        copy->children_.push_back(NewPath(level - BITS, std::move(value)));
+    }
+    return copy;
+}
+
+// index为被删除元素的下标，节点变空时返回nullptr
+std::shared_ptr<const VectorNode> PopElement(const VectorNode &node, const unsigned level, const size_t index)
+{
+    if (level == 0)
+    {
+        if (node.values_.size() == 1)
+        {
+            return nullptr;
+        }
+        auto copy = std::make_shared<VectorNode>(node);
+        copy->values_.pop_back();
+        return copy;
+    }
+
+    const size_t slot = (index >> level) & MASK;
+    std::shared_ptr<const VectorNode> child = PopElement(*node.children_[slot], level - BITS, index);
+    if (!child && slot == 0)
+    {
+        return nullptr;
+    }
+
+    auto copy = std::make_shared<VectorNode>(node);
+    if (child)
+    {
+        copy->children_[slot] = std::move(child);
+    }
+    else
+    {
+        copy->children_.pop_back();
+    }
+    return copy;
+}
+
+void VisitElements(const VectorNode &node, const std::function<void(const PersistentJson &)> &visit)
+{
+    for (const PersistentJson &value : node.values_)
+    {
+        visit(value);
+    }
+    for (const auto &child : node.children_)
+    {
+        VisitElements(*child, visit);
+    }
+}
+} // namespace
+
+struct PersistentJson::ObjectData
+{
+    size_t size_ = 0;
+    std::shared_ptr<const HamtNode> root_ = std::make_shared<const HamtNode>();
+};
+
+struct PersistentJson::ArrayData
+{
+    size_t size_ = 0;
+    unsigned shift_ = 0;                     // 根节点所在的层，叶子节点为0
+    std::shared_ptr<const VectorNode> root_; // 空数组时为nullptr
+};
+
+PersistentJson::PersistentJson(std::shared_ptr<const ObjectData> object) noexcept
+    : type_(JsonType::Object), value_(std::move(object))
+{
+}
+
+PersistentJson::PersistentJson(std::shared_ptr<const ArrayData> array) noexcept
+    : type_(JsonType::Array), value_(std::move(array))
+{
+}
+
+PersistentJson::PersistentJson(const JsonValue &value)
+{
+    switch (value.GetType())
+    {
+    case JsonType::Object: {
+        const auto &object = value.GetVal<JsonType::Object>();
+        std::vector<HamtEntry> entries;
+        entries.reserve(object.size());
+        for (const auto &[key, member] : object)
+        {
+            entries.push_back({HashKey(key), key, PersistentJson(member)});
+        }
+        std::sort(entries.begin(), entries.end(), [](const HamtEntry &lhs, const HamtEntry &rhs) {
+            return SlotOrder(lhs.hash_) < SlotOrder(rhs.hash_);
+        });
+
+        auto data = std::make_shared<ObjectData>();
+        data->size_ = entries.size();
+        data->root_ = BuildHamt(entries.begin(), entries.end(), 0);
+        *this = PersistentJson(std::shared_ptr<const ObjectData>(std::move(data)));
+        break;
+    }
+    case JsonType::Array: {
+        // 先把元素装进叶子节点，再逐层每32个节点合并为一个父节点
+        std::vector<std::shared_ptr<const VectorNode>> level;
+        std::shared_ptr<VectorNode> leaf;
+        for (const JsonValue &element : value.GetVal<JsonType::Array>())
+        {
+            if (!leaf || leaf->values_.size() == WIDTH)
+            {
+                leaf = std::make_shared<VectorNode>();
+                leaf->values_.reserve(WIDTH);
+                level.push_back(leaf);
+            }
+            leaf->values_.emplace_back(element);
+        }
+
+        auto data = std::make_shared<ArrayData>();
+        data->size_ = value.GetVal<JsonType::Array>().size();
+        while (level.size() > 1)
+        {
+            std::vector<std::shared_ptr<const VectorNode>> parents;
+            for (size_t i = 0; i < level.size(); i += WIDTH)
+            {
+                auto parent = std::make_shared<VectorNode>();
+                const size_t end = std::min(i + WIDTH, level.size());
+                parent->children_.assign(level.begin() + static_cast<std::ptrdiff_t>(i),
+                                         level.begin() + static_cast<std::ptrdiff_t>(end));
+                parents.push_back(std::move(parent));
+            }
+            level = std::move(parents);
+            data->shift_ += BITS;
+        }
+        if (!level.empty())
+        {
+            data->root_ = std::move(level.front());
+        }
+        *this = PersistentJson(std::shared_ptr<const ArrayData>(std::move(data)));
+        break;
+    }
+    case JsonType::String:
+        *this = PersistentJson(value.GetVal<JsonType::String>());
+        break;
+    case JsonType::Int:
+        *this = PersistentJson(value.GetVal<JsonType::Int>());
+        break;
+    case JsonType::Float:
+        *this = PersistentJson(value.GetVal<JsonType::Float>());
+        break;
+    case JsonType::Bool:
+        *this = PersistentJson(value.GetVal<JsonType::Bool>());
+        break;
+    case JsonType::Null:
+        break;
+    }
+}
+
+PersistentJson PersistentJson::MakeObj() noexcept
+{
+    // 所有空对象共享同一个根
+    static const std::shared_ptr<const ObjectData> EMPTY = std::make_shared<const ObjectData>();
+    return PersistentJson(EMPTY);
+}
+
+PersistentJson PersistentJson::MakeArr() noexcept
+{
+    static const std::shared_ptr<const ArrayData> EMPTY = std::make_shared<const ArrayData>();
+    return PersistentJson(EMPTY);
+}
+
+long long PersistentJson::GetInt() const
+{
+    if (type_ != JsonType::Int)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetInt()!")));
+    }
+    return std::get<long long>(value_);
+}
+
+long double PersistentJson::GetFloat() const
+{
+    if (type_ != JsonType::Float)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetFloat()!")));
+    }
+    return std::get<long double>(value_);
+}
+
+bool PersistentJson::GetBool() const
+{
+    if (type_ != JsonType::Bool)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetBool()!")));
+    }
+    return std::get<bool>(value_);
+}
+
+const std::string &PersistentJson::GetString() const
+{
+    if (type_ != JsonType::String)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetString()!")));
+    }
+    return *std::get<std::shared_ptr<const std::string>>(value_);
+}
+
+size_t PersistentJson::Size() const noexcept
+{
+    if (type_ == JsonType::Object)
+    {
+        return std::get<std::shared_ptr<const ObjectData>>(value_)->size_;
+    }
+    if (type_ == JsonType::Array)
+    {
+        return std::get<std::shared_ptr<const ArrayData>>(value_)->size_;
+    }
+    return 0;
+}
+
+const PersistentJson::ObjectData &PersistentJson::Object() const
+{
+    if (type_ != JsonType::Object)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_TYPE_NOT_OBJECT));
+    }
+    return *std::get<std::shared_ptr<const ObjectData>>(value_);
+}
+
+const PersistentJson::ArrayData &PersistentJson::Array() const
+{
+    if (type_ != JsonType::Array)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_TYPE_NOT_ARRAY));
+    }
+    return *std::get<std::shared_ptr<const ArrayData>>(value_);
+}
+
+const PersistentJson &PersistentJson::operator[](const size_t index) const
+{
+    if (type_ != JsonType::Array)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_ARRAY_INTEGRAL));
+    }
+    const ArrayData &array = Array();
+    if (index >= array.size_)
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+
+    const VectorNode *node = array.root_.get();
+    for (unsigned level = array.shift_; level > 0; level -= BITS)
+    {
+        node = node->children_[(index >> level) & MASK].get();
+    }
+    return node->values_[index & MASK];
+}
+
+const PersistentJson &PersistentJson::operator[](const std::string_view key) const
+{
+    if (type_ != JsonType::Object)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_OBJECT_STRING));
+    }
+    const PersistentJson *member = Find(key);
+    if (member == nullptr)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_KEY));
+    }
+    return *member;
+}
+
+const PersistentJson *PersistentJson::Find(const std::string_view key) const noexcept
+{
+    if (type_ != JsonType::Object)
+    {
+        return nullptr;
+    }
+    return FindEntry(std::get<std::shared_ptr<const ObjectData>>(value_)->root_.get(), HashKey(key), key);
+}
+
+const PersistentJson *PersistentJson::Resolve(const JsonPointer &pointer) const noexcept
+{
+    const PersistentJson *cur = this;
+    for (const PointerSegment &segment : pointer.Segments())
+    {
+        if (cur->type_ == JsonType::Object)
+        {
+            cur = FindEntry(std::get<std::shared_ptr<const ObjectData>>(cur->value_)->root_.get(),
+                            HashKey(segment.key_), segment.key_);
+        }
+        else if (cur->type_ == JsonType::Array && segment.index_ < cur->Size())
+        {
+            cur = &(*cur)[segment.index_];
+        }
+        else
+        {
+            return nullptr;
+        }
+
+        if (cur == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    return cur;
+}
+
+PersistentJson PersistentJson::Set(const std::string_view key, PersistentJson value) const
+{
+    const ObjectData &object = Object();
+    bool added = false;
+    auto data = std::make_shared<ObjectData>();
+    data->root_ = InsertEntry(*object.root_, {HashKey(key), std::string(key), std::move(value)}, 0, added);
+    data->size_ = object.size_ + (added ? 1 : 0);
+    return PersistentJson(std::shared_ptr<const ObjectData>(std::move(data)));
+}
+
+PersistentJson PersistentJson::Erase(const std::string_view key) const
+{
+    const ObjectData &object = Object();
+    std::shared_ptr<const HamtNode> root = EraseEntry(*object.root_, HashKey(key), key, 0);
+    if (!root)
+    {
+        return *this;
+    }
+
+    auto data = std::make_shared<ObjectData>();
+    data->root_ = std::move(root);
+    data->size_ = object.size_ - 1;
+    return PersistentJson(std::shared_ptr<const ObjectData>(std::move(data)));
+}
+
+PersistentJson PersistentJson::Set(const size_t index, PersistentJson value) const
+{
+    const ArrayData &array = Array();
+    if (index >= array.size_)
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+
+    auto data = std::make_shared<ArrayData>(array);
+    data->root_ = SetElement(*array.root_, array.shift_, index, std::move(value));
+    return PersistentJson(std::shared_ptr<const ArrayData>(std::move(data)));
+}
+
+PersistentJson PersistentJson::PushBack(PersistentJson value) const
+{
+    const ArrayData &array = Array();
+    auto data = std::make_shared<ArrayData>(array);
+    if (!array.root_)
+    {
+        data->root_ = NewPath(0, std::move(value));
+    }
+    else if (array.size_ == WIDTH << array.shift_)
+    {
+        // 树已经满了，增加一层，旧的根成为新根的第一个子节点
+        auto root = std::make_shared<VectorNode>();
+        root->children_.push_back(array.root_);
+        root->children_.push_back(NewPath(array.shift_, std::move(value)));
+        data->root_ = std::move(root);
+        data->shift_ += BITS;
+    }
+    else
+    {
+        data->root_ = PushElement(*array.root_, array.shift_, array.size_, std::move(value));
+    }
+    ++data->size_;
+    return PersistentJson(std::shared_ptr<const ArrayData>(std::move(data)));
+}
+
+PersistentJson PersistentJson::PopBack() const
+{
+    const ArrayData &array = Array();
+    if (array.size_ == 0)
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+
+    auto data = std::make_shared<ArrayData>(array);
+    data->root_ = PopElement(*array.root_, array.shift_, array.size_ - 1);
+    --data->size_;
+    if (!data->root_)
+    {
+        data->shift_ = 0;
+    }
+    else if (data->shift_ > 0 && data->root_->children_.size() == 1)
+    {
+        // 根只剩一个子节点，减少一层
+        data->root_ = data->root_->children_.front();
+        data->shift_ -= BITS;
+    }
+    return PersistentJson(std::shared_ptr<const ArrayData>(std::move(data)));
+}
+
+PersistentJson PersistentJson::SetIn(const JsonPointer &pointer, PersistentJson value) const
+{
+    return SetIn(pointer, 0, std::move(value));
+}
+
+PersistentJson PersistentJson::SetIn(const JsonPointer &pointer, const size_t depth, PersistentJson &&value) const
+{
+    const std::vector<PointerSegment> &segments = pointer.Segments();
+    if (depth == segments.size())
+    {
+        return std::move(value);
+    }
+
+    const PointerSegment &segment = segments[depth];
+    const bool is_last = depth + 1 == segments.size();
+    if (type_ == JsonType::Object)
+    {
+        const PersistentJson *member = Find(segment.key_);
+        if (member != nullptr)
+        {
+            return Set(segment.key_, member->SetIn(pointer, depth + 1, std::move(value)));
+        }
+        if (is_last)
+        {
+            return Set(segment.key_, std::move(value));
+        }
+    }
+    else if (type_ == JsonType::Array)
+    {
+        if (segment.index_ < Size())
+        {
+            return Set(segment.index_, (*this)[segment.index_].SetIn(pointer, depth + 1, std::move(value)));
+        }
+        if (is_last && (segment.key_ == "-" || segment.index_ == Size()))
+        {
+            return PushBack(std::move(value));
+        }
+    }
+    SIMPLE_JSON_THROW(std::invalid_argument(ERR_POINTER_NOT_FOUND + pointer.ToString()));
+}
+
+void PersistentJson::ForEachMember(
+    const std::function<void(const std::string &, const PersistentJson &)> &visit) const
+{
+    if (type_ == JsonType::Object)
+    {
+        VisitEntries(*Object().root_, visit);
+    }
+}
+
+void PersistentJson::ForEachElement(const std::function<void(const PersistentJson &)> &visit) const
+{
+    if (type_ == JsonType::Array && Array().root_)
+    {
+        VisitElements(*Array().root_, visit);
+    }
+}
+
+bool PersistentJson::SharesWith(const PersistentJson &other) const noexcept
+{
+    if (type_ != other.type_)
+    {
+        return false;
+    }
+    switch (type_)
+    {
+    case JsonType::Object:
+        return std::get<std::shared_ptr<const ObjectData>>(value_) ==
+               std::get<std::shared_ptr<const ObjectData>>(other.value_);
+    case JsonType::Array:
+        return std::get<std::shared_ptr<const ArrayData>>(value_) ==
+               std::get<std::shared_ptr<const ArrayData>>(other.value_);
+    case JsonType::String:
+        return std::get<std::shared_ptr<const std::string>>(value_) ==
+               std::get<std::shared_ptr<const std::string>>(other.value_);
+    default:
+        return false;
+    }
+}
+
+JsonValue PersistentJson::ToValue() const
+{
+    switch (type_)
+    {
+    case JsonType::Object: {
+        std::unordered_map<std::string, JsonValue> object;
+        object.reserve(Size());
+        ForEachMember([&object](const std::string &key, const PersistentJson &member) {
+            object.emplace(key, member.ToValue());
+        });
+        return {std::move(object)};
+    }
+    case JsonType::Array: {
+        std::vector<JsonValue> array;
+        array.reserve(Size());
+        ForEachElement([&array](const PersistentJson &element) { array.push_back(element.ToValue()); });
+        return {std::move(array)};
+    }
+    case JsonType::String:
+        return {GetString()};
+    case JsonType::Int:
+        return JsonValue(static_cast<long long>(GetInt()));
+    case JsonType::Float:
+        return JsonValue(static_cast<long double>(GetFloat()));
+    case JsonType::Bool:
+        return JsonValue(static_cast<bool>(GetBool()));
+    default:
+        return {};
+    }
+}
+} // namespace simple_json
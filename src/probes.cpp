@@ -0,0 +1,63 @@
+#include "probes.h"
+
+#if USDT_PROBES
+#include <chrono>
+
+// USDT探针，提供者为simple_json，耗时的单位都是纳秒:
+//   document_start(bytes)                        Lexer开始一个新文档，bytes为此时已有的字节数
+//   document_done(bytes, tokens, ns, failed)     Parser完成这个文档，ns从document_start算起，出错时failed为1
+//   lex_start(bytes), lex_done(bytes, tokens, ns) 一次Lexer::Scan，分块输入时每块一次
+//   parse_start(tokens), parse_done(tokens, ns)  Parser构建一个文档
+//   error(description, row, col, count)          Lexer、Parser和SaxReader向调用者报告错误，row和col从0开始
+//   try_parse_start(bytes), try_parse_done(bytes, ns, code, offset)
+//   serialize_start(offset), serialize_done(bytes, ns) AppendJson，offset为输出中已有的字节数
+// 例如: bpftrace -e 'usdt:./JsonParser:simple_json:parse_done { @ns = hist(arg1); }'
+#define SIMPLE_JSON_DEFINE_SEMAPHORE(name)                                                                             \
+    __attribute__((section(".probes"))) volatile unsigned short simple_json_##name##_semaphore = 0
+
+extern "C"
+{
+    SIMPLE_JSON_DEFINE_SEMAPHORE(document_start);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(document_done);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(lex_start);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(lex_done);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(parse_start);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(parse_done);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(error);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(try_parse_start);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(try_parse_done);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(serialize_start);
+    SIMPLE_JSON_DEFINE_SEMAPHORE(serialize_done);
+}
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+thread_local uint64_t document_begin_ns = 0; // 当前线程正在解析的文档的开始时间，0表示未记录
+} // namespace
+
+uint64_t ProbeNow() noexcept
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+void ProbeDocumentStart(const size_t bytes) noexcept
+{
+    SIMPLE_JSON_PROBE(document_start, bytes);
+    document_begin_ns = SIMPLE_JSON_PROBE_CLOCK(document_done);
+}
+
+void ProbeDocumentDone(const size_t bytes, const size_t tokens, const bool failed) noexcept
+{
+    if (document_begin_ns != 0)
+    {
+        SIMPLE_JSON_PROBE(document_done, bytes, tokens, ProbeNow() - document_begin_ns, failed ? 1 : 0);
+        document_begin_ns = 0;
+    }
+}
+} // namespace simple_json
+#endif
@@ -0,0 +1,712 @@
+#include "record_table.h"
+#include "config.h"
+#include "lexer_parser.h"
+#include "sax.h"
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+// vector使用的部分计入nodes，预留未用的部分计入capacity_slack
+template <typename T> void AddVectorUsage(const std::vector<T> &vec, MemoryFootprint &usage) noexcept
+{
+    usage.nodes_ += vec.size() * sizeof(T);
+    usage.capacity_slack_ += (vec.capacity() - vec.size()) * sizeof(T);
+}
+
+void AddStringUsage(const std::string &str, MemoryFootprint &usage) noexcept
+{
+    static const size_t INLINE_CAPACITY = std::string().capacity();
+    if (str.capacity() > INLINE_CAPACITY)
+    {
+        usage.strings_ += str.size() + 1;
+        usage.capacity_slack_ += str.capacity() - str.size();
+    }
+}
+} // namespace
+
+// 在SAX事件上识别记录数组，标量直接写入列，记录中嵌套的对象和数组交给JsonBuilder构建
+// 文档不是同构的记录数组时返回false终止解析，并记录NotRecords
+class RecordTableBuilder : public SaxHandler
+{
+  public:
+    bool StartObject() override;
+    bool Key(std::string_view key) override;
+    bool EndObject(size_t member_count) override;
+    bool StartArray() override;
+    bool EndArray(size_t element_count) override;
+    bool String(std::string_view value) override;
+    bool Int(long long value) override;
+    bool Float(long double value) override;
+    bool Bool(bool value) override;
+    bool Null() override;
+
+    [[nodiscard]] bool NotRecords() const noexcept
+    {
+        return not_records_;
+    }
+
+    [[nodiscard]] RecordTable TakeTable() noexcept;
+
+  private:
+    RecordTable table_;
+    size_t depth_{0};        // 0表示在顶层数组之外，1表示在记录数组中，2表示在一条记录中
+    size_t nested_depth_{0}; // 记录中正在构建的对象或数组的嵌套层数
+    JsonBuilder nested_;
+    size_t column_{0}; // 当前键对应的列
+    size_t member_{0}; // 当前记录已读到的键的个数
+    bool not_records_{false};
+
+    bool Reject() noexcept
+    {
+        not_records_ = true;
+        return false;
+    }
+
+    // 记录中的标量写入当前列，记录数组中直接出现的标量说明不是记录数组
+    RecordColumn *CurrentColumn() noexcept
+    {
+        return depth_ == 2 ? &table_.columns_[column_] : nullptr;
+    }
+
+    bool EndNested(bool result);
+};
+
+bool RecordTableBuilder::StartObject()
+{
+    if (nested_depth_ > 0 || depth_ == 2)
+    {
+        ++nested_depth_;
+        return nested_.StartObject();
+    }
+    if (depth_ == 1)
+    {
+        depth_ = 2;
+        member_ = 0;
+        return true;
+    }
+    return Reject();
+}
+
+bool RecordTableBuilder::Key(const std::string_view key)
+{
+    if (nested_depth_ > 0)
+    {
+        return nested_.Key(key);
+    }
+
+    column_ = table_.ColumnIndex(key, member_);
+    if (table_.rows_ == 0)
+    {
+        // 第一条记录确定有哪些列
+        if (column_ != table_.ColumnCount())
+        {
+            return Reject();
+        }
+        table_.keys_.emplace_back(key);
+        table_.columns_.emplace_back();
+    }
+    else if (column_ == table_.ColumnCount() || table_.columns_[column_].Size() != table_.rows_)
+    {
+        // 没有这一列，或者这条记录中的键重复了
+        return Reject();
+    }
+    ++member_;
+    return true;
+}
+
+bool RecordTableBuilder::EndObject(const size_t member_count)
+{
+    if (nested_depth_ > 0)
+    {
+        return EndNested(nested_.EndObject(member_count));
+    }
+
+    // 键各不相同且个数与列数相同，每一列都恰好有这一行的值
+    if (member_ != table_.ColumnCount())
+    {
+        return Reject();
+    }
+    ++table_.rows_;
+    depth_ = 1;
+    return true;
+}
+
+bool RecordTableBuilder::StartArray()
+{
+    if (nested_depth_ > 0 || depth_ == 2)
+    {
+        ++nested_depth_;
+        return nested_.StartArray();
+    }
+    if (depth_ == 0)
+    {
+        depth_ = 1;
+        return true;
+    }
+    return Reject();
+}
+
+bool RecordTableBuilder::EndArray(const size_t element_count)
+{
+    if (nested_depth_ > 0)
+    {
+        return EndNested(nested_.EndArray(element_count));
+    }
+    depth_ = 0;
+    return true;
+}
+
+bool RecordTableBuilder::String(const std::string_view value)
+{
+    if (nested_depth_ > 0)
+    {
+        return nested_.String(value);
+    }
+    RecordColumn *column = CurrentColumn();
+    if (column == nullptr)
+    {
+        return Reject();
+    }
+    column->AppendString(value);
+    return true;
+}
+
+bool RecordTableBuilder::Int(const long long value)
+{
+    if (nested_depth_ > 0)
+    {
+        return nested_.Int(value);
+    }
+    RecordColumn *column = CurrentColumn();
+    if (column == nullptr)
+    {
+        return Reject();
+    }
+    column->AppendInt(value);
+    return true;
+}
+
+bool RecordTableBuilder::Float(const long double value)
+{
+    if (nested_depth_ > 0)
+    {
+        return nested_.Float(value);
+    }
+    RecordColumn *column = CurrentColumn();
+    if (column == nullptr)
+    {
+        return Reject();
+    }
+    column->AppendFloat(value);
+    return true;
+}
+
+bool RecordTableBuilder::Bool(const bool value)
+{
+    if (nested_depth_ > 0)
+    {
+        return nested_.Bool(value);
+    }
+    RecordColumn *column = CurrentColumn();
+    if (column == nullptr)
+    {
+        return Reject();
+    }
+    column->AppendBool(value);
+    return true;
+}
+
+bool RecordTableBuilder::Null()
+{
+    if (nested_depth_ > 0)
+    {
+        return nested_.Null();
+    }
+    RecordColumn *column = CurrentColumn();
+    if (column == nullptr)
+    {
+        return Reject();
+    }
+    column->AppendNull();
+    return true;
+}
+
+bool RecordTableBuilder::EndNested(const bool result)
+{
+    if (--nested_depth_ == 0)
+    {
+        table_.columns_[column_].AppendValue(nested_.TakeValue());
+    }
+    return result;
+}
+
+RecordTable RecordTableBuilder::TakeTable() noexcept
+{
+    for (RecordColumn &column : table_.columns_)
+    {
+        column.ShrinkToFit();
+    }
+    return std::move(table_);
+}
+
+bool RecordColumn::IsNull(const size_t row) const
+{
+    CheckRow(row);
+    switch (type_)
+    {
+    case ColumnType::Null:
+        return true;
+    case ColumnType::Value:
+        return values_[row].GetType() == JsonType::Null;
+    default:
+        return !nulls_.empty() && nulls_[row];
+    }
+}
+
+const std::vector<long long> &RecordColumn::GetInts() const
+{
+    if (type_ != ColumnType::Int)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetInts()!")));
+    }
+    return ints_;
+}
+
+const std::vector<long double> &RecordColumn::GetFloats() const
+{
+    if (type_ != ColumnType::Float)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetFloats()!")));
+    }
+    return floats_;
+}
+
+const std::vector<uint8_t> &RecordColumn::GetBools() const
+{
+    if (type_ != ColumnType::Bool)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetBools()!")));
+    }
+    return bools_;
+}
+
+std::string_view RecordColumn::GetString(const size_t row) const
+{
+    if (type_ != ColumnType::String)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetString()!")));
+    }
+    CheckRow(row);
+    return std::string_view(chars_).substr(offsets_[row], offsets_[row + 1] - offsets_[row]);
+}
+
+const std::vector<JsonValue> &RecordColumn::GetValues() const
+{
+    if (type_ != ColumnType::Value)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetValues()!")));
+    }
+    return values_;
+}
+
+JsonValue RecordColumn::ToValue(const size_t row) const
+{
+    if (IsNull(row))
+    {
+        return JsonValue();
+    }
+
+    switch (type_)
+    {
+    case ColumnType::Int:
+        return JsonValue(static_cast<long long>(ints_[row]));
+    case ColumnType::Float:
+        return JsonValue(static_cast<long double>(floats_[row]));
+    case ColumnType::Bool:
+        return JsonValue(bools_[row] != 0);
+    case ColumnType::String:
+        return JsonValue(std::string(GetString(row)));
+    case ColumnType::Value:
+        return values_[row];
+    case ColumnType::Null:
+        break;
+    }
+    return JsonValue();
+}
+
+void RecordColumn::AppendNull()
+{
+    switch (type_)
+    {
+    case ColumnType::Null:
+        break;
+    case ColumnType::Value:
+        values_.emplace_back();
+        break;
+    default:
+        // 第一次出现null时才为之前的行补上标记
+        if (nulls_.empty())
+        {
+            nulls_.assign(size_, false);
+        }
+        nulls_.push_back(true);
+        if (type_ == ColumnType::Int)
+        {
+            ints_.push_back(0);
+        }
+        else if (type_ == ColumnType::Float)
+        {
+            floats_.push_back(0);
+        }
+        else if (type_ == ColumnType::Bool)
+        {
+            bools_.push_back(0);
+        }
+        else
+        {
+            offsets_.push_back(chars_.size());
+        }
+        break;
+    }
+    ++size_;
+}
+
+void RecordColumn::AppendInt(const long long value)
+{
+    if (Accept(ColumnType::Int))
+    {
+        ints_.push_back(value);
+        MarkPresent();
+    }
+    else
+    {
+        values_.emplace_back(static_cast<long long>(value));
+    }
+    ++size_;
+}
+
+void RecordColumn::AppendFloat(const long double value)
+{
+    if (Accept(ColumnType::Float))
+    {
+        floats_.push_back(value);
+        MarkPresent();
+    }
+    else
+    {
+        values_.emplace_back(static_cast<long double>(value));
+    }
+    ++size_;
+}
+
+void RecordColumn::AppendBool(const bool value)
+{
+    if (Accept(ColumnType::Bool))
+    {
+        bools_.push_back(value ? 1 : 0);
+        MarkPresent();
+    }
+    else
+    {
+        values_.emplace_back(static_cast<bool>(value));
+    }
+    ++size_;
+}
+
+void RecordColumn::AppendString(const std::string_view value)
+{
+    if (Accept(ColumnType::String))
+    {
+        chars_.append(value);
+        offsets_.push_back(chars_.size());
+        MarkPresent();
+    }
+    else
+    {
+        values_.emplace_back(std::string(value));
+    }
+    ++size_;
+}
+
+void RecordColumn::AppendValue(JsonValue &&value)
+{
+    Accept(ColumnType::Value);
+    values_.push_back(std::move(value));
+    ++size_;
+}
+
+void RecordColumn::Append(const JsonValue &value)
+{
+    switch (value.GetType())
+    {
+    case JsonType::Object:
+    case JsonType::Array:
+        AppendValue(JsonValue(value));
+        break;
+    case JsonType::String:
+        AppendString(value.GetVal<JsonType::String>());
+        break;
+    case JsonType::Int:
+        AppendInt(value.GetVal<JsonType::Int>());
+        break;
+    case JsonType::Float:
+        AppendFloat(value.GetVal<JsonType::Float>());
+        break;
+    case JsonType::Bool:
+        AppendBool(value.GetVal<JsonType::Bool>());
+        break;
+    case JsonType::Null:
+        AppendNull();
+        break;
+    }
+}
+
+void RecordColumn::CheckRow(const size_t row) const
+{
+    if (row >= size_)
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+}
+
+bool RecordColumn::Accept(const ColumnType type)
+{
+    if (type_ == ColumnType::Null)
+    {
+        // 之前的行全是null，改为type类型，这些行以默认值占位并标记为null
+        type_ = type;
+        switch (type)
+        {
+        case ColumnType::Int:
+            ints_.assign(size_, 0);
+            break;
+        case ColumnType::Float:
+            floats_.assign(size_, 0);
+            break;
+        case ColumnType::Bool:
+            bools_.assign(size_, 0);
+            break;
+        case ColumnType::String:
+            offsets_.assign(size_ + 1, 0);
+            break;
+        case ColumnType::Value:
+            values_.assign(size_, JsonValue());
+            return true;
+        case ColumnType::Null:
+            break;
+        }
+        if (size_ > 0)
+        {
+            nulls_.assign(size_, true);
+        }
+    }
+    else if (type_ != type && type_ != ColumnType::Value)
+    {
+        Demote();
+    }
+    return type_ == type;
+}
+
+void RecordColumn::MarkPresent()
+{
+    if (!nulls_.empty())
+    {
+        nulls_.push_back(false);
+    }
+}
+
+void RecordColumn::Demote()
+{
+    std::vector<JsonValue> values;
+    values.reserve(size_);
+    for (size_t row = 0; row < size_; ++row)
+    {
+        values.push_back(ToValue(row));
+    }
+
+    // 赋值为空容器，释放原来的内存
+    ints_ = std::vector<long long>();
+    floats_ = std::vector<long double>();
+    bools_ = std::vector<uint8_t>();
+    chars_ = std::string();
+    offsets_ = std::vector<size_t>();
+    nulls_ = std::vector<bool>();
+    values_ = std::move(values);
+    type_ = ColumnType::Value;
+}
+
+void RecordColumn::ShrinkToFit()
+{
+    ints_.shrink_to_fit();
+    floats_.shrink_to_fit();
+    bools_.shrink_to_fit();
+    chars_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+    values_.shrink_to_fit();
+    nulls_.shrink_to_fit();
+}
+
+std::optional<RecordTable> RecordTable::FromString(const std::string_view json_str)
+{
+    Lexer lexer(json_str);
+    const JsonData json_data = lexer.TakeToken();
+
+    RecordTableBuilder builder;
+    SaxReader reader(json_data);
+    if (!reader.Parse(builder))
+    {
+        if (builder.NotRecords())
+        {
+            return std::nullopt;
+        }
+        reader.ThrowError();
+    }
+    return builder.TakeTable();
+}
+
+std::optional<RecordTable> RecordTable::FromValue(const JsonValue &value)
+{
+    if (value.GetType() != JsonType::Array)
+    {
+        return std::nullopt;
+    }
+
+    RecordTable table;
+    for (const JsonValue &record : value.GetVal<JsonType::Array>())
+    {
+        if (record.GetType() != JsonType::Object)
+        {
+            return std::nullopt;
+        }
+
+        const auto &object = record.GetVal<JsonType::Object>();
+        if (table.rows_ == 0)
+        {
+            // 对象的键没有顺序，列按第一条记录的遍历顺序排列
+            for (const auto &[key, member] : object)
+            {
+                table.keys_.push_back(key);
+                table.columns_.emplace_back();
+            }
+        }
+        else if (object.size() != table.ColumnCount())
+        {
+            return std::nullopt;
+        }
+
+        // 对象的键各不相同，个数相同且都能找到时每一列恰好得到一个值
+        size_t position = 0;
+        for (const auto &[key, member] : object)
+        {
+            const size_t column = table.ColumnIndex(key, position++);
+            if (column == table.ColumnCount())
+            {
+                return std::nullopt;
+            }
+            table.columns_[column].Append(member);
+        }
+        ++table.rows_;
+    }
+
+    for (RecordColumn &column : table.columns_)
+    {
+        column.ShrinkToFit();
+    }
+    return table;
+}
+
+const RecordColumn &RecordTable::GetColumn(const size_t index) const
+{
+    if (index >= columns_.size())
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+    return columns_[index];
+}
+
+const RecordColumn *RecordTable::Find(const std::string_view key) const noexcept
+{
+    const size_t index = ColumnIndex(key, 0);
+    return index == columns_.size() ? nullptr : &columns_[index];
+}
+
+JsonValue RecordTable::Row(const size_t row) const
+{
+    if (row >= rows_)
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+
+    std::unordered_map<std::string, JsonValue> object;
+    object.reserve(keys_.size());
+    for (size_t i = 0; i < keys_.size(); ++i)
+    {
+        object.emplace(keys_[i], columns_[i].ToValue(row));
+    }
+    return JsonValue(std::move(object));
+}
+
+JsonValue RecordTable::ToValue() const
+{
+    std::vector<JsonValue> array;
+    array.reserve(rows_);
+    for (size_t row = 0; row < rows_; ++row)
+    {
+        array.push_back(Row(row));
+    }
+    return JsonValue(std::move(array));
+}
+
+MemoryFootprint RecordTable::MemoryUsage() const
+{
+    MemoryFootprint usage;
+    AddVectorUsage(keys_, usage);
+    for (const std::string &key : keys_)
+    {
+        AddStringUsage(key, usage);
+    }
+
+    AddVectorUsage(columns_, usage);
+    for (const RecordColumn &column : columns_)
+    {
+        AddVectorUsage(column.ints_, usage);
+        AddVectorUsage(column.floats_, usage);
+        AddVectorUsage(column.bools_, usage);
+        AddStringUsage(column.chars_, usage);
+        AddVectorUsage(column.offsets_, usage);
+        AddVectorUsage(column.values_, usage);
+        for (const JsonValue &value : column.values_)
+        {
+            usage += value.MemoryUsage();
+        }
+        // vector<bool>按位存放
+        usage.nodes_ += (column.nulls_.size() + 7) / 8;
+        usage.capacity_slack_ += (column.nulls_.capacity() - column.nulls_.size()) / 8;
+    }
+    return usage;
+}
+
+size_t RecordTable::ColumnIndex(const std::string_view key, const size_t guess) const noexcept
+{
+    // 记录的键通常与第一条记录的顺序相同
+    if (guess < keys_.size() && keys_[guess] == key)
+    {
+        return guess;
+    }
+    for (size_t i = 0; i < keys_.size(); ++i)
+    {
+        if (keys_[i] == key)
+        {
+            return i;
+        }
+    }
+    return keys_.size();
+}
+} // namespace simple_json
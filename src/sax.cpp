@@ -0,0 +1,345 @@
+#include "sax.h"
+#include "config.h"
+#include "json_type.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+bool JsonBuilder::StartObject()
+{
+    stack_.emplace_back(std::unordered_map<std::string, JsonValue>{});
+    return true;
+}
+
+bool JsonBuilder::Key(const std::string_view key)
+{
+    keys_.emplace_back(key);
+    return true;
+}
+
+bool JsonBuilder::EndObject(size_t /*member_count*/)
+{
+    JsonValue value = std::move(stack_.back());
+    stack_.pop_back();
+    AddValue(std::move(value));
+    return true;
+}
+
+bool JsonBuilder::StartArray()
+{
+    stack_.emplace_back(std::vector<JsonValue>{});
+    return true;
+}
+
+bool JsonBuilder::EndArray(size_t /*element_count*/)
+{
+    JsonValue value = std::move(stack_.back());
+    stack_.pop_back();
+    AddValue(std::move(value));
+    return true;
+}
+
+bool JsonBuilder::String(const std::string_view value)
+{
+    AddValue(JsonValue(std::string(value)));
+    return true;
+}
+
+bool JsonBuilder::Int(const long long value)
+{
+    AddValue(JsonValue(static_cast<long long>(value)));
+    return true;
+}
+
+bool JsonBuilder::Float(const long double value)
+{
+    AddValue(JsonValue(static_cast<long double>(value)));
+    return true;
+}
+
+bool JsonBuilder::Bool(const bool value)
+{
+    AddValue(JsonValue(value));
+    return true;
+}
+
+bool JsonBuilder::Null()
+{
+    AddValue(JsonValue(nullptr));
+    return true;
+}
+
+JsonValue JsonBuilder::TakeValue() noexcept
+{
+    JsonValue value = std::move(root_);
+    root_ = JsonValue();
+    stack_.clear();
+    keys_.clear();
+    return value;
+}
+
+void JsonBuilder::AddValue(JsonValue &&value)
+{
+    if (stack_.empty())
+    {
+        root_ = std::move(value);
+        return;
+    }
+
+    JsonValue &container = stack_.back();
+    if (container.GetType() == JsonType::Object)
+    {
+        // 与Parser一致，重复的键以最后一个为准
+        container.GetVal<JsonType::Object>()[std::move(keys_.back())] = std::move(value);
+        keys_.pop_back();
+    }
+    else
+    {
+        container.GetVal<JsonType::Array>().push_back(std::move(value));
+    }
+}
+
+bool SaxTee::StartObject()
+{
+    return first_.StartObject() && second_.StartObject();
+}
+
+bool SaxTee::Key(const std::string_view key)
+{
+    return first_.Key(key) && second_.Key(key);
+}
+
+bool SaxTee::EndObject(const size_t member_count)
+{
+    return first_.EndObject(member_count) && second_.EndObject(member_count);
+}
+
+bool SaxTee::StartArray()
+{
+    return first_.StartArray() && second_.StartArray();
+}
+
+bool SaxTee::EndArray(const size_t element_count)
+{
+    return first_.EndArray(element_count) && second_.EndArray(element_count);
+}
+
+bool SaxTee::String(const std::string_view value)
+{
+    return first_.String(value) && second_.String(value);
+}
+
+bool SaxTee::Int(const long long value)
+{
+    return first_.Int(value) && second_.Int(value);
+}
+
+bool SaxTee::Float(const long double value)
+{
+    return first_.Float(value) && second_.Float(value);
+}
+
+bool SaxTee::Bool(const bool value)
+{
+    return first_.Bool(value) && second_.Bool(value);
+}
+
+bool SaxTee::Null()
+{
+    return first_.Null() && second_.Null();
+}
+
+std::string SaxTee::GetError() const
+{
+    std::string err_desc = first_.GetError();
+    return err_desc.empty() ? second_.GetError() : err_desc;
+}
+
+bool SaxReader::Parse(SaxHandler &handler)
+{
+    // json顶层必须是对象或者数组
+    if (const Token *top = reader_.Current(); top->type_ != TokenType::LBRACE && top->type_ != TokenType::LBRACKET)
+    {
+        return Fail(ERR_MISMATCH_TOP_LEVEL, top);
+    }
+    return ParseValue(handler);
+}
+
+bool SaxReader::ParseValue(SaxHandler &handler)
+{
+    containers_.clear();
+    counts_.clear();
+
+    while (true)
+    {
+        // 此时游标位于某个值的第一个token上
+        const Token *token = reader_.Current();
+        bool empty_container = false; // 刚打开的容器是否为空，此时游标已经位于右括号上
+        if (token->type_ == TokenType::LBRACE || token->type_ == TokenType::LBRACKET)
+        {
+            const bool is_object = token->type_ == TokenType::LBRACE;
+            if (!(is_object ? handler.StartObject() : handler.StartArray()))
+            {
+                return Abort(handler, token);
+            }
+            containers_.push_back(is_object);
+            counts_.push_back(0);
+            reader_.Advance();
+
+            const TokenType close = is_object ? TokenType::RBRACE : TokenType::RBRACKET;
+            if (reader_.Current()->type_ != close)
+            {
+                if (is_object && !ReadKey(handler))
+                {
+                    return false;
+                }
+                continue;
+            }
+            empty_container = true;
+        }
+        else if (!EmitScalar(handler, token))
+        {
+            return false;
+        }
+
+        // 一个值读取完毕，接下来处理逗号以及容器的闭合，闭合后的容器本身又是外层容器中一个读取完毕的值
+        while (!containers_.empty())
+        {
+            const bool is_object = containers_.back();
+            const TokenType close = is_object ? TokenType::RBRACE : TokenType::RBRACKET;
+            const Token *next = reader_.Current();
+            if (!empty_container)
+            {
+                ++counts_.back();
+                const Token *last = next;
+                next = reader_.Advance();
+                if (next->type_ == TokenType::COMMA)
+                {
+                    if (reader_.Peek()->type_ == close && !ALLOW_TRAILING_COMMA)
+                    {
+                        return Fail(ERR_TRAILING_COMMA, next);
+                    }
+                    reader_.Advance();
+                    if (reader_.Current()->type_ != close)
+                    {
+                        break;
+                    }
+                    next = reader_.Current();
+                }
+                else if (next->type_ != close)
+                {
+                    return Fail(is_object ? ERR_COMMA_OR_BRACE_EXPECTED : ERR_COMMA_OR_BRACKET_EXPECTED, last,
+                                last->col_ + last->len_, 1);
+                }
+            }
+
+            empty_container = false;
+            const size_t count = counts_.back();
+            containers_.pop_back();
+            counts_.pop_back();
+            if (!(is_object ? handler.EndObject(count) : handler.EndArray(count)))
+            {
+                return Abort(handler, next);
+            }
+        }
+
+        if (containers_.empty())
+        {
+            return true;
+        }
+        if (containers_.back() && !ReadKey(handler))
+        {
+            return false;
+        }
+    }
+}
+
+bool SaxReader::HasError() const noexcept
+{
+    return err_reporter_.HasError();
+}
+
+void SaxReader::ThrowError() const
+{
+    err_reporter_.ThrowError();
+}
+
+bool SaxReader::Fail(std::string err_desc, const Token *token, const size_t highlight_pos, const size_t highlight_len)
+{
+    err_reporter_.AddError(reader_.MakeErrInfo(std::move(err_desc), token, highlight_pos, highlight_len));
+    return false;
+}
+
+bool SaxReader::Abort(const SaxHandler &handler, const Token *token)
+{
+    std::string err_desc = handler.GetError();
+    return Fail(err_desc.empty() ? ERR_SAX_HANDLER_STOPPED : std::move(err_desc), token);
+}
+
+bool SaxReader::ReadKey(SaxHandler &handler)
+{
+    // json对象的键必须为字符串，并且后面紧跟冒号
+    const Token *key = reader_.Current();
+    if (key->type_ != TokenType::STR)
+    {
+        return Fail(ERR_OBJECT_KEY_MUST_BE_STRING, key);
+    }
+    if (reader_.Peek()->type_ != TokenType::COLON)
+    {
+        return Fail(ERR_COLON_EXPECTED, key, key->col_ + key->len_, 1);
+    }
+    if (!handler.Key(key->raw_value_))
+    {
+        return Abort(handler, key);
+    }
+
+    reader_.Advance();
+    reader_.Advance();
+    return true;
+}
+
+bool SaxReader::EmitScalar(SaxHandler &handler, const Token *token)
+{
+    bool accepted = true;
+    switch (token->type_)
+    {
+    case TokenType::STR:
+        accepted = handler.String(token->raw_value_);
+        break;
+    case TokenType::NUM: {
+        // 与Parser一致，没有小数点和指数的数字为整数，超出long long范围时退化为浮点数
+        const std::string &raw = token->raw_value_;
+        long long int_value = 0;
+        if (raw.find_first_of(".eE") == std::string::npos &&
+            std::from_chars(raw.data(), raw.data() + raw.size(), int_value).ec == std::errc())
+        {
+            accepted = handler.Int(int_value);
+        }
+        else
+        {
+            accepted = handler.Float(std::strtold(raw.c_str(), nullptr));
+        }
+        break;
+    }
+    case TokenType::TRUE:
+        accepted = handler.Bool(true);
+        break;
+    case TokenType::FALSE:
+        accepted = handler.Bool(false);
+        break;
+    case TokenType::NULL_:
+        accepted = handler.Null();
+        break;
+    default:
+        return Fail(ERR_EXPECTED_JSON_VALUE_TYPE, token);
+    }
+
+    return accepted || Abort(handler, token);
+}
+} // namespace simple_json
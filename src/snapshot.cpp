@@ -0,0 +1,553 @@
+#include "snapshot.h"
+#include "config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+
+// 文件布局，所有偏移都相对于文件起始位置，块按8字节对齐：
+// header: magic[8] version:u32 endian:u32 size:u64 checksum:u64 root:slot，校验和覆盖root及之后的所有内容
+// slot:   type:u8 pad[3] aux:u32 payload:u64，标量直接保存在payload中，字符串和容器保存偏移
+// array:  count:u64 slot[count]
+// object: count:u64 entry[count]，entry为key_offset:u64 key_length:u32 pad:u32 value:slot，按键排序
+// 字符串以原始字节加上结尾的'\0'保存，不要求对齐
+constexpr char MAGIC[8] = {'S', 'J', 'S', 'N', 'A', 'P', 'S', 'H'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t ENDIAN_MARK = 0x01020304;
+
+constexpr size_t VERSION_OFFSET = 8;
+constexpr size_t ENDIAN_OFFSET = 12;
+constexpr size_t SIZE_OFFSET = 16;
+constexpr size_t CHECKSUM_OFFSET = 24;
+constexpr size_t ROOT_OFFSET = 32;
+constexpr size_t HEADER_SIZE = 48;
+
+constexpr size_t SLOT_SIZE = 16;
+constexpr size_t ENTRY_SIZE = 32;
+constexpr size_t COUNT_SIZE = 8;
+
+template <typename T> T Load(const char *base, const uint64_t offset) noexcept
+{
+    T value;
+    std::memcpy(&value, base + offset, sizeof(T));
+    return value;
+}
+
+template <typename T> void Store(std::string &out, const uint64_t offset, const T value) noexcept
+{
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+uint64_t Checksum(const char *data, const size_t size) noexcept
+{
+    // 按8字节分组，循环移位让每一位的变化都能扩散到整个结果
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        hash = (((hash << 31) | (hash >> 33)) ^ Load<uint64_t>(data, i)) * 0x100000001b3ULL;
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+[[noreturn]] void ThrowInvalid(const std::string &detail)
+{
+    SIMPLE_JSON_THROW(std::runtime_error(ERR_INVALID_SNAPSHOT + detail));
+}
+
+class SnapshotBuilder
+{
+  public:
+    std::string Build(const JsonValue &value)
+    {
+        out_.assign(HEADER_SIZE, '\0');
+        std::memcpy(out_.data(), MAGIC, sizeof(MAGIC));
+        Store(out_, VERSION_OFFSET, VERSION);
+        Store(out_, ENDIAN_OFFSET, ENDIAN_MARK);
+        PutSlot(ROOT_OFFSET, value);
+        Align();
+
+        Store<uint64_t>(out_, SIZE_OFFSET, out_.size());
+        Store(out_, CHECKSUM_OFFSET, Checksum(out_.data() + ROOT_OFFSET, out_.size() - ROOT_OFFSET));
+        return std::move(out_);
+    }
+
+  private:
+    std::string out_;
+    std::unordered_map<std::string_view, uint64_t> keys_; // 相同的键只保存一次
+
+    void Align()
+    {
+        out_.resize((out_.size() + 7) & ~size_t{7}, '\0');
+    }
+
+    uint64_t AppendString(const std::string &str)
+    {
+        if (str.size() > UINT32_MAX)
+        {
+            SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_SNAPSHOT + std::string("string is too long")));
+        }
+        const uint64_t offset = out_.size();
+        out_.append(str);
+        out_.push_back('\0');
+        return offset;
+    }
+
+    // 先写出子节点再回填slot，写出子节点时out_可能扩容，只能通过偏移访问
+    void PutSlot(const uint64_t slot_offset, const JsonValue &value)
+    {
+        uint32_t aux = 0;
+        uint64_t payload = 0;
+        switch (value.GetType())
+        {
+        case JsonType::Object:
+            payload = WriteObject(value.GetVal<JsonType::Object>());
+            break;
+        case JsonType::Array:
+            payload = WriteArray(value.GetVal<JsonType::Array>());
+            break;
+        case JsonType::String:
+            payload = AppendString(value.GetVal<JsonType::String>());
+            aux = static_cast<uint32_t>(value.GetVal<JsonType::String>().size());
+            break;
+        case JsonType::Int:
+            payload = static_cast<uint64_t>(value.GetVal<JsonType::Int>());
+            break;
+        case JsonType::Float: {
+            const auto number = static_cast<double>(value.GetVal<JsonType::Float>());
+            std::memcpy(&payload, &number, sizeof(payload));
+            break;
+        }
+        case JsonType::Bool:
+            payload = value.GetVal<JsonType::Bool>() ? 1 : 0;
+            break;
+        case JsonType::Null:
+            break;
+        }
+
+        out_[slot_offset] = static_cast<char>(value.GetType());
+        Store(out_, slot_offset + 4, aux);
+        Store(out_, slot_offset + 8, payload);
+    }
+
+    uint64_t WriteArray(const std::vector<JsonValue> &array)
+    {
+        Align();
+        const uint64_t block = out_.size();
+        out_.resize(block + COUNT_SIZE + array.size() * SLOT_SIZE, '\0');
+        Store<uint64_t>(out_, block, array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            PutSlot(block + COUNT_SIZE + i * SLOT_SIZE, array[i]);
+        }
+        return block;
+    }
+
+    uint64_t WriteObject(const std::unordered_map<std::string, JsonValue> &object)
+    {
+        std::vector<const std::pair<const std::string, JsonValue> *> members;
+        members.reserve(object.size());
+        for (const auto &member : object)
+        {
+            members.push_back(&member);
+        }
+        std::sort(members.begin(), members.end(),
+                  [](const auto *lhs, const auto *rhs) { return lhs->first < rhs->first; });
+
+        Align();
+        const uint64_t block = out_.size();
+        out_.resize(block + COUNT_SIZE + members.size() * ENTRY_SIZE, '\0');
+        Store<uint64_t>(out_, block, members.size());
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            const std::string &key = members[i]->first;
+            auto iter = keys_.find(key);
+            if (iter == keys_.end())
+            {
+                iter = keys_.emplace(key, AppendString(key)).first;
+            }
+
+            const uint64_t entry = block + COUNT_SIZE + i * ENTRY_SIZE;
+            Store(out_, entry, iter->second);
+            Store(out_, entry + 8, static_cast<uint32_t>(key.size()));
+            PutSlot(entry + 16, members[i]->second);
+        }
+        return block;
+    }
+};
+
+} // namespace
+
+std::string BuildSnapshot(const JsonValue &value)
+{
+    SnapshotBuilder builder;
+    return builder.Build(value);
+}
+
+void SaveSnapshot(const JsonValue &value, const std::filesystem::path &file_path)
+{
+    const std::string snapshot = BuildSnapshot(value);
+    std::ofstream fs(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fs.is_open())
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    fs.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size()));
+    if (!fs)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+}
+
+SnapshotView::SnapshotView(const char *base, const uint64_t slot_offset) noexcept
+    : base_(base), type_(static_cast<JsonType>(Load<uint8_t>(base, slot_offset))),
+      aux_(Load<uint32_t>(base, slot_offset + 4)), payload_(Load<uint64_t>(base, slot_offset + 8))
+{
+}
+
+long long SnapshotView::GetInt() const
+{
+    if (type_ != JsonType::Int)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetInt()!")));
+    }
+    return static_cast<long long>(payload_);
+}
+
+long double SnapshotView::GetFloat() const
+{
+    if (type_ != JsonType::Float)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetFloat()!")));
+    }
+    double number = 0;
+    std::memcpy(&number, &payload_, sizeof(number));
+    return number;
+}
+
+bool SnapshotView::GetBool() const
+{
+    if (type_ != JsonType::Bool)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetBool()!")));
+    }
+    return payload_ != 0;
+}
+
+std::string_view SnapshotView::GetString() const
+{
+    if (type_ != JsonType::String)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(ERR_TYPE_MISMATCH + std::string("in function GetString()!")));
+    }
+    return {base_ + payload_, aux_};
+}
+
+size_t SnapshotView::Size() const noexcept
+{
+    if (type_ != JsonType::Object && type_ != JsonType::Array)
+    {
+        return 0;
+    }
+    return static_cast<size_t>(Load<uint64_t>(base_, payload_));
+}
+
+SnapshotView SnapshotView::operator[](const size_t index) const
+{
+    if (type_ != JsonType::Array)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_ARRAY_INTEGRAL));
+    }
+    if (index >= Size())
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+    return {base_, payload_ + COUNT_SIZE + index * SLOT_SIZE};
+}
+
+SnapshotView SnapshotView::operator[](const std::string_view key) const
+{
+    if (type_ != JsonType::Object)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_OBJECT_STRING));
+    }
+    const auto member = Find(key);
+    if (!member)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_INVALID_KEY));
+    }
+    return *member;
+}
+
+std::optional<SnapshotView> SnapshotView::Find(const std::string_view key) const noexcept
+{
+    if (type_ != JsonType::Object)
+    {
+        return std::nullopt;
+    }
+
+    // 键表已按字节序排好，二分查找
+    size_t low = 0;
+    size_t high = Size();
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        const uint64_t entry = ObjectEntry(mid);
+        const std::string_view mid_key(base_ + Load<uint64_t>(base_, entry), Load<uint32_t>(base_, entry + 8));
+        const int order = mid_key.compare(key);
+        if (order == 0)
+        {
+            return SnapshotView(base_, entry + 16);
+        }
+        if (order < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view SnapshotView::KeyAt(const size_t index) const
+{
+    if (type_ != JsonType::Object)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_TYPE_NOT_OBJECT));
+    }
+    if (index >= Size())
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+    const uint64_t entry = ObjectEntry(index);
+    return {base_ + Load<uint64_t>(base_, entry), Load<uint32_t>(base_, entry + 8)};
+}
+
+SnapshotView SnapshotView::ValueAt(const size_t index) const
+{
+    if (type_ != JsonType::Object)
+    {
+        SIMPLE_JSON_THROW(std::invalid_argument(ERR_TYPE_NOT_OBJECT));
+    }
+    if (index >= Size())
+    {
+        SIMPLE_JSON_THROW(std::out_of_range(ERR_OUT_OF_RANGE));
+    }
+    return {base_, ObjectEntry(index) + 16};
+}
+
+std::optional<SnapshotView> SnapshotView::Resolve(const JsonPointer &pointer) const noexcept
+{
+    SnapshotView cur = *this;
+    for (const PointerSegment &segment : pointer.Segments())
+    {
+        if (cur.type_ == JsonType::Object)
+        {
+            const auto member = cur.Find(segment.key_);
+            if (!member)
+            {
+                return std::nullopt;
+            }
+            cur = *member;
+        }
+        else if (cur.type_ == JsonType::Array && segment.index_ < cur.Size())
+        {
+            cur = SnapshotView(base_, cur.payload_ + COUNT_SIZE + segment.index_ * SLOT_SIZE);
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    return cur;
+}
+
+JsonValue SnapshotView::ToValue() const
+{
+    switch (type_)
+    {
+    case JsonType::Object: {
+        std::unordered_map<std::string, JsonValue> object;
+        object.reserve(Size());
+        for (size_t i = 0; i < Size(); ++i)
+        {
+            object.emplace(KeyAt(i), ValueAt(i).ToValue());
+        }
+        return JsonValue(std::move(object));
+    }
+    case JsonType::Array: {
+        std::vector<JsonValue> array;
+        array.reserve(Size());
+        for (size_t i = 0; i < Size(); ++i)
+        {
+            array.push_back((*this)[i].ToValue());
+        }
+        return JsonValue(std::move(array));
+    }
+    case JsonType::String:
+        return JsonValue(std::string(GetString()));
+    case JsonType::Int:
+        return JsonValue(GetInt());
+    case JsonType::Float:
+        return JsonValue(GetFloat());
+    case JsonType::Bool:
+        return JsonValue(GetBool());
+    default:
+        return {};
+    }
+}
+
+uint64_t SnapshotView::ObjectEntry(const size_t index) const noexcept
+{
+    return payload_ + COUNT_SIZE + index * ENTRY_SIZE;
+}
+
+JsonSnapshot::JsonSnapshot(JsonSnapshot &&other) noexcept
+    : data_(other.data_), size_(other.size_), mapping_(other.mapping_), buffer_(std::move(other.buffer_))
+{
+    // 数据在buffer_中时，移动之后地址以新的buffer_为准
+    if (mapping_ == nullptr)
+    {
+        data_ = buffer_.data();
+    }
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapping_ = nullptr;
+}
+
+JsonSnapshot &JsonSnapshot::operator=(JsonSnapshot &&other) noexcept
+{
+    if (this != &other)
+    {
+        Unmap();
+        mapping_ = other.mapping_;
+        size_ = other.size_;
+        buffer_ = std::move(other.buffer_);
+        data_ = mapping_ == nullptr ? buffer_.data() : other.data_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapping_ = nullptr;
+    }
+    return *this;
+}
+
+JsonSnapshot::~JsonSnapshot()
+{
+    Unmap();
+}
+
+JsonSnapshot JsonSnapshot::Open(const std::filesystem::path &file_path, const bool verify_checksum)
+{
+    JsonSnapshot snapshot;
+#if defined(_WIN32)
+    std::ifstream fs(file_path, std::ios::in | std::ios::binary);
+    if (!fs.is_open())
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    snapshot.buffer_.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+    snapshot.data_ = snapshot.buffer_.data();
+    snapshot.size_ = snapshot.buffer_.size();
+#else
+    // 只读共享映射，多个进程打开同一个文件时共用页缓存
+    const int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    struct stat file_stat = {};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(HEADER_SIZE))
+    {
+        close(fd);
+        ThrowInvalid("file is too small");
+    }
+    void *mapping = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        SIMPLE_JSON_THROW(std::runtime_error(FAILED_OPEN_FILE));
+    }
+    snapshot.mapping_ = mapping;
+    snapshot.data_ = static_cast<const char *>(mapping);
+    snapshot.size_ = static_cast<size_t>(file_stat.st_size);
+#endif
+    snapshot.Validate(verify_checksum);
+    return snapshot;
+}
+
+JsonSnapshot JsonSnapshot::FromBuffer(std::string buffer, const bool verify_checksum)
+{
+    JsonSnapshot snapshot;
+    snapshot.buffer_ = std::move(buffer);
+    snapshot.data_ = snapshot.buffer_.data();
+    snapshot.size_ = snapshot.buffer_.size();
+    snapshot.Validate(verify_checksum);
+    return snapshot;
+}
+
+void JsonSnapshot::Unmap() noexcept
+{
+#if !defined(_WIN32)
+    if (mapping_ != nullptr)
+    {
+        munmap(mapping_, size_);
+        mapping_ = nullptr;
+    }
+#endif
+}
+
+SnapshotView JsonSnapshot::Root() const noexcept
+{
+    return {data_, ROOT_OFFSET};
+}
+
+void JsonSnapshot::Validate(const bool verify_checksum) const
+{
+    if (size_ < HEADER_SIZE || std::memcmp(data_, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        ThrowInvalid("not a snapshot file");
+    }
+    if (Load<uint32_t>(data_, ENDIAN_OFFSET) != ENDIAN_MARK)
+    {
+        ThrowInvalid("written on a machine with a different byte order");
+    }
+    if (const auto version = Load<uint32_t>(data_, VERSION_OFFSET); version != VERSION)
+    {
+        ThrowInvalid("unsupported version " + std::to_string(version));
+    }
+    if (Load<uint64_t>(data_, SIZE_OFFSET) != size_)
+    {
+        ThrowInvalid("file size does not match the header, the file may be truncated");
+    }
+    if (verify_checksum &&
+        Load<uint64_t>(data_, CHECKSUM_OFFSET) != Checksum(data_ + ROOT_OFFSET, size_ - ROOT_OFFSET))
+    {
+        ThrowInvalid("checksum mismatch");
+    }
+}
+} // namespace simple_json
@@ -0,0 +1,51 @@
+#include "static_json.h"
+#include "json_type.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+JsonValue StaticJsonView::ToJsonValue() const
+{
+    switch (GetType())
+    {
+    case JsonType::Object: {
+        std::unordered_map<std::string, JsonValue> object;
+        object.reserve(Node().length_);
+        // 直接沿着兄弟节点链表遍历，避免每个成员都从头查找
+        size_t cur = index_ + 1;
+        for (size_t i = 0; i < Node().length_; ++i)
+        {
+            object[std::string(StaticJsonView(nodes_, chars_, cur).GetString())] =
+                StaticJsonView(nodes_, chars_, cur + 1).ToJsonValue();
+            cur = nodes_[cur + 1].end_;
+        }
+        return {std::move(object)};
+    }
+    case JsonType::Array: {
+        std::vector<JsonValue> array;
+        array.reserve(Node().length_);
+        size_t cur = index_ + 1;
+        for (size_t i = 0; i < Node().length_; ++i)
+        {
+            array.push_back(StaticJsonView(nodes_, chars_, cur).ToJsonValue());
+            cur = nodes_[cur].end_;
+        }
+        return {std::move(array)};
+    }
+    case JsonType::String:
+        return {std::string(GetString())};
+    case JsonType::Int:
+        return {GetInt()};
+    case JsonType::Float:
+        return {GetFloat()};
+    case JsonType::Bool:
+        return {GetBool()};
+    case JsonType::Null:
+        break;
+    }
+    return {nullptr};
+}
+} // namespace simple_json
@@ -0,0 +1,518 @@
+#include "try_parse.h"
+#include "config.h"
+#include "lexer_dfa.h"
+#include "lexer_parser.h"
+#include "probes.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+// 直接在字符上运行的解析器，复用Lexer的dfa，遇到第一个错误即停止
+// 正在构建的容器保存在显式栈上，嵌套层数只受ParseLimits限制，不受调用栈大小限制
+class FastParser
+{
+  public:
+    FastParser(const std::string_view source, const ParseLimits &limits) noexcept : source_(source), limits_(limits)
+    {
+        // 常见文档的嵌套不超过这个层数，一次分配后整个解析过程中不再扩容
+        stack_.reserve(std::min<size_t>(limits_.max_depth_, 16));
+    }
+
+    ParseError Parse(JsonValue &value) noexcept
+    {
+        if (source_.size() > limits_.max_input_size_)
+        {
+            // 超过大小限制的输入一个字节都不看
+            value = JsonValue();
+            Fail(ErrorCode::INPUT_TOO_LARGE, limits_.max_input_size_);
+            return error_;
+        }
+
+        SkipSpace();
+        if (Current() != '{' && Current() != '[')
+        {
+            Fail(ErrorCode::MISMATCH_TOP_LEVEL, pos_);
+        }
+        else if (ParseDocument(value))
+        {
+            SkipSpace();
+            if (pos_ != source_.size())
+            {
+                Fail(ErrorCode::TRAILING_CONTENT, pos_);
+            }
+        }
+
+        if (!error_.Ok())
+        {
+            value = JsonValue();
+        }
+        return error_;
+    }
+
+  private:
+    // 一个尚未闭合的容器
+    struct Frame
+    {
+        bool is_object_{false};
+        std::unordered_map<std::string, JsonValue> object_;
+        std::vector<JsonValue> array_;
+        std::string key_; // 对象中等待赋值的键
+    };
+
+    std::string_view source_;
+    const ParseLimits &limits_;
+    size_t pos_{0};
+    size_t value_count_{0};
+    std::vector<Frame> stack_; // 弹出的Frame留在原处，再次进入同一层时直接复用
+    size_t depth_{0};          // 栈中正在使用的Frame个数
+    ParseError error_;
+    std::string number_; // strtold需要以'\0'结尾的字符串，数字先复制到这里
+
+    [[nodiscard]] char Current() const noexcept
+    {
+        return pos_ < source_.size() ? source_[pos_] : '\0';
+    }
+
+    void SkipSpace() noexcept
+    {
+        while (pos_ < source_.size() && IsJsonSpace(source_[pos_]))
+        {
+            ++pos_;
+        }
+    }
+
+    bool Fail(const ErrorCode code, const size_t offset) noexcept
+    {
+        error_ = {code, offset};
+        return false;
+    }
+
+    bool ParseDocument(JsonValue &root) noexcept
+    {
+        while (true)
+        {
+            // 此时位于某个值的第一个字符上
+            if (++value_count_ > limits_.max_elements_)
+            {
+                return Fail(ErrorCode::TOO_MANY_ELEMENTS, pos_);
+            }
+
+            if (const char open = Current(); open == '{' || open == '[')
+            {
+                if (depth_ >= limits_.max_depth_)
+                {
+                    return Fail(ErrorCode::NESTING_TOO_DEEP, pos_);
+                }
+                if (depth_ == stack_.size())
+                {
+                    stack_.emplace_back();
+                }
+                Frame &frame = stack_[depth_++];
+                frame.is_object_ = open == '{';
+                // 上次使用时容器已被移走，清空只是为了不依赖移动后的状态
+                if (frame.is_object_)
+                {
+                    frame.object_.clear();
+                }
+                else
+                {
+                    frame.array_.clear();
+                }
+                ++pos_;
+                SkipSpace();
+                if (Current() != (open == '{' ? '}' : ']'))
+                {
+                    if (open == '{' && !ParseKey(frame.key_))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                ++pos_;
+                JsonValue container = CloseContainer();
+                Slot(root) = std::move(container);
+            }
+            else if (!ParseScalar(Slot(root)))
+            {
+                return false;
+            }
+
+            // 一个值解析完毕，再处理逗号以及容器的闭合，闭合后的容器本身又是外层容器中一个解析完毕的值
+            while (true)
+            {
+                if (depth_ == 0)
+                {
+                    return true;
+                }
+
+                Frame &frame = stack_[depth_ - 1];
+                SkipSpace();
+                const char close = frame.is_object_ ? '}' : ']';
+                if (Current() == ',')
+                {
+                    const size_t comma = pos_;
+                    ++pos_;
+                    SkipSpace();
+                    if (Current() != close)
+                    {
+                        if (frame.is_object_ && !ParseKey(frame.key_))
+                        {
+                            return false;
+                        }
+                        break;
+                    }
+                    if (!ALLOW_TRAILING_COMMA)
+                    {
+                        return Fail(ErrorCode::TRAILING_COMMA, comma);
+                    }
+                }
+                else if (Current() != close)
+                {
+                    return Fail(frame.is_object_ ? ErrorCode::COMMA_OR_BRACE_EXPECTED
+                                                 : ErrorCode::COMMA_OR_BRACKET_EXPECTED,
+                                pos_);
+                }
+                ++pos_; // 跳过右括号
+                JsonValue container = CloseContainer();
+                Slot(root) = std::move(container);
+            }
+        }
+    }
+
+    // 下一个值在外层容器中的位置，标量直接解析到这里，省去一次移动
+    JsonValue &Slot(JsonValue &root) noexcept
+    {
+        if (depth_ == 0)
+        {
+            return root;
+        }
+        Frame &frame = stack_[depth_ - 1];
+        if (frame.is_object_)
+        {
+            // 重复的键与Parser一致，后出现的值覆盖先前的值
+            return frame.object_[std::move(frame.key_)];
+        }
+        return frame.array_.emplace_back();
+    }
+
+    // 弹出栈顶的容器，返回构建好的json值
+    JsonValue CloseContainer() noexcept
+    {
+        Frame &frame = stack_[--depth_];
+        return frame.is_object_ ? JsonValue(std::move(frame.object_)) : JsonValue(std::move(frame.array_));
+    }
+
+    // 解析对象的键和随后的冒号，结束时位于值的第一个字符上
+    bool ParseKey(std::string &key) noexcept
+    {
+        if (Current() != '"')
+        {
+            return Fail(ErrorCode::OBJECT_KEY_MUST_BE_STRING, pos_);
+        }
+        key.clear();
+        if (!ParseString(key))
+        {
+            return false;
+        }
+
+        SkipSpace();
+        if (Current() != ':')
+        {
+            return Fail(ErrorCode::COLON_EXPECTED, pos_);
+        }
+        ++pos_;
+        SkipSpace();
+        return true;
+    }
+
+    bool ParseScalar(JsonValue &value) noexcept
+    {
+        switch (Current())
+        {
+        case '"': {
+            std::string str;
+            if (!ParseString(str))
+            {
+                return false;
+            }
+            value = JsonValue(std::move(str));
+            return true;
+        }
+        case 't':
+        case 'f':
+        case 'n':
+            return ParseLiteral(value);
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return ParseNumber(value);
+        case '\0':
+        case ',':
+        case ']':
+        case '}':
+        case ':':
+            return Fail(ErrorCode::EXPECTED_JSON_VALUE_TYPE, pos_);
+        default:
+            return Fail(ErrorCode::UNKNOWN_VALUE, pos_);
+        }
+    }
+
+    bool ParseString(std::string &str) noexcept
+    {
+        const size_t begin = pos_;
+        ++pos_; // 跳过起始引号
+
+        while (true)
+        {
+            // 两个转义序列之间的普通字符整段复制
+            const size_t run = pos_;
+            while (pos_ < source_.size() && source_[pos_] != '"' && source_[pos_] != '\\' && source_[pos_] != '\n')
+            {
+                ++pos_;
+            }
+            str.append(source_, run, pos_ - run);
+            if (str.size() > limits_.max_string_length_)
+            {
+                return Fail(ErrorCode::STRING_TOO_LONG, begin);
+            }
+
+            if (pos_ >= source_.size() || source_[pos_] == '\n')
+            {
+                return Fail(ErrorCode::MISSING_QUOTATION_MARK, begin);
+            }
+            if (source_[pos_] == '"')
+            {
+                ++pos_;
+                return true;
+            }
+
+            ++pos_; // 跳过反斜杠
+            const char cur_char = Current();
+            if (pos_ >= source_.size() || cur_char == '\n')
+            {
+                return Fail(ErrorCode::MISSING_QUOTATION_MARK, begin);
+            }
+
+            if (const char unescaped = UnescapeChar(cur_char); unescaped != '\0')
+            {
+                str.push_back(unescaped);
+                ++pos_;
+            }
+            else if (cur_char == 'u')
+            {
+                ++pos_;
+                unsigned long codepoint = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (pos_ >= source_.size() || Current() == '\n')
+                    {
+                        return Fail(ErrorCode::INCOMPLETE_UNICODE_ESCAPE, begin);
+                    }
+                    if (!IsHexDigit(Current()))
+                    {
+                        return Fail(ErrorCode::INVALID_UNICODE_ESCAPE, begin);
+                    }
+                    codepoint = codepoint * 16 + HexValue(Current());
+                    ++pos_;
+                }
+                str.append(EncodeUtf8(codepoint));
+            }
+            else
+            {
+                return Fail(ErrorCode::INVALID_ESCAPE, begin);
+            }
+        }
+    }
+
+    bool ParseNumber(JsonValue &value) noexcept
+    {
+        const size_t begin = pos_;
+        NumberDfaStat cur_stat = NumberDfaStat::NUMBER_START;
+        bool is_float = false;
+        while (!IsTokenEnd(Current()))
+        {
+            const char cur_char = Current();
+            cur_stat = NextNumberStat(cur_stat, cur_char);
+            if (cur_stat == NumberDfaStat::ERROR)
+            {
+                return Fail(ErrorCode::INVALID_NUMBER, begin);
+            }
+            is_float = is_float || cur_char == '.' || cur_char == 'e' || cur_char == 'E';
+            ++pos_;
+        }
+        if (!IsNumberAccepting(cur_stat))
+        {
+            return Fail(ErrorCode::INCOMPLETE_NUMBER, begin);
+        }
+
+        // 与Parser一致，没有小数点和指数的数字为整数，超出long long范围时退化为浮点数
+        const char *first = source_.data() + begin;
+        const char *last = source_.data() + pos_;
+        long long int_value = 0;
+        if (!is_float && std::from_chars(first, last, int_value).ec == std::errc())
+        {
+            value = JsonValue(std::move(int_value));
+        }
+        else
+        {
+            number_.assign(first, last);
+            value = JsonValue(std::strtold(number_.c_str(), nullptr));
+        }
+        return true;
+    }
+
+    bool ParseLiteral(JsonValue &value) noexcept
+    {
+        const size_t begin = pos_;
+        LiteralDfaStat cur_stat = LiteralDfaStat::LITERAL_START;
+        while (!IsLiteralAccepting(cur_stat))
+        {
+            cur_stat = NextLiteralStat(cur_stat, Current());
+            if (cur_stat == LiteralDfaStat::ERROR)
+            {
+                return Fail(ErrorCode::INVALID_LITERAL, begin);
+            }
+            ++pos_;
+        }
+        if (!IsTokenEnd(Current()))
+        {
+            return Fail(ErrorCode::INVALID_LITERAL, begin);
+        }
+
+        if (cur_stat == LiteralDfaStat::NULL_L2)
+        {
+            value = JsonValue(nullptr);
+        }
+        else
+        {
+            value = JsonValue(cur_stat == LiteralDfaStat::TRUE_E);
+        }
+        return true;
+    }
+};
+} // namespace
+
+const char *ErrorDescription(const ErrorCode code) noexcept
+{
+    switch (code)
+    {
+    case ErrorCode::NONE:
+        return "";
+    case ErrorCode::UNKNOWN_VALUE:
+        return ERR_UNKNOWN_VALUE;
+    case ErrorCode::MISSING_QUOTATION_MARK:
+        return ERR_MISSING_QUOTATION_MARK;
+    case ErrorCode::INVALID_ESCAPE:
+        return ERR_INVALID_ESCAPE;
+    case ErrorCode::INCOMPLETE_UNICODE_ESCAPE:
+        return ERR_INCOMPLETE_UNICODE_ESCAPE;
+    case ErrorCode::INVALID_UNICODE_ESCAPE:
+        return ERR_INVALID_UNICODE_ESCAPE;
+    case ErrorCode::INCOMPLETE_NUMBER:
+        return ERR_INCOMPLETE_NUMBER;
+    case ErrorCode::INVALID_NUMBER:
+        return ERR_INVALID_NUMBER;
+    case ErrorCode::INVALID_LITERAL:
+        return ERR_INVALID_LITERAL;
+    case ErrorCode::MISMATCH_TOP_LEVEL:
+        return ERR_MISMATCH_TOP_LEVEL;
+    case ErrorCode::EXPECTED_JSON_VALUE_TYPE:
+        return ERR_EXPECTED_JSON_VALUE_TYPE;
+    case ErrorCode::COLON_EXPECTED:
+        return ERR_COLON_EXPECTED;
+    case ErrorCode::COMMA_OR_BRACKET_EXPECTED:
+        return ERR_COMMA_OR_BRACKET_EXPECTED;
+    case ErrorCode::COMMA_OR_BRACE_EXPECTED:
+        return ERR_COMMA_OR_BRACE_EXPECTED;
+    case ErrorCode::TRAILING_COMMA:
+        return ERR_TRAILING_COMMA;
+    case ErrorCode::OBJECT_KEY_MUST_BE_STRING:
+        return ERR_OBJECT_KEY_MUST_BE_STRING;
+    case ErrorCode::TRAILING_CONTENT:
+        return ERR_TRAILING_CONTENT;
+    case ErrorCode::NESTING_TOO_DEEP:
+        return ERR_NESTING_TOO_DEEP;
+    case ErrorCode::INPUT_TOO_LARGE:
+        return ERR_INPUT_TOO_LARGE;
+    case ErrorCode::STRING_TOO_LONG:
+        return ERR_STRING_TOO_LONG;
+    case ErrorCode::TOO_MANY_ELEMENTS:
+        return ERR_TOO_MANY_ELEMENTS;
+    }
+    return "";
+}
+
+ParseError TryParse(const std::string_view json_str, JsonValue &value, const ParseLimits &limits) noexcept
+{
+#if USDT_PROBES
+    SIMPLE_JSON_PROBE(try_parse_start, json_str.size());
+    const uint64_t begin_ns = SIMPLE_JSON_PROBE_CLOCK(try_parse_done);
+    const ParseError error = FastParser(json_str, limits).Parse(value);
+    if (begin_ns != 0)
+    {
+        SIMPLE_JSON_PROBE(try_parse_done, json_str.size(), ProbeNow() - begin_ns, static_cast<int>(error.code_),
+                          error.offset_);
+    }
+    return error;
+#else
+    return FastParser(json_str, limits).Parse(value);
+#endif
+}
+
+std::string DescribeError(const std::string_view json_str, const ParseError &error)
+{
+    if (error.Ok())
+    {
+        return {};
+    }
+
+    // 由字节偏移还原出行号、列号和所在行，与Lexer的计算方式一致
+    const size_t offset = std::min(error.offset_, json_str.size());
+    // 前面没有换行符时find_last_of返回npos，加1后正好是0
+    const size_t line_begin = offset == 0 ? 0 : json_str.find_last_of('\n', offset - 1) + 1;
+    size_t line_end = json_str.find('\n', offset);
+    line_end = line_end == std::string_view::npos ? json_str.size() : line_end + 1;
+    POS_T row = 0;
+    for (size_t i = 0; i < line_begin; ++i)
+    {
+        row += json_str[i] == '\n' ? 1 : 0;
+    }
+
+    // 高亮出错的token，结构字符或者输入结尾只高亮一个字符
+    LENGTH_T length = 1;
+    if (offset < json_str.size() && !IsTokenEnd(json_str[offset]) && json_str[offset] != '[' &&
+        json_str[offset] != '{')
+    {
+        while (offset + length < json_str.size() && !IsTokenEnd(json_str[offset + length]))
+        {
+            ++length;
+        }
+    }
+
+    ErrReporter err_reporter;
+    err_reporter.AddError(ErrInfo{ErrorDescription(error.code_),
+                                  std::string(json_str.substr(line_begin, line_end - line_begin)), row,
+                                  offset - line_begin, length});
+    return err_reporter.FormatErrors();
+}
+} // namespace simple_json
@@ -1,6 +1,11 @@
 #include "utilities.h"
+#include "probes.h"
 #include <cctype>
-#include <stdexcept>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <system_error>
 
 namespace simple_json
 {
@@ -46,24 +51,17 @@ std::string ConvertUnicodeEscape(const std::string &escape) noexcept
     {
         if (escape[i] == '\\' && i + 5 < escape.length() && escape[i + 1] == 'u')
         {
-            try
+            // 不用std::stoul，解析失败时不会抛异常，关闭异常时也能编译
+            const char *first = escape.data() + i + 2;
+            unsigned long codepoint = 0;
+            if (const auto [last, ec] = std::from_chars(first, first + 4, codepoint, 16);
+                ec == std::errc() && last == first + 4)
             {
-                const std::string tmp = escape.substr(i + 2, 4);
-                size_t failed_index = 0;
-                const unsigned long codepoint = std::stoul(tmp, &failed_index, 16);
-                if (failed_index == 4)
-                {
-                    // 如果failed_index为4，就代表std::stoul解析的过程中没有出错
-                    result.append(EncodeUtf8(codepoint));
-                }
-                else
-                {
-                    // 反之不为4，那么就一定是解析出问题了
-                    throw std::invalid_argument("invalid escape sequence");
-                }
+                result.append(EncodeUtf8(codepoint));
             }
-            catch (const std::exception &e)
+            else
             {
+                // 不是合法的unicode序列，原样保留
                 result.append(escape.substr(i, 6));
             }
             i += 6;
@@ -83,4 +81,189 @@ bool IsAscii(int ch) noexcept
     return static_cast<unsigned>(ch) < 0x80;
 }
 
+void AppendBase64Url(std::string &out, const std::string_view bytes)
+{
+    constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    size_t i = 0;
+    for (; i + 2 < bytes.size(); i += 3)
+    {
+        const uint32_t group = (static_cast<uint8_t>(bytes[i]) << 16) | (static_cast<uint8_t>(bytes[i + 1]) << 8) |
+                               static_cast<uint8_t>(bytes[i + 2]);
+        out.push_back(ALPHABET[(group >> 18) & 0x3f]);
+        out.push_back(ALPHABET[(group >> 12) & 0x3f]);
+        out.push_back(ALPHABET[(group >> 6) & 0x3f]);
+        out.push_back(ALPHABET[group & 0x3f]);
+    }
+
+    // 剩余1或2个字节时分别输出2或3个字符
+    if (i < bytes.size())
+    {
+        uint32_t group = static_cast<uint8_t>(bytes[i]) << 16;
+        if (i + 1 < bytes.size())
+        {
+            group |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+        }
+        out.push_back(ALPHABET[(group >> 18) & 0x3f]);
+        out.push_back(ALPHABET[(group >> 12) & 0x3f]);
+        if (i + 1 < bytes.size())
+        {
+            out.push_back(ALPHABET[(group >> 6) & 0x3f]);
+        }
+    }
+}
+
+size_t HashCombine(const size_t seed, const size_t value) noexcept
+{
+    return seed ^ (value + static_cast<size_t>(0x9e3779b97f4a7c15ULL) + (seed << 6) + (seed >> 2));
+}
+
+uint64_t MixHash(uint64_t value) noexcept
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+void AppendEscaped(std::string &out, const std::string_view str)
+{
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    out.push_back('"');
+    for (const char ch : str)
+    {
+        switch (ch)
+        {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\b':
+            out.append("\\b");
+            break;
+        case '\f':
+            out.append("\\f");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\r':
+            out.append("\\r");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                // 其余控制字符只能以\u00XX的形式出现
+                out.append("\\u00");
+                out.push_back(HEX_DIGITS[(ch >> 4) & 0xF]);
+                out.push_back(HEX_DIGITS[ch & 0xF]);
+            }
+            else
+            {
+                out.push_back(ch);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+
+// 匿名命名空间, 函数不对外暴露
+namespace
+{
+void AppendValue(std::string &out, const JsonValue &value)
+{
+    char buffer[64];
+    switch (value.GetType())
+    {
+    case JsonType::Object: {
+        out.push_back('{');
+        bool first = true;
+        for (const auto &[key, member] : value.GetVal<JsonType::Object>())
+        {
+            if (!first)
+            {
+                out.push_back(',');
+            }
+            first = false;
+            AppendEscaped(out, key);
+            out.push_back(':');
+            AppendValue(out, member);
+        }
+        out.push_back('}');
+        break;
+    }
+    case JsonType::Array: {
+        out.push_back('[');
+        bool first = true;
+        for (const JsonValue &element : value.GetVal<JsonType::Array>())
+        {
+            if (!first)
+            {
+                out.push_back(',');
+            }
+            first = false;
+            AppendValue(out, element);
+        }
+        out.push_back(']');
+        break;
+    }
+    case JsonType::String:
+        AppendEscaped(out, value.GetVal<JsonType::String>());
+        break;
+    case JsonType::Int: {
+        const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value.GetVal<JsonType::Int>());
+        out.append(buffer, result.ptr);
+        break;
+    }
+    case JsonType::Float: {
+        const long double number = value.GetVal<JsonType::Float>();
+        if (!std::isfinite(number))
+        {
+            out.append("null");
+            break;
+        }
+        const auto result = std::to_chars(std::begin(buffer), std::end(buffer), number);
+        const std::string_view text(buffer, static_cast<size_t>(result.ptr - buffer));
+        out.append(text);
+        if (text.find_first_of(".e") == std::string_view::npos)
+        {
+            out.append(".0"); // 保证重新解析后仍然是浮点数
+        }
+        break;
+    }
+    case JsonType::Bool:
+        out.append(value.GetVal<JsonType::Bool>() ? "true" : "false");
+        break;
+    case JsonType::Null:
+        out.append("null");
+        break;
+    }
+}
+} // namespace
+
+void AppendJson(std::string &out, const JsonValue &value)
+{
+#if USDT_PROBES
+    const size_t begin_size = out.size();
+    SIMPLE_JSON_PROBE(serialize_start, begin_size);
+    const uint64_t begin_ns = SIMPLE_JSON_PROBE_CLOCK(serialize_done);
+#endif
+
+    AppendValue(out, value);
+
+#if USDT_PROBES
+    if (begin_ns != 0)
+    {
+        SIMPLE_JSON_PROBE(serialize_done, out.size() - begin_size, ProbeNow() - begin_ns);
+    }
+#endif
+}
 } // namespace simple_json